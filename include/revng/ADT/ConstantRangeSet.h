@@ -4,7 +4,11 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <cstdint>
+#include <limits>
+
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/IR/ConstantRange.h"
 
 #include "revng/ADT/ZipMapIterator.h"
@@ -142,6 +146,9 @@ public:
   }
 
   bool contains(const ConstantRangeSet &Other) const {
+    if (isFullSet() or Other.isEmptySet())
+      return true;
+
     return intersectWith(Other) == Other;
   }
 
@@ -196,6 +203,37 @@ public:
     return Size;
   }
 
+  /// Same as `size().getLimitedValue()`, but, for sets of up to 64 bits, it
+  /// doesn't need to compute the size on `BitWidth + 1` bits
+  uint64_t getLimitedSize() const {
+    if (BitWidth > 64)
+      return size().getLimitedValue();
+
+    uint64_t Size = 0;
+    const llvm::APInt *Last = nullptr;
+    for (const llvm::APInt &N : Bounds) {
+      if (Last == nullptr) {
+        Last = &N;
+      } else {
+        Size += N.getZExtValue() - Last->getZExtValue();
+        Last = nullptr;
+      }
+    }
+
+    if (Last != nullptr) {
+      // The last range extends up to 2^BitWidth
+      uint64_t Start = Last->getZExtValue();
+      if (BitWidth < 64)
+        Size += (uint64_t(1) << BitWidth) - Start;
+      else if (Start == 0)
+        return std::numeric_limits<uint64_t>::max();
+      else
+        Size = llvm::SaturatingAdd(Size, -Start);
+    }
+
+    return Size;
+  }
+
 public:
   void zext(uint32_t NewSize) {
     revng_assert(NewSize >= BitWidth);
@@ -283,6 +321,9 @@ private:
     revng_assert(BitWidth == 0 or Other.BitWidth == 0
                  or BitWidth == Other.BitWidth);
 
+    if (ResultBitWidth <= 64)
+      return mergeNarrow<And>(Other, std::move(Result));
+
     bool LastOutput = false;
     bool LeftActive = false;
     bool RightActive = false;
@@ -318,4 +359,48 @@ private:
 
     return Result;
   }
+
+  /// Same as merge, but comparing the bounds as `uint64_t`s
+  template<bool And>
+  ConstantRangeSet mergeNarrow(const ConstantRangeSet &Other,
+                               ConstantRangeSet &&Result) const {
+    bool LastOutput = false;
+    bool LeftActive = false;
+    bool RightActive = false;
+    auto Left = Bounds.begin();
+    auto Right = Other.Bounds.begin();
+    while (Left != Bounds.end() or Right != Other.Bounds.end()) {
+      bool TakeLeft = Left != Bounds.end();
+      bool TakeRight = Right != Other.Bounds.end();
+      if (TakeLeft and TakeRight) {
+        uint64_t LeftValue = Left->getZExtValue();
+        uint64_t RightValue = Right->getZExtValue();
+        TakeLeft = LeftValue <= RightValue;
+        TakeRight = RightValue <= LeftValue;
+      }
+
+      const llvm::APInt &Value = TakeLeft ? *Left : *Right;
+      revng_assert(Value.getBitWidth() == Result.BitWidth);
+
+      if (TakeLeft) {
+        LeftActive = not LeftActive;
+        ++Left;
+      }
+
+      if (TakeRight) {
+        RightActive = not RightActive;
+        ++Right;
+      }
+
+      bool NewOutput = And ? (LeftActive and RightActive) :
+                             (LeftActive or RightActive);
+
+      if (NewOutput != LastOutput)
+        Result.Bounds.push_back(Value);
+
+      LastOutput = NewOutput;
+    }
+
+    return std::move(Result);
+  }
 };
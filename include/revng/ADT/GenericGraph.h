@@ -4,12 +4,16 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <algorithm>
+#include <memory>
 #include <type_traits>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/GraphWriter.h"
 
@@ -1290,6 +1294,46 @@ public:
   void setEntryNode(NodeT *EntryNode) { this->EntryNode = EntryNode; }
 };
 
+/// How a GenericGraph allocates its nodes
+enum class NodeAllocation {
+  /// Each node is a separate heap allocation. Removing a node preserves the
+  /// order of the others, but it takes linear time.
+  Heap,
+
+  /// Nodes are bump-allocated from slabs owned by the graph, which are released
+  /// all at once when the graph is cleared or destroyed. The graph tracks the
+  /// index of each node, which makes looking up and removing a node
+  /// constant-time: the last node takes the place of the removed one.
+  Arena
+};
+
+namespace revng::detail {
+
+/// Destroys a node owned by a GenericGraph. The memory of nodes allocated in
+/// the arena of the graph is released together with the arena.
+template<typename NodeT>
+class NodeDeleter {
+private:
+  bool InArena = false;
+
+public:
+  NodeDeleter() = default;
+  explicit NodeDeleter(bool InArena) : InArena(InArena) {}
+
+  // Allow adopting nodes allocated through `std::make_unique`
+  NodeDeleter(std::default_delete<NodeT>) {}
+
+public:
+  void operator()(NodeT *Node) const {
+    if (InArena)
+      Node->~NodeT();
+    else
+      delete Node;
+  }
+};
+
+} // namespace revng::detail
+
 /// Generic graph parametrized in the node type
 ///
 /// This graph owns its nodes (but not the edges).
@@ -1297,10 +1341,16 @@ public:
 template<typename NodeT, size_t SmallSize, bool HasEntryNode>
 class GenericGraph
   : public std::conditional_t<HasEntryNode, EntryNode<NodeT>, Empty> {
+private:
+  using EntryNodeBase = std::conditional_t<HasEntryNode,
+                                           EntryNode<NodeT>,
+                                           Empty>;
+
 public:
   // NOLINTNEXTLINE
   static const bool is_generic_graph = true;
-  using NodesContainer = llvm::SmallVector<std::unique_ptr<NodeT>, SmallSize>;
+  using NodePointer = std::unique_ptr<NodeT, revng::detail::NodeDeleter<NodeT>>;
+  using NodesContainer = llvm::SmallVector<NodePointer, SmallSize>;
   using Node = NodeT;
   static constexpr bool hasEntryNode = HasEntryNode;
 
@@ -1310,16 +1360,32 @@ private:
 
 public:
   GenericGraph() = default;
+  explicit GenericGraph(NodeAllocation Allocation) {
+    if (Allocation == NodeAllocation::Arena)
+      Arena = std::make_unique<llvm::BumpPtrAllocator>();
+  }
   GenericGraph(const GenericGraph &) = delete;
   GenericGraph(GenericGraph &&) = default;
   GenericGraph &operator=(const GenericGraph &) = delete;
-  GenericGraph &operator=(GenericGraph &&) = default;
+  GenericGraph &operator=(GenericGraph &&Other) {
+    if (this == &Other)
+      return *this;
+
+    // Our nodes might live in our arena: destroy them before replacing it
+    Nodes.clear();
+
+    EntryNodeBase::operator=(std::move(Other));
+    Arena = std::move(Other.Arena);
+    Nodes = std::move(Other.Nodes);
+    Slots = std::move(Other.Slots);
+    return *this;
+  }
 
   llvm::Error verify() const debug_function {
     llvm::SmallPtrSet<NodeT *, 32> ValidNodes;
 
     // Collect all valid nodes and ensure there are no nullptr
-    for (const std::unique_ptr<NodeT> &Node : Nodes) {
+    for (const NodePointer &Node : Nodes) {
 
       if (Node.get() == nullptr) {
         return llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -1330,7 +1396,7 @@ public:
     }
 
     // Ensure we only point to valid nodes
-    for (const std::unique_ptr<NodeT> &Node : Nodes) {
+    for (const NodePointer &Node : Nodes) {
       for (NodeT *Successor : Node->successors()) {
         if (not ValidNodes.contains(Successor)) {
           return llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -1350,16 +1416,30 @@ public:
       }
     }
 
+    // Ensure the index of arena-allocated nodes is up to date
+    if (Arena != nullptr) {
+      if (Slots.size() != Nodes.size()) {
+        return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                       "The node index has a wrong size");
+      }
+
+      for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+        auto It = Slots.find(Nodes[Index].get());
+        if (It == Slots.end() or It->second != Index) {
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "The node index is out of date");
+        }
+      }
+    }
+
     return llvm::Error::success();
   }
 
   void dumpGraph() const debug_function { llvm::WriteGraph(this, ""); }
 
 public:
-  static NodeT *getNode(std::unique_ptr<NodeT> &E) { return E.get(); }
-  static const NodeT *getConstNode(const std::unique_ptr<NodeT> &E) {
-    return E.get();
-  }
+  static NodeT *getNode(NodePointer &E) { return E.get(); }
+  static const NodeT *getConstNode(const NodePointer &E) { return E.get(); }
 
   // TODO: these iterators will not work with llvm::filter_iterator,
   //       since the mapped type is not a reference
@@ -1380,70 +1460,171 @@ public:
 
   size_t size() const { return Nodes.size(); }
 
+  NodeAllocation allocation() const {
+    return Arena != nullptr ? NodeAllocation::Arena : NodeAllocation::Heap;
+  }
+
 public:
-  nodes_iterator findNode(Node const *NodePtr) {
+  /// \return the position of \p NodePtr in `nodes()`, or `size()` if it's not
+  ///         a node of this graph. Constant-time for arena-allocated graphs.
+  size_t indexOf(Node const *NodePtr) const {
+    if (Arena != nullptr) {
+      auto It = Slots.find(NodePtr);
+      return It != Slots.end() ? It->second : Nodes.size();
+    }
+
     auto Comparator = [&NodePtr](auto &N) { return N.get() == NodePtr; };
     auto InternalIt = std::find_if(Nodes.begin(), Nodes.end(), Comparator);
-    return nodes_iterator(InternalIt, getNode);
+    return InternalIt - Nodes.begin();
+  }
+
+  nodes_iterator findNode(Node const *NodePtr) {
+    return nodes_iterator(Nodes.begin() + indexOf(NodePtr), getNode);
   }
   const_nodes_iterator findNode(Node const *NodePtr) const {
-    auto Comparator = [&NodePtr](auto &N) { return N.get() == NodePtr; };
-    auto InternalIt = std::find_if(Nodes.begin(), Nodes.end(), Comparator);
-    return nodes_iterator(InternalIt, getConstNode);
+    return const_nodes_iterator(Nodes.begin() + indexOf(NodePtr),
+                                getConstNode);
   }
 
 public:
   bool hasNodes() const { return Nodes.size() != 0; }
   bool hasNode(Node const *NodePtr) const {
-    return findNode(NodePtr) != Nodes.end();
+    return indexOf(NodePtr) != Nodes.size();
   }
 
 public:
   NodeT *addNode(std::unique_ptr<NodeT> &&Ptr) {
     Nodes.emplace_back(std::move(Ptr));
-    if constexpr (NodeT::HasParent)
-      Nodes.back()->setParent(this);
-    return Nodes.back().get();
+    return adoptLastNode();
   }
 
   template<class... ArgTypes>
   NodeT *addNode(ArgTypes &&...A) {
-    Nodes.push_back(std::make_unique<NodeT>(std::forward<ArgTypes>(A)...));
-    if constexpr (NodeT::HasParent)
-      Nodes.back()->setParent(this);
-    return Nodes.back().get();
+    Nodes.push_back(makeNode(std::forward<ArgTypes>(A)...));
+    return adoptLastNode();
   }
 
+  /// Remove the node pointed by \p It
+  ///
+  /// In arena-allocated graphs, the last node is moved in place of the removed
+  /// one, so the order of the nodes is not preserved.
+  ///
+  /// \return an iterator to the node following the removed one, in iteration
+  ///         order.
   nodes_iterator removeNode(nodes_iterator It) {
     if constexpr (StrictSpecializationOfMutableEdgeNode<Node>)
       (*It.getCurrent())->disconnect();
 
-    auto InternalIt = Nodes.erase(It.getCurrent());
-    return nodes_iterator(InternalIt, getNode);
+    if (Arena == nullptr) {
+      auto InternalIt = Nodes.erase(It.getCurrent());
+      return nodes_iterator(InternalIt, getNode);
+    }
+
+    auto InternalIt = It.getCurrent();
+    size_t Index = InternalIt - Nodes.begin();
+    Slots.erase(InternalIt->get());
+    if (Index + 1 != Nodes.size()) {
+      *InternalIt = std::move(Nodes.back());
+      Slots[InternalIt->get()] = Index;
+    }
+    Nodes.pop_back();
+
+    return nodes_iterator(Nodes.begin() + Index, getNode);
   }
   nodes_iterator removeNode(Node const *NodePtr) {
     return removeNode(findNode(NodePtr));
   }
 
+  /// Remove all the nodes for which \p Predicate returns true, preserving the
+  /// order of the others
+  template<typename PredicateType>
+  void removeNodesIf(PredicateType &&Predicate) {
+    llvm::erase_if(Nodes, [&Predicate](NodePointer &N) {
+      if (not Predicate(N.get()))
+        return false;
+
+      if constexpr (StrictSpecializationOfMutableEdgeNode<Node>)
+        N->disconnect();
+
+      return true;
+    });
+
+    if (Arena != nullptr)
+      updateSlots(0);
+  }
+
 public:
   nodes_iterator insertNode(nodes_iterator Where,
                             std::unique_ptr<NodeT> &&Ptr) {
-    auto InternalIt = Nodes.insert(Where.getCurrent(), std::move(Ptr));
-    return nodes_iterator(InternalIt, getNode);
+    return insertNodeImpl(Where, NodePointer(std::move(Ptr)));
   }
   template<class... ArgTypes>
   nodes_iterator insertNode(nodes_iterator Where, ArgTypes &&...A) {
-    auto Pointer = std::make_unique<NodeT>(std::forward<ArgTypes>(A)...);
+    return insertNodeImpl(Where, makeNode(std::forward<ArgTypes>(A)...));
+  }
+
+public:
+  void reserve(size_t Size) {
+    Nodes.reserve(Size);
+    if (Arena != nullptr)
+      Slots.reserve(Size);
+  }
+
+  /// Destroy all the nodes. For arena-allocated graphs, this also releases all
+  /// the memory the nodes used at once.
+  void clear() {
+    Nodes.clear();
+    Slots.clear();
+    if (Arena != nullptr)
+      Arena->Reset();
+  }
+
+private:
+  template<class... ArgTypes>
+  NodePointer makeNode(ArgTypes &&...A) {
+    if (Arena == nullptr)
+      return NodePointer(new NodeT(std::forward<ArgTypes>(A)...));
+
+    void *Memory = Arena->Allocate(sizeof(NodeT), alignof(NodeT));
+    return NodePointer(new (Memory) NodeT(std::forward<ArgTypes>(A)...),
+                       revng::detail::NodeDeleter<NodeT>(true));
+  }
+
+  NodeT *adoptLastNode() {
+    NodeT *Result = Nodes.back().get();
+    if constexpr (NodeT::HasParent)
+      Result->setParent(this);
+    if (Arena != nullptr)
+      Slots[Result] = Nodes.size() - 1;
+    return Result;
+  }
+
+  nodes_iterator insertNodeImpl(nodes_iterator Where, NodePointer &&Pointer) {
     auto InternalIt = Nodes.insert(Where.getCurrent(), std::move(Pointer));
+    if (Arena != nullptr)
+      updateSlots(InternalIt - Nodes.begin());
     return nodes_iterator(InternalIt, getNode);
   }
 
-public:
-  void reserve(size_t Size) { Nodes.reserve(Size); }
-  void clear() { Nodes.clear(); }
+  /// Record the index of all the nodes starting from \p First
+  void updateSlots(size_t First) {
+    if (First == 0)
+      Slots.clear();
+    for (size_t Index = First; Index < Nodes.size(); ++Index)
+      Slots[Nodes[Index].get()] = Index;
+  }
 
-protected:
+private:
+  /// The memory of arena-allocated nodes, if any. It's declared before `Nodes`
+  /// so that it outlives them.
+  std::unique_ptr<llvm::BumpPtrAllocator> Arena;
+
+  /// Private so that derived graphs can't add or remove nodes without going
+  /// through the methods that keep `Slots` up to date.
   NodesContainer Nodes;
+
+  /// The index of each node in `Nodes`, tracked only for arena-allocated graphs
+  llvm::DenseMap<const NodeT *, size_t> Slots;
 };
 
 //
@@ -9,6 +9,7 @@
 #include "llvm/ADT/STLExtras.h"
 
 #include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/StructuralMutationEpoch.h"
 
 template<KeyedObjectContainerCompatible T,
          class Compare = DefaultKeyObjectComparator<T>>
@@ -78,8 +79,28 @@ public:
     }
   }
 
+  MutableSet(const MutableSet &) = default;
+  MutableSet(MutableSet &&) = default;
+
+  MutableSet &operator=(const MutableSet &Other) {
+    StructuralMutationEpoch::bump();
+    TheMap = Other.TheMap;
+    return *this;
+  }
+
+  MutableSet &operator=(MutableSet &&Other) {
+    StructuralMutationEpoch::bump();
+    TheMap = std::move(Other.TheMap);
+    return *this;
+  }
+
 public:
-  void swap(MutableSet &Other) { TheMap.swap(Other.TheMap); }
+  // Insertions do not invalidate pointers to the other elements of a std::map,
+  // only operations removing or replacing elements bump the epoch.
+  void swap(MutableSet &Other) {
+    StructuralMutationEpoch::bump();
+    TheMap.swap(Other.TheMap);
+  }
   bool operator==(const MutableSet &Other) const = default;
 
 public:
@@ -114,7 +135,12 @@ public:
   bool empty() const { return TheMap.empty(); }
   size_type size() const { return TheMap.size(); }
   size_type max_size() const { return TheMap.max_size(); }
-  void clear() { TheMap.clear(); }
+  void clear() {
+    if (TheMap.empty())
+      return;
+    StructuralMutationEpoch::bump();
+    TheMap.clear();
+  }
 
   std::pair<iterator, bool> insert(const T &Value) {
     auto Result = TheMap.insert({ KOT::key(Value), Value });
@@ -146,14 +172,23 @@ public:
   }
 
   iterator erase(iterator Pos) {
+    StructuralMutationEpoch::bump();
     return wrapIterator(TheMap.erase(unwrapIterator(Pos)));
   }
   iterator erase(iterator First, iterator Last) {
+    StructuralMutationEpoch::bump();
     auto It = TheMap.erase(unwrapIterator(First), unwrapIterator(Last));
     return wrapIterator(It);
   }
 
-  size_type erase(const key_type &Key) { return TheMap.erase(Key); }
+  size_type erase(const key_type &Key) {
+    auto It = TheMap.find(Key);
+    if (It == TheMap.end())
+      return 0;
+    StructuralMutationEpoch::bump();
+    TheMap.erase(It);
+    return 1;
+  }
 
   size_type count(const key_type &Key) const { return TheMap.count(Key); }
 
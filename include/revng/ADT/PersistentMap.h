@@ -0,0 +1,199 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "llvm/ADT/SmallVector.h"
+
+#include "revng/Support/Assert.h"
+
+/// An ordered map with value semantics whose copies share their storage
+///
+/// The entries are kept sorted in chunks of at most `ChunkSize` elements, each
+/// one reference counted. Copying the map only copies the list of chunks and
+/// modifying a copy only clones the chunk being modified (copy-on-write). This
+/// makes it a good fit for the lattice elements of a monotone framework, which
+/// are copied around a lot and often differ only in a few entries.
+///
+/// Unlike `std::map`, any modification invalidates iterators and pointers to
+/// the elements. As for standard containers, a map must not be modified
+/// concurrently, but copies sharing their storage can be used from different
+/// threads.
+template<typename KeyT, typename ValueT, size_t ChunkSize = 16>
+class PersistentMap {
+public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = std::pair<KeyT, ValueT>;
+
+private:
+  static_assert(ChunkSize >= 2);
+  using Chunk = llvm::SmallVector<value_type, ChunkSize>;
+  using ChunkPointer = std::shared_ptr<Chunk>;
+
+public:
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<KeyT, ValueT>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+  private:
+    const ChunkPointer *Current = nullptr;
+    size_t Index = 0;
+
+  public:
+    const_iterator() = default;
+    explicit const_iterator(const ChunkPointer *Current) : Current(Current) {}
+
+  public:
+    reference operator*() const { return (**Current)[Index]; }
+    pointer operator->() const { return &**this; }
+
+    const_iterator &operator++() {
+      // Chunks are never empty
+      if (++Index == (*Current)->size()) {
+        ++Current;
+        Index = 0;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator Result = *this;
+      ++*this;
+      return Result;
+    }
+
+    bool operator==(const const_iterator &Other) const {
+      return Current == Other.Current and Index == Other.Index;
+    }
+
+    bool operator!=(const const_iterator &Other) const {
+      return not(*this == Other);
+    }
+  };
+
+private:
+  llvm::SmallVector<ChunkPointer, 4> Chunks;
+  size_t Size = 0;
+
+public:
+  size_t size() const { return Size; }
+  bool empty() const { return Size == 0; }
+
+  const_iterator begin() const { return const_iterator(Chunks.begin()); }
+  const_iterator end() const { return const_iterator(Chunks.end()); }
+
+public:
+  /// \return a pointer to the value associated to \p Key, or nullptr if
+  ///         there's none.
+  const ValueT *find(const KeyT &Key) const {
+    if (Chunks.empty())
+      return nullptr;
+
+    const Chunk &TheChunk = *Chunks[chunkIndexFor(Key)];
+    auto It = lowerBound(TheChunk, Key);
+    if (It == TheChunk.end() or std::less<KeyT>()(Key, It->first))
+      return nullptr;
+
+    return &It->second;
+  }
+
+  bool contains(const KeyT &Key) const { return find(Key) != nullptr; }
+
+  /// Associate \p Value to \p Key, replacing the current value, if any
+  void set(const KeyT &Key, ValueT Value) {
+    if (Chunks.empty()) {
+      Chunks.push_back(std::make_shared<Chunk>());
+      Chunks.back()->emplace_back(Key, std::move(Value));
+      ++Size;
+      return;
+    }
+
+    size_t Index = chunkIndexFor(Key);
+    Chunk &TheChunk = makeUnique(Index);
+    auto It = lowerBound(TheChunk, Key);
+    if (It != TheChunk.end() and not std::less<KeyT>()(Key, It->first)) {
+      It->second = std::move(Value);
+      return;
+    }
+
+    TheChunk.insert(It, value_type(Key, std::move(Value)));
+    ++Size;
+    if (TheChunk.size() > ChunkSize)
+      split(Index);
+  }
+
+  void clear() {
+    Chunks.clear();
+    Size = 0;
+  }
+
+public:
+  /// \return true if this map and \p Other share all of their storage, which
+  ///         implies they're equal.
+  bool sharesStorageWith(const PersistentMap &Other) const {
+    return Chunks == Other.Chunks;
+  }
+
+  bool operator==(const PersistentMap &Other) const {
+    if (sharesStorageWith(Other))
+      return true;
+
+    return Size == Other.Size and std::equal(begin(), end(), Other.begin());
+  }
+
+private:
+  /// \return the index of the chunk that contains \p Key or, if there's no
+  ///         such key, where it should be inserted.
+  size_t chunkIndexFor(const KeyT &Key) const {
+    revng_assert(not Chunks.empty());
+    auto IsBefore = [&Key](const ChunkPointer &TheChunk) {
+      return std::less<KeyT>()(TheChunk->back().first, Key);
+    };
+    auto It = std::partition_point(Chunks.begin(), Chunks.end(), IsBefore);
+
+    // Keys greater than all the others go in the last chunk
+    if (It == Chunks.end())
+      --It;
+
+    return It - Chunks.begin();
+  }
+
+  template<typename ChunkType>
+  static auto lowerBound(ChunkType &TheChunk, const KeyT &Key) {
+    auto IsBefore = [&Key](const value_type &Entry) {
+      return std::less<KeyT>()(Entry.first, Key);
+    };
+    return std::partition_point(TheChunk.begin(), TheChunk.end(), IsBefore);
+  }
+
+  /// Clone the chunk at \p Index, if it's shared with other maps
+  Chunk &makeUnique(size_t Index) {
+    ChunkPointer &Pointer = Chunks[Index];
+    if (Pointer.use_count() != 1)
+      Pointer = std::make_shared<Chunk>(*Pointer);
+    return *Pointer;
+  }
+
+  /// Split the chunk at \p Index, which must not be shared, in two halves
+  void split(size_t Index) {
+    Chunk &First = *Chunks[Index];
+    auto Middle = First.begin() + First.size() / 2;
+    auto Second = std::make_shared<Chunk>(std::make_move_iterator(Middle),
+                                          std::make_move_iterator(First.end()));
+    First.erase(Middle, First.end());
+    Chunks.insert(Chunks.begin() + Index + 1, std::move(Second));
+  }
+};
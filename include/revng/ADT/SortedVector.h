@@ -7,6 +7,7 @@
 #include "llvm/ADT/STLExtras.h"
 
 #include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/StructuralMutationEpoch.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/Debug.h"
 
@@ -76,9 +77,27 @@ public:
     sort<true>();
   }
 
+  SortedVector(const SortedVector &) = default;
+  SortedVector(SortedVector &&) = default;
+
+  SortedVector &operator=(const SortedVector &Other) {
+    StructuralMutationEpoch::bump();
+    TheVector = Other.TheVector;
+    BatchInsertInProgress = Other.BatchInsertInProgress;
+    return *this;
+  }
+
+  SortedVector &operator=(SortedVector &&Other) {
+    StructuralMutationEpoch::bump();
+    TheVector = std::move(Other.TheVector);
+    BatchInsertInProgress = Other.BatchInsertInProgress;
+    return *this;
+  }
+
 public:
   void swap(SortedVector &Other) {
     revng_assert(not BatchInsertInProgress);
+    StructuralMutationEpoch::bump();
     TheVector.swap(Other.TheVector);
   }
 
@@ -186,11 +205,18 @@ public:
 
   void clear() {
     revng_assert(not BatchInsertInProgress);
+    if (TheVector.empty())
+      return;
+    StructuralMutationEpoch::bump();
     TheVector.clear();
   }
 
   void reserve(size_type NewSize) {
     revng_assert(not BatchInsertInProgress);
+    // Only a reallocation moves the elements
+    if (NewSize <= TheVector.capacity())
+      return;
+    StructuralMutationEpoch::bump();
     TheVector.reserve(NewSize);
   }
 
@@ -209,11 +235,15 @@ public:
     auto Key = KeyedObjectTraits<T>::key(Value);
     auto It = lower_bound(Key);
     if (It == end()) {
+      // Appending moves the other elements only if it reallocates
+      if (TheVector.size() == TheVector.capacity())
+        StructuralMutationEpoch::bump();
       TheVector.emplace_back(std::move(Value));
       return { --end(), true };
     } else if (keysEqual(KeyedObjectTraits<T>::key(*It), Key)) {
       return { It, false };
     } else {
+      StructuralMutationEpoch::bump();
       return { TheVector.emplace(It, std::move(Value)), true };
     }
   }
@@ -230,23 +260,30 @@ public:
     auto Key = KeyedObjectTraits<T>::key(Value);
     auto It = lower_bound(Key);
     if (It == end()) {
+      // Appending moves the other elements only if it reallocates
+      if (TheVector.size() == TheVector.capacity())
+        StructuralMutationEpoch::bump();
       TheVector.emplace_back(std::move(Value));
       return { --end(), true };
     } else if (keysEqual(KeyedObjectTraits<T>::key(*It), Key)) {
+      // The element stays where it is, no need to bump the epoch
       *It = std::move(Value);
       return { It, false };
     } else {
+      StructuralMutationEpoch::bump();
       return { TheVector.emplace(It, std::move(Value)), true };
     }
   }
 
   iterator erase(iterator Pos) {
     revng_assert(not BatchInsertInProgress);
+    StructuralMutationEpoch::bump();
     return TheVector.erase(Pos);
   }
 
   iterator erase(const_iterator First, const_iterator Last) {
     revng_assert(not BatchInsertInProgress);
+    StructuralMutationEpoch::bump();
     return TheVector.erase(First, Last);
   }
 
@@ -317,9 +354,14 @@ public:
     SortedVector *SV;
 
   public:
+    // The epoch is bumped once when the batch starts, since emplacing might
+    // reallocate the vector, and once when it is committed, since sorting
+    // moves the elements. No lookup is allowed in between, so there is no
+    // need to bump it for each element.
     BatchInserterBase(SortedVector &SV) : SV(&SV) {
       revng_assert(not SV.BatchInsertInProgress);
       SV.BatchInsertInProgress = true;
+      StructuralMutationEpoch::bump();
     }
 
     BatchInserterBase(const BatchInserterBase &) = delete;
@@ -340,6 +382,7 @@ public:
     void commit() {
       if (SV != nullptr && SV->BatchInsertInProgress) {
         SV->BatchInsertInProgress = false;
+        StructuralMutationEpoch::bump();
         SV->sort<EnsureUnique>();
       }
     }
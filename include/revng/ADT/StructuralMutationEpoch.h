@@ -0,0 +1,31 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <atomic>
+#include <cstdint>
+
+/// Process-wide counter of the structural mutations of keyed object containers
+/// and UpcastablePointer, i.e., of all the operations that can move, destroy or
+/// replace an object owned by a TupleTree.
+///
+/// A pointer obtained by looking up an object in a TupleTree is guaranteed to
+/// still point to the same object as long as this counter did not change,
+/// which makes it possible to memoize lookups (see TupleTreeReference).
+///
+/// Since the counter is shared by all the threads, containers only bump it
+/// when an object is actually moved or destroyed, and batch insertions bump it
+/// once per batch rather than once per element. Tearing down a whole TupleTree
+/// bumps it once.
+class StructuralMutationEpoch {
+private:
+  inline static std::atomic<uint64_t> Current = 1;
+
+public:
+  /// \return the current epoch, never 0
+  static uint64_t get() { return Current.load(std::memory_order_relaxed); }
+
+  static void bump() { Current.fetch_add(1, std::memory_order_relaxed); }
+};
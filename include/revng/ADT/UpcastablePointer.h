@@ -11,6 +11,7 @@
 #include "llvm/Support/Casting.h"
 
 #include "revng/ADT/STLExtras.h"
+#include "revng/ADT/StructuralMutationEpoch.h"
 #include "revng/Support/Assert.h"
 
 template<typename T>
@@ -177,7 +178,7 @@ public:
 public:
   UpcastablePointer &operator=(const UpcastablePointer &Other) {
     if (&Other != this) {
-      Pointer.reset(clone(Other.Pointer.get()));
+      replace(clone(Other.Pointer.get()));
     }
     return *this;
   }
@@ -189,7 +190,7 @@ public:
 
   UpcastablePointer &operator=(UpcastablePointer &&Other) {
     if (&Other != this) {
-      Pointer.reset(Other.Pointer.release());
+      replace(Other.Pointer.release());
     }
     return *this;
   }
@@ -217,7 +218,18 @@ public:
   auto &operator*() const { return *Pointer; }
   auto *operator->() const noexcept { return Pointer.operator->(); }
 
-  void reset(pointer Other = pointer()) noexcept { Pointer.reset(Other); }
+  void reset(pointer Other = pointer()) noexcept { replace(Other); }
+
+private:
+  void replace(pointer Other) noexcept {
+    // Destroying the pointee invalidates pointers to it, see
+    // StructuralMutationEpoch. Plain destruction does not bump it: whoever
+    // destroys the owner (a container or a TupleTree) does, once for all the
+    // objects it owns.
+    if (Pointer != nullptr)
+      StructuralMutationEpoch::bump();
+    Pointer.reset(Other);
+  }
 
 private:
   inner_pointer Pointer;
@@ -45,6 +45,7 @@ public:
   const efa::BasicBlock *findBlock(GeneratedCodeBasicInfo &GCBI,
                                    llvm::BasicBlock *BB) const;
 
+  /// Attach this metadata to the IR, in the binary tuple tree encoding
   void serialize(GeneratedCodeBasicInfo &GCBI) const;
 
 public:
@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
@@ -11,36 +15,46 @@
 #include "revng/EarlyFunctionAnalysis/FunctionMetadata.h"
 #include "revng/Model/Binary.h"
 #include "revng/Model/IRHelpers.h"
+#include "revng/Pipeline/LLVMContainer.h"
 #include "revng/Pipes/IRHelpers.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/IRHelpers.h"
 #include "revng/Support/MetaAddress.h"
+#include "revng/TupleTree/BinarySerialization.h"
 #include "revng/TupleTree/TupleTree.h"
 
 namespace detail {
 
-inline TupleTree<efa::FunctionMetadata>
-extractFunctionMetadata(llvm::MDNode *MD) {
+inline const llvm::MDString *getFunctionMetadataString(llvm::MDNode *MD) {
   using namespace llvm;
 
-  efa::FunctionMetadata FM;
   revng_assert(MD != nullptr);
   const MDOperand &Op = MD->getOperand(0);
   revng_assert(isa<MDString>(Op));
+  return cast<MDString>(Op);
+}
+
+inline efa::FunctionMetadata extractFunctionMetadata(llvm::StringRef Buffer) {
+  if (isBinaryTupleTree(Buffer))
+    return llvm::cantFail(::deserializeBinary<efa::FunctionMetadata>(Buffer));
 
-  StringRef YAMLString = cast<MDString>(Op)->getString();
-  auto MaybeParsed = TupleTree<efa::FunctionMetadata>::deserialize(YAMLString);
+  // Metadata attached by older versions is in YAML form
+  auto MaybeParsed = TupleTree<efa::FunctionMetadata>::deserialize(Buffer);
   revng_assert(MaybeParsed and MaybeParsed->verify());
-  return std::move(MaybeParsed.get());
+  return std::move(*MaybeParsed->get());
+}
+
+inline efa::FunctionMetadata extractFunctionMetadata(llvm::MDNode *MD) {
+  return extractFunctionMetadata(getFunctionMetadataString(MD)->getString());
 }
 
-inline TupleTree<efa::FunctionMetadata>
+inline efa::FunctionMetadata
 extractFunctionMetadata(const llvm::Function *F) {
   auto *MDNode = F->getMetadata(FunctionMetadataMDName);
   return detail::extractFunctionMetadata(MDNode);
 }
 
-inline TupleTree<efa::FunctionMetadata>
+inline efa::FunctionMetadata
 extractFunctionMetadata(const llvm::BasicBlock *BB) {
   auto *MDNode = BB->getTerminator()->getMetadata(FunctionMetadataMDName);
   return detail::extractFunctionMetadata(MDNode);
@@ -48,28 +62,48 @@ extractFunctionMetadata(const llvm::BasicBlock *BB) {
 
 } // namespace detail
 
+/// Decodes the efa::FunctionMetadata attached to the IR at most once.
+///
+/// Entries are keyed by the MDString holding the encoded metadata, which is
+/// shared by an isolated function and the entry block it has been created
+/// from. MDStrings are immutable, so attaching new metadata produces a new
+/// key, but their address can be reused once their LLVMContext is destroyed:
+/// an instance must not outlive the module it has been used on.
+///
+/// Pipes should use the instance associated to their LLVMContainer, see
+/// getFunctionMetadataCache, so that the decoded metadata is shared with the
+/// pipes and the passes running later on the same module.
 class FunctionMetadataCache {
 private:
-  std::map<const llvm::Value *, efa::FunctionMetadata> FunctionCache;
+  std::map<const llvm::MDString *, efa::FunctionMetadata> FunctionCache;
+  std::mutex Mutex;
+
+public:
+  FunctionMetadataCache() = default;
+
+  FunctionMetadataCache(const FunctionMetadataCache &) = delete;
+  FunctionMetadataCache &operator=(const FunctionMetadataCache &) = delete;
 
 public:
   const efa::FunctionMetadata &
   getFunctionMetadata(const llvm::Function *Function) {
-    auto Iterator = FunctionCache.find(Function);
-    if (Iterator != FunctionCache.end())
-      return Iterator->second;
-
-    efa::FunctionMetadata FM = *detail::extractFunctionMetadata(Function).get();
-    return FunctionCache.try_emplace(Function, FM).first->second;
+    auto *MDNode = Function->getMetadata(FunctionMetadataMDName);
+    return getFunctionMetadata(detail::getFunctionMetadataString(MDNode));
   }
 
   const efa::FunctionMetadata &getFunctionMetadata(const llvm::BasicBlock *BB) {
-    auto Iterator = FunctionCache.find(BB);
+    auto *MDNode = BB->getTerminator()->getMetadata(FunctionMetadataMDName);
+    return getFunctionMetadata(detail::getFunctionMetadataString(MDNode));
+  }
+
+  const efa::FunctionMetadata &getFunctionMetadata(const llvm::MDString *MD) {
+    std::lock_guard Lock(Mutex);
+    auto Iterator = FunctionCache.find(MD);
     if (Iterator != FunctionCache.end())
       return Iterator->second;
 
-    efa::FunctionMetadata FM = *detail::extractFunctionMetadata(BB).get();
-    return FunctionCache.try_emplace(BB, FM).first->second;
+    efa::FunctionMetadata FM = detail::extractFunctionMetadata(MD->getString());
+    return FunctionCache.try_emplace(MD, std::move(FM)).first->second;
   }
 
   /// Given a Call instruction and the model type of its parent function, return
@@ -130,16 +164,32 @@ public:
   }
 };
 
+/// \return the FunctionMetadataCache shared by everything using the module of
+///         \p Container
+inline FunctionMetadataCache &
+getFunctionMetadataCache(const pipeline::LLVMContainer &Container) {
+  return Container.getCache<FunctionMetadataCache>();
+}
+
 class FunctionMetadataCachePass : public llvm::ImmutablePass {
 public:
   static char ID;
 
 private:
-  FunctionMetadataCache Cache;
+  /// Only used when the pass has not been given a cache to share
+  std::unique_ptr<FunctionMetadataCache> OwnedCache;
+  FunctionMetadataCache *Cache = nullptr;
 
 public:
-  FunctionMetadataCachePass() : llvm::ImmutablePass(ID) {}
-  FunctionMetadataCache &get() { return Cache; }
+  FunctionMetadataCachePass() :
+    llvm::ImmutablePass(ID),
+    OwnedCache(std::make_unique<FunctionMetadataCache>()),
+    Cache(OwnedCache.get()) {}
+
+  explicit FunctionMetadataCachePass(FunctionMetadataCache &Shared) :
+    llvm::ImmutablePass(ID), Cache(&Shared) {}
+
+  FunctionMetadataCache &get() { return *Cache; }
 };
 
 class FunctionMetadataCacheAnalysis
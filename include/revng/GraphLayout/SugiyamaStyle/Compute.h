@@ -4,6 +4,11 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <chrono>
+#include <cstdint>
+
+#include "llvm/ADT/ArrayRef.h"
+
 #include "revng/GraphLayout/Graphs.h"
 #include "revng/GraphLayout/SugiyamaStyle/InternalGraph.h"
 
@@ -25,6 +30,20 @@ enum class Orientation {
   BottomToTop
 };
 
+/// Lists possible node permutation selection strategies the layouter
+/// implements.
+enum class PermutationStrategy {
+  /// Swap pairs of nodes within a layer as long as doing so lowers the number
+  /// of crossings. Produces the nicest layouts, but the cost grows with
+  /// the cube of the layer width.
+  HillClimbing,
+
+  /// Sort every layer by the median position of its neighbors, sweeping
+  /// until the number of crossings stops decreasing or the time budget is
+  /// exhausted. Independent layers are processed in parallel.
+  MedianSweep
+};
+
 struct Configuration {
 public:
   /// Specifies the way the layers of the graph are decided
@@ -75,12 +94,39 @@ public:
 
   /// Specifies the minimum possible distance between two edges.
   layout::Dimension EdgeMarginSize;
+
+  /// Specifies the way node permutation within each layer is selected.
+  PermutationStrategy Permutation = PermutationStrategy::HillClimbing;
+
+  /// Specifies the wall-clock time `PermutationStrategy::MedianSweep` is
+  /// allowed to spend sweeping, zero meaning unlimited.
+  ///
+  /// \note: the budget is only checked between two sweeps. If it cuts the
+  ///        sweeping short, the layout depends on the speed of the machine
+  ///        (and on its load): the same graph can be laid out differently by
+  ///        two runs. Use zero where reproducible layouts are required, the
+  ///        sweep count is bounded anyway.
+  std::chrono::milliseconds PermutationBudget{ 0 };
+
+  /// Specifies the number of threads `PermutationStrategy::MedianSweep` is
+  /// allowed to use, zero meaning one per core.
+  unsigned PermutationThreadCount = 0;
 };
 
 namespace detail {
 
 bool computeImpl(InternalGraph &Internal, const Configuration &Configuration);
 
+/// Counts the crossings between the edges connecting two adjacent layers, in
+/// O(|E| log |V|).
+///
+/// \param Ends The positions, within the lower layer, of the lower ends of
+///        the edges, sorted by the position of their upper end first and by
+///        the position of their lower end second.
+/// \param LowerLayerSize The number of nodes in the lower layer.
+uint64_t countBilayerCrossings(llvm::ArrayRef<size_t> Ends,
+                               size_t LowerLayerSize);
+
 } // namespace detail
 
 template<layout::HasLayoutableGraphTraits GraphType>
@@ -0,0 +1,195 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+
+#include "revng/GraphLayout/Graphs.h"
+#include "revng/GraphLayout/SugiyamaStyle/Compute.h"
+#include "revng/Support/Assert.h"
+
+namespace yield::layout::sugiyama {
+
+/// Everything the layouter looks at when laying a graph out: the
+/// configuration, the sizes of the nodes, the edges between them, in the
+/// order the graph lists them, and the entry node. The contents of the nodes (e.g., the text of
+/// their labels) are not part of it: graphs with the same shape get the same
+/// layout.
+class GraphShape {
+private:
+  std::vector<uint64_t> Words;
+  uint64_t Hash = 0;
+
+  static constexpr uint64_t NoEntryNode = UINT64_MAX;
+
+public:
+  template<typename NodeData, typename EdgeData>
+  GraphShape(const InputGraph<NodeData, EdgeData> &Graph,
+             const Configuration &Configuration) {
+    append(Configuration);
+    append(Graph.size());
+
+    llvm::DenseMap<const InputNode<NodeData, EdgeData> *, size_t> Indices;
+    for (const auto *Node : Graph.nodes()) {
+      Indices.try_emplace(Node, Indices.size());
+      append(Node->Size.W);
+      append(Node->Size.H);
+    }
+
+    for (const auto *From : Graph.nodes()) {
+      append(From->successorCount());
+      for (const auto [To, Label] : From->successor_edges())
+        append(Indices.lookup(To));
+    }
+
+    // Ranking starts from the entry node: two graphs differing only in their
+    // entry node can be laid out differently.
+    auto *Entry = Graph.getEntryNode();
+    append(Entry != nullptr ? Indices.lookup(Entry) : NoEntryNode);
+
+    Hash = computeHash();
+  }
+
+public:
+  uint64_t hash() const { return Hash; }
+
+  bool operator==(const GraphShape &Other) const {
+    return Hash == Other.Hash && Words == Other.Words;
+  }
+
+private:
+  void append(uint64_t Word) { Words.push_back(Word); }
+  void append(float Value);
+  void append(const Configuration &Configuration);
+  uint64_t computeHash() const;
+};
+
+/// The coordinates the layouter assigned to the nodes and to the edges of
+/// a graph, in the order the graph lists them.
+struct CachedLayout {
+  std::vector<Point> Centers;
+  std::vector<Path> Paths;
+};
+
+/// A thread-safe cache of layouts indexed by the shape of the graph they
+/// belong to. When more than `Capacity` layouts are stored, the oldest ones
+/// are evicted.
+class LayoutCache {
+private:
+  struct Entry {
+    GraphShape Shape;
+    std::shared_ptr<const CachedLayout> Layout;
+  };
+  using EntryList = std::list<Entry>;
+
+private:
+  size_t Capacity;
+  mutable std::mutex Mutex;
+
+  /// All the entries, the oldest first.
+  EntryList Entries;
+
+  /// The entries, indexed by the hash of their shape.
+  std::unordered_multimap<uint64_t, EntryList::iterator> Index;
+
+  size_t Hits = 0;
+  size_t Misses = 0;
+
+public:
+  explicit LayoutCache(size_t Capacity = 1024) : Capacity(Capacity) {}
+  LayoutCache(const LayoutCache &) = delete;
+  LayoutCache &operator=(const LayoutCache &) = delete;
+
+public:
+  std::shared_ptr<const CachedLayout> find(const GraphShape &Shape);
+  void insert(GraphShape &&Shape, CachedLayout &&Layout);
+  void clear();
+
+  size_t hits() const {
+    std::lock_guard Lock(Mutex);
+    return Hits;
+  }
+
+  size_t misses() const {
+    std::lock_guard Lock(Mutex);
+    return Misses;
+  }
+};
+
+namespace detail {
+
+template<typename NodeData, typename EdgeData>
+CachedLayout extractLayout(const OutputGraph<NodeData, EdgeData> &Graph) {
+  CachedLayout Result;
+  Result.Centers.reserve(Graph.size());
+  for (const auto *Node : Graph.nodes())
+    Result.Centers.push_back(Node->Center);
+
+  for (const auto *From : Graph.nodes())
+    for (const auto [To, Label] : From->successor_edges())
+      Result.Paths.push_back(Label->Path);
+
+  return Result;
+}
+
+template<typename NodeData, typename EdgeData>
+void applyLayout(const CachedLayout &Layout,
+                 OutputGraph<NodeData, EdgeData> &Graph) {
+  revng_assert(Layout.Centers.size() == Graph.size());
+
+  auto CenterIterator = Layout.Centers.begin();
+  for (auto *Node : Graph.nodes())
+    Node->Center = *CenterIterator++;
+
+  auto PathIterator = Layout.Paths.begin();
+  for (auto *From : Graph.nodes()) {
+    for (auto [To, Label] : From->successor_edges()) {
+      revng_assert(PathIterator != Layout.Paths.end());
+      Label->Path = *PathIterator++;
+    }
+  }
+  revng_assert(PathIterator == Layout.Paths.end());
+}
+
+} // namespace detail
+
+/// Same as `compute`, except the layout is reused if a graph with the same
+/// shape was already laid out through \p Cache.
+///
+/// \param Graph An input graph
+/// \param Configuration An object configuring the specifics of the layout
+/// \param Cache The cache to look the layout up in and to store it into
+///
+/// \return The laid out version of the graph corresponding to \ref Graph
+template<typename NodeData, typename EdgeData = Empty>
+inline std::optional<layout::OutputGraph<NodeData, EdgeData>>
+computeCached(const layout::InputGraph<NodeData, EdgeData> &Graph,
+              const Configuration &Configuration,
+              LayoutCache &Cache) {
+  GraphShape Shape(Graph, Configuration);
+
+  using OutputGraph = layout::OutputGraph<NodeData, EdgeData>;
+  std::optional<OutputGraph> Result = layout::detail::convert(Graph);
+  if (auto Layout = Cache.find(Shape)) {
+    detail::applyLayout(*Layout, *Result);
+    return Result;
+  }
+
+  if (!computeInPlace(&Result.value(), Configuration))
+    return std::nullopt;
+
+  Cache.insert(std::move(Shape), detail::extractLayout(*Result));
+  return Result;
+}
+
+} // namespace yield::layout::sugiyama
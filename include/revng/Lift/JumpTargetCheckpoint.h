@@ -0,0 +1,56 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Lift/Lift.h"
+#include "revng/Support/MetaAddress.h"
+
+/// The jump targets found by lifting a binary, saved so that the next time the
+/// same binary is lifted the exploration can start from them.
+///
+/// The checkpoint is a text file, `#` starts a comment. Each line starts with a
+/// keyword:
+///
+///     version <FormatVersion> <hash of the revng components>
+///     binary <SHA1 of the binary>
+///     model <SHA1 of the parts of the model the lifter reads>
+///     entry <address of an entry point in the model> [<SHA1 of its function>]
+///     jt <address> <names of the reasons of the jump target>
+///
+/// A checkpoint can only be used by a run on the same binary, by the same
+/// revng, with the same model except for new entry points: all the entry
+/// points it was produced from have to be there, unchanged.
+struct JumpTargetCheckpoint {
+public:
+  static constexpr unsigned FormatVersion = 2;
+
+public:
+  std::string ComponentsHash;
+  std::string BinaryHash;
+  std::string ModelHash;
+
+  /// The hash of the model function at each entry point, if any
+  std::map<MetaAddress, std::string> EntryPoints;
+
+  /// The reasons of each jump target, as a bitmask of `JTReason::Values`
+  std::map<MetaAddress, uint32_t> JumpTargets;
+
+public:
+  static llvm::Expected<JumpTargetCheckpoint> parse(llvm::StringRef Text);
+
+  void dump(llvm::raw_ostream &Output) const;
+
+  /// \return an error if a run identified by \p Current can't start from this
+  ///         checkpoint
+  llvm::Error checkCompatibility(const JumpTargetCheckpoint &Current) const;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <set>
+#include <vector>
+
+#include "revng/Support/MetaAddress.h"
+
+/// Splits \p Addresses in at most \p Count regions of contiguous addresses,
+/// each with the same number of addresses, give or take one.
+std::vector<std::vector<MetaAddress>>
+partitionIntoRegions(const std::set<MetaAddress> &Addresses, size_t Count);
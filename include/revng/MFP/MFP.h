@@ -4,12 +4,18 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <algorithm>
 #include <compare>
 #include <cstddef>
 #include <map>
 #include <queue>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallSet.h"
@@ -19,6 +25,7 @@
 #include "revng/ADT/Concepts.h"
 #include "revng/ADT/GenericGraph.h"
 #include "revng/ADT/ReversePostOrderTraversal.h"
+#include "revng/Support/Assert.h"
 
 namespace MFP {
 
@@ -135,15 +142,13 @@ getMaximalFixedPoint(const MFI &Instance,
   return AnalysisResult;
 }
 
+/// Collect the nodes from which the visits of \p Flow should start: the
+/// extremal labels first, then the entry node (if any) and then all the others
 template<MonotoneFrameworkInstance MFI,
-         typename GT = llvm::GraphTraits<typename MFI::GraphType>,
-         typename LGT = typename MFI::Label>
-MFIResultMap<MFI>
-getMaximalFixedPoint(const MFI &Instance,
-                     typename MFI::GraphType Flow,
-                     typename MFI::LatticeElement InitialValue,
-                     typename MFI::LatticeElement ExtremalValue,
-                     const std::vector<typename MFI::Label> &ExtremalLabels) {
+         typename GT = llvm::GraphTraits<typename MFI::GraphType>>
+std::vector<typename MFI::Label>
+getInitialNodes(typename MFI::GraphType Flow,
+                const std::vector<typename MFI::Label> &ExtremalLabels) {
   using Label = typename MFI::Label;
   std::vector<Label> InitialNodes(ExtremalLabels);
 
@@ -157,6 +162,20 @@ getMaximalFixedPoint(const MFI &Instance,
        llvm::make_range(GT::nodes_begin(Flow), GT::nodes_end(Flow))) {
     InitialNodes.push_back(Node);
   }
+
+  return InitialNodes;
+}
+
+template<MonotoneFrameworkInstance MFI,
+         typename GT = llvm::GraphTraits<typename MFI::GraphType>,
+         typename LGT = typename MFI::Label>
+MFIResultMap<MFI>
+getMaximalFixedPoint(const MFI &Instance,
+                     typename MFI::GraphType Flow,
+                     typename MFI::LatticeElement InitialValue,
+                     typename MFI::LatticeElement ExtremalValue,
+                     const std::vector<typename MFI::Label> &ExtremalLabels) {
+  auto InitialNodes = getInitialNodes<MFI, GT>(Flow, ExtremalLabels);
   return getMaximalFixedPoint<MFI, GT, LGT>(Instance,
                                             Flow,
                                             InitialValue,
@@ -165,4 +184,179 @@ getMaximalFixedPoint(const MFI &Instance,
                                             InitialNodes);
 }
 
+/// Results of the maximal fixed point stored contiguously
+///
+/// Entries are laid out in the order in which the labels have been visited,
+/// i.e., in reverse post order, followed by any extremal label that could not
+/// be reached. Lookups by label go through a DenseMap to the entry index.
+template<typename Label, typename LatticeElement>
+class DenseResultMap {
+public:
+  using value_type = std::pair<Label, MFPResult<LatticeElement>>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+  llvm::DenseMap<Label, unsigned> Indices;
+  std::vector<value_type> Entries;
+
+public:
+  size_t size() const { return Entries.size(); }
+  bool empty() const { return Entries.empty(); }
+
+  iterator begin() { return Entries.begin(); }
+  iterator end() { return Entries.end(); }
+  const_iterator begin() const { return Entries.begin(); }
+  const_iterator end() const { return Entries.end(); }
+
+  bool contains(Label L) const { return Indices.count(L) != 0; }
+
+  MFPResult<LatticeElement> &at(Label L) { return Entries[indexOf(L)].second; }
+  const MFPResult<LatticeElement> &at(Label L) const {
+    return Entries[indexOf(L)].second;
+  }
+
+  /// Drop all the entries, retaining the allocated memory
+  void clear() {
+    Indices.clear();
+    Entries.clear();
+  }
+
+public:
+  unsigned indexOf(Label L) const {
+    auto It = Indices.find(L);
+    revng_assert(It != Indices.end());
+    return It->second;
+  }
+
+  value_type &operator[](unsigned Index) { return Entries[Index]; }
+
+  /// \return the entry for \p L, appending it if it's not there yet
+  MFPResult<LatticeElement> &getOrAppend(Label L) {
+    auto [It, New] = Indices.try_emplace(L, Entries.size());
+    if (New)
+      Entries.emplace_back(L, MFPResult<LatticeElement>{});
+    return Entries[It->second].second;
+  }
+};
+
+template<MonotoneFrameworkInstance MFI>
+using DenseMFIResultMap = DenseResultMap<typename MFI::Label,
+                                         typename MFI::LatticeElement>;
+
+/// Alternative engine for the maximal fixed point computation
+///
+/// It computes exactly what getMaximalFixedPoint does, visiting labels in the
+/// same order, but the labels are numbered once in reverse post order and then
+/// everything is indexed by that number: lattice values and successors live in
+/// contiguous vectors and the worklist is a bit vector. An instance can be
+/// reused across invocations to avoid reallocating its buffers.
+template<MonotoneFrameworkInstance MFI,
+         typename GT = llvm::GraphTraits<typename MFI::GraphType>,
+         typename LGT = typename MFI::Label>
+class DenseMaximalFixedPoint {
+public:
+  using Label = typename MFI::Label;
+  using LatticeElement = typename MFI::LatticeElement;
+  using ResultType = DenseMFIResultMap<MFI>;
+
+private:
+  ResultType Result;
+  llvm::DenseSet<Label> Visited;
+  /// Successors of each label in CSR form: the successors of the label with
+  /// index I are in Successors[SuccessorsBegin[I]..SuccessorsBegin[I + 1]]
+  std::vector<unsigned> SuccessorsBegin;
+  std::vector<unsigned> Successors;
+  llvm::BitVector Pending;
+
+public:
+  const ResultType &run(const MFI &Instance,
+                        typename MFI::GraphType Flow,
+                        LatticeElement InitialValue,
+                        LatticeElement ExtremalValue,
+                        const std::vector<Label> &ExtremalLabels,
+                        const std::vector<Label> &InitialNodes) {
+    Result.clear();
+    Visited.clear();
+    SuccessorsBegin.clear();
+    Successors.clear();
+
+    // Number the labels in reverse post order
+    for (Label Start : InitialNodes) {
+      if (Visited.contains(Start))
+        continue;
+
+      using SetType = llvm::DenseSet<Label>;
+      ReversePostOrderTraversalExt<LGT, GT, SetType> RPOTE(Start, Visited);
+      for (Label Node : RPOTE)
+        Result.getOrAppend(Node).InValue = InitialValue;
+    }
+    unsigned Reachable = Result.size();
+
+    for (Label ExtremalLabel : ExtremalLabels)
+      Result.getOrAppend(ExtremalLabel).InValue = ExtremalValue;
+
+    SuccessorsBegin.reserve(Reachable + 1);
+    for (unsigned Index = 0; Index < Reachable; ++Index) {
+      SuccessorsBegin.push_back(Successors.size());
+      for (Label End : successors<GT>(Result[Index].first))
+        Successors.push_back(Result.indexOf(End));
+    }
+    SuccessorsBegin.push_back(Successors.size());
+
+    // Process pending labels, lowest index first
+    Pending.clear();
+    Pending.resize(Reachable, true);
+    unsigned Cursor = 0;
+    int Next = -1;
+    while ((Next = Pending.find_first_in(Cursor, Reachable)) != -1) {
+      unsigned Index = Next;
+      Pending.reset(Index);
+      Cursor = Index + 1;
+
+      auto &[Start, LabelAnalysis] = Result[Index];
+      const LatticeElement &In = LabelAnalysis.InValue;
+      LabelAnalysis.OutValue = Instance.applyTransferFunction(Start, In);
+
+      for (unsigned I = SuccessorsBegin[Index]; I < SuccessorsBegin[Index + 1];
+           ++I) {
+        unsigned EndIndex = Successors[I];
+        auto &PartialEnd = Result[EndIndex].second;
+        if (!Instance.isLessOrEqual(LabelAnalysis.OutValue,
+                                    PartialEnd.InValue)) {
+          PartialEnd.InValue = Instance.combineValues(PartialEnd.InValue,
+                                                      LabelAnalysis.OutValue);
+          Pending.set(EndIndex);
+          Cursor = std::min(Cursor, EndIndex);
+        }
+      }
+    }
+
+    return Result;
+  }
+
+  /// Move out the results of the last run
+  ResultType takeResult() { return std::move(Result); }
+};
+
+/// Same as getMaximalFixedPoint, but using DenseMaximalFixedPoint
+template<MonotoneFrameworkInstance MFI,
+         typename GT = llvm::GraphTraits<typename MFI::GraphType>,
+         typename LGT = typename MFI::Label>
+DenseMFIResultMap<MFI> getDenseMaximalFixedPoint(
+  const MFI &Instance,
+  typename MFI::GraphType Flow,
+  typename MFI::LatticeElement InitialValue,
+  typename MFI::LatticeElement ExtremalValue,
+  const std::vector<typename MFI::Label> &ExtremalLabels) {
+  DenseMaximalFixedPoint<MFI, GT, LGT> Engine;
+  Engine.run(Instance,
+             Flow,
+             InitialValue,
+             ExtremalValue,
+             ExtremalLabels,
+             getInitialNodes<MFI, GT>(Flow, ExtremalLabels));
+  return Engine.takeResult();
+}
+
 } // namespace MFP
@@ -212,3 +212,20 @@ private:
 };
 
 #include "revng/Model/Generated/Late/Binary.h"
+
+namespace model {
+
+/// Verify \p Model, obtained by applying \p Diff to a model known to verify
+///
+/// Only the objects touched by \p Diff and the ones depending on them are
+/// verified again, along with the global namespace. If \p Diff touches anything
+/// whose consequences are not tracked (e.g., `Architecture`), this falls back
+/// to `Binary::verify`.
+bool verifyDiff(const model::Binary &Model,
+                const TupleTreeDiff<model::Binary> &Diff,
+                VerifyHelper &VH);
+bool verifyDiff(const model::Binary &Model,
+                const TupleTreeDiff<model::Binary> &Diff,
+                bool Assert = false);
+
+} // namespace model
@@ -0,0 +1,63 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "revng/Model/Binary.h"
+
+struct ImporterOptions;
+
+/// On-disk cache of the models imported from the libraries a binary depends on
+///
+/// Entries are keyed by the GNU build-id of the library, the version of revng,
+/// the debug information available for the library and all the importer
+/// options that can affect the result. Only the parts of the model used to
+/// look up the prototypes of dynamic functions are retained (see `prune`).
+/// They are stored in the binary tuple tree encoding, which is decoded directly
+/// from the memory-mapped file.
+///
+/// The cache is only used when `--cache-dependency-models` is passed.
+class DependencyModelCache {
+private:
+  /// Where the entries live, empty if caching is disabled
+  std::string Directory;
+
+public:
+  /// Initialize the cache from the command line options
+  DependencyModelCache();
+
+  /// Initialize a cache whose entries live in \p Directory
+  explicit DependencyModelCache(std::string Directory);
+
+public:
+  bool isEnabled() const { return not Directory.empty(); }
+
+  /// \return the key for the library identified by \p BuildID, whose debug
+  ///         information is in \p DebugInfoPath (if any), imported for
+  ///         \p Architecture with \p Options, or an empty string if the
+  ///         library cannot be cached.
+  static std::string key(llvm::StringRef BuildID,
+                         const std::optional<std::string> &DebugInfoPath,
+                         model::Architecture::Values Architecture,
+                         const ImporterOptions &Options);
+
+  /// \return the model stored for \p Key, if any and if it's valid.
+  std::optional<TupleTree<model::Binary>> load(llvm::StringRef Key) const;
+
+  /// Store \p Model under \p Key, ignoring (and logging) any I/O error.
+  void store(llvm::StringRef Key, const TupleTree<model::Binary> &Model) const;
+
+  /// Drop from \p Model everything that cannot affect the lookup of a
+  /// prototype by name: functions without a prototype, segments, relocations,
+  /// stack frames and all the types that become unreachable.
+  static void prune(TupleTree<model::Binary> &Model);
+
+private:
+  std::string pathFor(llvm::StringRef Key) const;
+};
@@ -32,3 +32,5 @@ extern llvm::cl::opt<uint64_t> BaseAddress;
 extern llvm::cl::list<std::string> ImportDebugInfo;
 extern llvm::cl::opt<DebugInfoLevel> DebugInfo;
 extern llvm::cl::opt<bool> EnableRemoteDebugInfo;
+extern llvm::cl::opt<bool> CacheDependencyModels;
+extern llvm::cl::opt<std::string> DependencyModelsCachePath;
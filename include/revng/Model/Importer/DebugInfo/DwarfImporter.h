@@ -4,12 +4,30 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <optional>
+#include <string>
+
 #include "llvm/Object/Binary.h"
 
 #include "revng/Model/Binary.h"
 
 struct ImporterOptions;
 
+/// \return the GNU build-id of \p B as an hexadecimal string, or an empty
+///         string if it has none.
+///
+/// \note \p B must be an ELF object file.
+std::string getBuildID(const llvm::object::Binary *B);
+
+/// \return the path of the file the debug information of \p FileName would be
+///         imported from without fetching it: \p FileName itself if it has
+///         embedded debug information, otherwise its detached debug file, if
+///         present on the device.
+///
+/// \note \p B must be the object file of \p FileName.
+std::optional<std::string> findLocalDebugInfo(llvm::StringRef FileName,
+                                              const llvm::object::Binary *B);
+
 class DwarfImporter {
 private:
   TupleTree<model::Binary> &Model;
@@ -25,6 +25,23 @@ namespace pipeline {
 
 class LLVMContainer;
 
+/// Adds to \p Manager, which is about to run on the module of \p Container,
+/// passes exposing the data cached in the container, see
+/// LLVMContainer::getCache
+using ContainerPassesHook = void (*)(const LLVMContainer &Container,
+                                     llvm::legacy::PassManager &Manager);
+
+/// Registers a ContainerPassesHook, to be declared as a static global
+class RegisterContainerPasses {
+public:
+  explicit RegisterContainerPasses(ContainerPassesHook Hook);
+};
+
+/// Invokes all the registered ContainerPassesHooks, must be called before
+/// adding any other pass to \p Manager
+void addContainerPasses(const LLVMContainer &Container,
+                        llvm::legacy::PassManager &Manager);
+
 class LLVMPassWrapperBase {
 public:
   virtual ~LLVMPassWrapperBase() = default;
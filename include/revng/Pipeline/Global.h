@@ -51,6 +51,13 @@ public:
   deserializeDiff(const llvm::MemoryBuffer &Diff) = 0;
 
   virtual bool verify() const = 0;
+
+  /// Verify this global, obtained by applying \p Diff to a global known to
+  /// verify. Unless overridden, this performs a full verification.
+  virtual bool verify(const GlobalTupleTreeDiff &Diff) const {
+    return verify();
+  }
+
   virtual void clear() = 0;
 
   virtual llvm::Expected<std::unique_ptr<Global>>
@@ -78,6 +85,9 @@ class TupleTreeGlobal : public Global {
 private:
   TupleTree<Object> Value;
 
+  /// The encoding used by `store`, `load` accepts any of them
+  TupleTreeFormat StorageFormat = TupleTreeFormat::YAML;
+
   static const char &getID() {
     static char ID;
     return ID;
@@ -121,6 +131,22 @@ public:
     return llvm::Error::success();
   }
 
+  TupleTreeFormat getStorageFormat() const { return StorageFormat; }
+  void setStorageFormat(TupleTreeFormat Format) { StorageFormat = Format; }
+
+  llvm::Error store(const revng::FilePath &Path) const override {
+    if (StorageFormat == TupleTreeFormat::YAML)
+      return Global::store(Path);
+
+    auto MaybeWritableFile = Path.getWritableFile();
+    if (not MaybeWritableFile)
+      return MaybeWritableFile.takeError();
+
+    auto &WritableFile = MaybeWritableFile.get();
+    Value.serialize(WritableFile->os(), StorageFormat);
+    return WritableFile->commit();
+  }
+
   llvm::Error deserialize(const llvm::MemoryBuffer &Buffer) override {
     auto MaybeTupleTree = TupleTree<Object>::deserialize(Buffer.getBuffer());
     if (!MaybeTupleTree)
@@ -146,6 +172,16 @@ public:
 
   bool verify() const override { return Value->verify(); }
 
+  bool verify(const GlobalTupleTreeDiff &Diff) const override {
+    // Use the incremental verification, if the tuple tree provides one
+    const TupleTreeDiff<Object> *Casted = Diff.getAs<Object>();
+    if constexpr (requires { verifyDiff(*Value, *Casted); })
+      if (Casted != nullptr)
+        return verifyDiff(*Value, *Casted);
+
+    return verify();
+  }
+
   GlobalTupleTreeDiff diff(const Global &Other) const override {
     const TupleTreeGlobal &Casted = llvm::cast<TupleTreeGlobal>(Other);
     auto Diff = ::diff(*Value, *Casted.Value);
@@ -4,6 +4,12 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <map>
+#include <memory>
+#include <typeindex>
+
+#include "llvm/Support/MemoryBuffer.h"
+
 #include "revng/Pipeline/ContainerEnumerator.h"
 #include "revng/Pipeline/Pipe.h"
 #include "revng/Support/ModuleStatistics.h"
@@ -29,10 +35,23 @@ private:
   using ThisType = LLVMContainer;
 
 private:
+  /// The bitcode Module has been lazily loaded from, if any.
+  ///
+  /// While Module is lazy, it has not been changed in any way other than by
+  /// materializing function bodies, hence this is also its serialized form.
+  mutable std::unique_ptr<llvm::MemoryBuffer> Bitcode;
+
   std::unique_ptr<llvm::Module> Module;
 
+  /// True if Module has been lazily loaded from Bitcode and some function
+  /// bodies might have not been materialized yet
+  mutable bool IsLazy = false;
+
+  /// Objects caching data derived from Module, see getCache
+  mutable std::map<std::type_index, std::shared_ptr<void>> Caches;
+
 public:
-  inline static const llvm::StringRef MIMEType = "text/x.llvm.ir";
+  inline static const llvm::StringRef MIMEType = "application/x.llvm.bc";
 
   LLVMContainer(llvm::StringRef Name,
                 Context *Ctx,
@@ -54,8 +73,38 @@ public:
   }
 
 public:
-  const llvm::Module &getModule() const { return *Module; }
-  llvm::Module &getModule() { return *Module; }
+  const llvm::Module &getModule() const {
+    materializeAll();
+    return *Module;
+  }
+
+  llvm::Module &getModule() {
+    materializeAll();
+    return *Module;
+  }
+
+  /// Returns the module without materializing the function bodies that have
+  /// not been loaded yet.
+  ///
+  /// Only global objects, their attributes and the metadata attached to them
+  /// can be inspected on the returned module, function bodies might be missing.
+  /// To change the module, use getModule.
+  const llvm::Module &getUnmaterializedModule() const { return *Module; }
+
+  /// \return the instance of \p T associated to the module of this container,
+  ///         default-constructing it on first use.
+  ///
+  /// This lets pipes share data derived from the module, e.g., decoded
+  /// metadata, without recomputing it. The instance is destroyed as soon as
+  /// the module is replaced, by deserialization, merging or clearing, hence
+  /// \p T must not rely on anything that does not live as long as the module.
+  template<typename T>
+  T &getCache() const {
+    std::shared_ptr<void> &Slot = Caches[std::type_index(typeid(T))];
+    if (not Slot)
+      Slot = std::make_shared<T>();
+    return *static_cast<T *>(Slot.get());
+  }
 
 public:
   std::unique_ptr<ContainerBase>
@@ -72,10 +121,18 @@ public:
   void clear() final {
     Module = std::make_unique<llvm::Module>("revng.module",
                                             Module->getContext());
+    Bitcode.reset();
+    IsLazy = false;
+    Caches.clear();
   }
 
 private:
   void mergeBackImpl(ThisType &&OtherContainer) final;
+
+  llvm::Error deserializeTextualIR(const llvm::MemoryBuffer &Buffer);
+
+  void materialize(llvm::Function &F) const;
+  void materializeAll() const;
 };
 
 } // namespace pipeline
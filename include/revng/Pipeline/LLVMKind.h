@@ -20,6 +20,10 @@ namespace pipeline {
 ///
 /// compactTargets must collapse the targets into the * target if they are all
 /// presents, do no thing otherwise.
+///
+/// symbolToTarget can be invoked on functions whose body has not been
+/// materialized yet, hence it must only inspect the declaration of the function
+/// and the metadata attached to it.
 class LLVMKind : public KindForContainer<LLVMContainer> {
 public:
   using StaticContainer = llvm::SmallVector<LLVMKind *, 4>;
@@ -68,7 +72,7 @@ public:
                       const LLVMContainer &Container) const {
 
     llvm::DenseSet<const llvm::Function *> ToReturn;
-    for (auto &GL : Container.getModule().functions()) {
+    for (auto &GL : Container.getUnmaterializedModule().functions()) {
       auto MaybeTarget = symbolToTarget(GL);
       if (not MaybeTarget.has_value())
         continue;
@@ -116,7 +120,7 @@ public:
   TargetsList enumerate(const Context &Ctx,
                         const LLVMContainer &Container) const final {
     TargetsList::List L;
-    for (auto &GL : Container.getModule().functions()) {
+    for (auto &GL : Container.getUnmaterializedModule().functions()) {
       auto MaybeTarget = symbolToTarget(GL);
       if (not MaybeTarget.has_value())
         continue;
@@ -131,7 +135,7 @@ public:
   untrackedFunctions(const LLVMContainer &Container) {
     llvm::DenseSet<const llvm::Function *> ToReturn;
 
-    for (const auto &F : Container.getModule().functions())
+    for (const auto &F : Container.getUnmaterializedModule().functions())
       if (not hasOwner(F))
         ToReturn.insert(&F);
 
@@ -4,9 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/YAMLTraits.h"
 
@@ -50,44 +55,74 @@ public:
 /// container you can get the list of tuple tree paths that contribuited to that
 /// target in that container, and from a tuple tree path you can know all the
 /// targets that have been created reading the field pointed by that path.
+///
+/// Paths are stored in a trie with one level per path component, so that
+/// paths sharing a prefix (e.g., all the fields of a function) share the
+/// storage for it and looking up a path costs a lookup per component,
+/// regardless of how many paths are recorded. Each target is stored once and
+/// referred to by its index.
 class PathTargetBimap {
 private:
-  using MapType = std::map<TupleTreePath, std::set<TargetInContainer>>;
-  using ReverseMapType = std::map<TargetInContainer,
-                                  std::vector<TupleTreePath>>;
-  MapType Map;
+  using TargetID = unsigned;
+
+  struct Node {
+    std::map<TupleTreeKeyWrapper, std::unique_ptr<Node>> Children;
+    /// Sorted indices in Targets of the targets that read this path
+    llvm::SmallVector<TargetID, 2> Readers;
+  };
+
+  /// The node for the empty path
+  std::unique_ptr<Node> Root;
+
+  /// All the targets ever inserted, indexed by TargetID. Removed targets leave
+  /// a hole, whose ID is recycled by the next insertion.
+  std::vector<std::optional<TargetInContainer>> Targets;
+  std::vector<TargetID> FreeIDs;
+  std::map<TargetInContainer, TargetID> IDs;
+
   // When we will instrument the entire pipeline there will not be any longer a
   // need to have a reverse map, since it will only be inspected at load time of
   // the pipeline.
-  ReverseMapType ReverseMap;
+  /// For each TargetID, the nodes it has been registered in
+  std::vector<std::vector<Node *>> ReverseMap;
 
 public:
-  explicit PathTargetBimap() : Map() {}
+  explicit PathTargetBimap() : Root(std::make_unique<Node>()) {}
+  PathTargetBimap(PathTargetBimap &&) = default;
+  PathTargetBimap &operator=(PathTargetBimap &&) = default;
+  PathTargetBimap(const PathTargetBimap &Other);
+  PathTargetBimap &operator=(const PathTargetBimap &Other) {
+    if (&Other != this)
+      *this = PathTargetBimap(Other);
+    return *this;
+  }
 
 public:
-  auto begin() { return Map.begin(); }
-  auto end() { return Map.end(); }
-  auto begin() const { return Map.begin(); }
-  auto end() const { return Map.end(); }
+  /// Invoke \p Callback on each path with at least a target depending on it,
+  /// along with such targets (an `ArrayRef<const TargetInContainer *>`).
+  /// Paths are visited in ascending order.
+  template<typename CallableType>
+  void visit(CallableType &&Callback) const {
+    TupleTreePath Path;
+    llvm::SmallVector<const TargetInContainer *, 4> Readers;
+    visitImpl(*Root, Path, Readers, Callback);
+  }
 
-public:
-  auto find(const TupleTreePath &Path) const { return Map.find(Path); }
+  /// Add to \p Out all the targets depending on at least one of \p Paths.
+  void collectTargetsReading(llvm::ArrayRef<const TupleTreePath *> Paths,
+                             ContainerToTargetsMap &Out) const;
+
+  /// \return true if no target depends on anything.
+  bool empty() const { return IDs.empty(); }
 
 public:
-  void merge(PathTargetBimap &&Other) {
-    for (auto &Entry : Other.Map)
-      for (auto &Target : Entry.second)
-        insert(std::move(Target), std::move(Entry.first));
-  }
+  void merge(PathTargetBimap &&Other);
 
 public:
-  void clear() { Map = MapType(); }
+  void clear() { *this = PathTargetBimap(); }
 
   void insert(const TargetInContainer &TargetInContainer,
-              const TupleTreePath &Path) {
-    Map[Path].insert(TargetInContainer);
-    ReverseMap[TargetInContainer].push_back(Path);
-  }
+              const TupleTreePath &Path);
 
   void insert(const Target &Target,
               const std::string &ContainerName,
@@ -96,24 +131,36 @@ public:
     insert(Located, Path);
   }
 
-  void remove(const TargetsList &List, llvm::StringRef ContainerName) {
-    for (auto &Target : List) {
-      TargetInContainer ToErase(Target, ContainerName.str());
-      auto Iter = ReverseMap.find(ToErase);
-      if (Iter == ReverseMap.end())
-        continue;
+  void remove(const TargetsList &List, llvm::StringRef ContainerName);
 
-      for (auto &Path : Iter->second) {
-        Map.at(Path).erase(ToErase);
-      }
+public:
+  bool contains(const TargetInContainer &Target) const {
+    return IDs.find(Target) != IDs.end();
+  }
 
-      ReverseMap.erase(Iter);
+private:
+  TargetID getOrCreateID(const TargetInContainer &Target);
+  const Node *lookup(const TupleTreePath &Path) const;
+
+  template<typename CallableType>
+  void visitImpl(const Node &Current,
+                 TupleTreePath &Path,
+                 llvm::SmallVector<const TargetInContainer *, 4> &Readers,
+                 CallableType &Callback) const {
+    if (not Current.Readers.empty()) {
+      Readers.clear();
+      for (TargetID ID : Current.Readers)
+        Readers.push_back(&*Targets[ID]);
+      const TupleTreePath &ConstPath = Path;
+      Callback(ConstPath, llvm::ArrayRef<const TargetInContainer *>(Readers));
     }
-  }
 
-public:
-  bool contains(const TargetInContainer &Target) const {
-    return ReverseMap.find(Target) != ReverseMap.end();
+    for (const auto &[Key, Child] : Current.Children) {
+      Path.resize(Path.size() + 1);
+      Path[Path.size() - 1] = Key;
+      visitImpl(*Child, Path, Readers, Callback);
+      Path.pop_back();
+    }
   }
 };
 
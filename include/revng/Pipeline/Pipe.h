@@ -209,20 +209,13 @@ struct PipeWrapper {
     llvm::StringMap<PathTargetBimap> PathCache;
 
   public:
-    void registerTargetsDependingOn(const Context &Ctx,
-                                    llvm::StringRef GlobalName,
-                                    const TupleTreePath &Path,
-                                    ContainerToTargetsMap &Out) const {
-      if (auto Iter = PathCache.find(GlobalName); Iter != PathCache.end()) {
-
-        auto &Bimap = Iter->second;
-        auto It = Bimap.find(Path);
-        if (It == Bimap.end())
-          return;
-
-        for (const auto &Entry : It->second)
-          Out.add(Entry.getContainerName(), Entry.getTarget());
-      }
+    void
+    registerTargetsDependingOn(const Context &Ctx,
+                               llvm::StringRef GlobalName,
+                               llvm::ArrayRef<const TupleTreePath *> Paths,
+                               ContainerToTargetsMap &Out) const {
+      if (auto Iter = PathCache.find(GlobalName); Iter != PathCache.end())
+        Iter->second.collectTargetsReading(Paths, Out);
     }
 
     void remove(const ContainerToTargetsMap &Map) {
@@ -43,6 +43,10 @@ private:
   Vector ReversePostOrderIndexes;
   llvm::StringMap<AnalysesList> AnalysesLists;
 
+  /// Maximum number of worker processes used to produce independent groups of
+  /// targets of the same step. 1 means everything runs in this process.
+  unsigned Jobs = 1;
+
 public:
   template<typename T>
   using DereferenceIteratorType = ::revng::DereferenceIteratorType<T>;
@@ -72,6 +76,18 @@ public:
 
   const KindsRegistry &getKindsRegistry() const;
 
+  /// Sets the number of worker processes that can be used by run.
+  ///
+  /// Workers are spawned with fork, hence run falls back to producing
+  /// everything in this process while the hosting process has other threads
+  /// running.
+  void setJobs(unsigned NewJobs) {
+    revng_assert(NewJobs > 0);
+    Jobs = NewJobs;
+  }
+
+  unsigned getJobs() const { return Jobs; }
+
   llvm::Error apply(const GlobalTupleTreeDiff &Diff,
                     pipeline::TargetInStepSet &Map);
   void getDiffInvalidations(const GlobalTupleTreeDiff &Diff,
@@ -163,6 +179,15 @@ public:
 
   llvm::Error run(const State &ToProduce);
 
+private:
+  /// Runs \p Step so that it produces \p Output reading \p Input from its
+  /// predecessor, splitting the work among up to Jobs worker processes.
+  llvm::Error runInWorkers(Step &Step,
+                           const ContainerToTargetsMap &Output,
+                           const ContainerToTargetsMap &Input);
+
+public:
+
   AnalysisWrapper *findAnalysis(llvm::StringRef AnalysisName) {
     for (auto &Step : Steps) {
       if (Step.second.hasAnalysis(AnalysisName))
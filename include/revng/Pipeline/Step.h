@@ -102,14 +102,15 @@ public:
 public:
   // TODO: drop the Out parameter pattern if favour of coorutines in the whole
   // codebase.
+  /// Register in \p Out the targets of this step depending on any of \p Paths
   void registerTargetsDependingOn(llvm::StringRef GlobalName,
-                                  const TupleTreePath &Path,
+                                  llvm::ArrayRef<const TupleTreePath *> Paths,
                                   TargetInStepSet &Out) const {
     ContainerToTargetsMap OutMap;
     for (const PipeWrapper &Pipe : Pipes) {
       Pipe.InvalidationMetadata.registerTargetsDependingOn(*Ctx,
                                                            GlobalName,
-                                                           Path,
+                                                           Paths,
                                                            OutMap);
     }
     for (auto &Container : OutMap) {
@@ -249,6 +250,10 @@ public:
   /// containers and returns the containers filtered according to the request.
   ContainerSet run(ContainerSet &&Targets);
 
+  /// Executes all the pipes of this step on Input and returns the resulting
+  /// containers, without merging them in the backing containers.
+  ContainerSet cloneAndRun(ContainerSet &&Input);
+
   /// Returns the set of goals that are already contained in the backing
   /// containers of this step, furthermore adds to the container ToLoad those
   /// that were not present.
@@ -272,6 +277,16 @@ public:
   llvm::Error store(const revng::DirectoryPath &DirPath) const;
   llvm::Error load(const revng::DirectoryPath &DirPath);
 
+  /// Stores the containers produced by cloneAndRun, together with the
+  /// invalidation metadata of this step, so that another instance of the same
+  /// pipeline can import them with mergeBack.
+  llvm::Error storeProduced(const ContainerSet &Produced,
+                            const revng::DirectoryPath &DirPath) const;
+
+  /// Merges in the backing containers and in the invalidation metadata of this
+  /// step what has been saved by storeProduced in DirPath.
+  llvm::Error mergeBack(const revng::DirectoryPath &DirPath);
+
   std::vector<revng::FilePath>
   getWrittenFiles(const revng::DirectoryPath &DirPath) const;
 
@@ -5,7 +5,9 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <iterator>
 #include <optional>
@@ -33,6 +35,59 @@ class TargetsList;
 class ContainerBase;
 class Context;
 
+/// Process-wide pool of the path components of targets
+///
+/// Each distinct list of path components is stored exactly once, so targets
+/// can refer to it through a pointer: copying a target does not allocate and
+/// two targets have the same path if and only if they point to the same entry.
+/// Entries are reference counted and freed when the last target using them is
+/// destroyed. The pool is split in shards, each with its own lock, which is
+/// only taken to create an entry or to drop its last reference.
+class TargetPathInterner {
+public:
+  using PathComponents = std::vector<std::string>;
+
+  class Entry {
+  private:
+    friend class TargetPathInterner;
+
+  private:
+    PathComponents Components;
+    mutable std::atomic<uint64_t> References = 0;
+    /// Key of this entry in its shard
+    llvm::StringRef Key;
+    unsigned Shard = 0;
+
+  public:
+    const PathComponents &components() const { return Components; }
+  };
+
+public:
+  /// \return the entry for \p Components, with a new reference to it
+  static const Entry *intern(PathComponents &&Components);
+
+  static void retain(const Entry *Path) {
+    Path->References.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void release(const Entry *Path) {
+    // Only the last reference needs to synchronize with intern
+    uint64_t References = Path->References.load(std::memory_order_relaxed);
+    while (References > 1) {
+      if (Path->References.compare_exchange_weak(References,
+                                                 References - 1,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed))
+        return;
+    }
+
+    releaseLast(Path);
+  }
+
+private:
+  static void releaseLast(const Entry *Path);
+};
+
 /// A target is a triple of Kind, PathComponents, and Exactness used to
 /// enumerate and transform the contents of a container.
 ///
@@ -42,52 +97,92 @@ class Context;
 /// Kind
 class Target {
 private:
-  using PathComponents = std::vector<std::string>;
-  PathComponents Components;
+  using PathComponents = TargetPathInterner::PathComponents;
+  /// Interned through TargetPathInterner, null only once moved from
+  const TargetPathInterner::Entry *Path;
   const Kind *K;
 
 public:
   Target(PathComponents Components, const Kind &K) :
-    Components(std::move(Components)), K(&K) {
-    revng_assert(this->Components.size() == getKind().depth());
+    Path(TargetPathInterner::intern(std::move(Components))), K(&K) {
+    revng_assert(getPathComponents().size() == getKind().depth());
   }
 
   Target(std::string PathComponent, const Kind &K) :
-    Components({ std::move(PathComponent) }), K(&K) {
-    revng_assert(this->Components.size() == getKind().depth());
+    Path(TargetPathInterner::intern({ std::move(PathComponent) })), K(&K) {
+    revng_assert(getPathComponents().size() == getKind().depth());
   }
 
-  Target(std::initializer_list<std::string> Names, const Kind &K) : K(&K) {
-    for (auto Name : Names)
-      Components.emplace_back(Name);
-    revng_assert(this->Components.size() == getKind().depth());
+  Target(std::initializer_list<std::string> Names, const Kind &K) :
+    Path(TargetPathInterner::intern(PathComponents(Names))), K(&K) {
+    revng_assert(getPathComponents().size() == getKind().depth());
   }
 
   Target(llvm::ArrayRef<llvm::StringRef> Names, const Kind &K) : K(&K) {
+    PathComponents NewComponents;
+    NewComponents.reserve(Names.size());
     for (auto Name : Names) {
-      Components.emplace_back(Name.str());
+      NewComponents.emplace_back(Name.str());
     }
-    revng_assert(this->Components.size() == getKind().depth());
+    Path = TargetPathInterner::intern(std::move(NewComponents));
+    revng_assert(getPathComponents().size() == getKind().depth());
   }
 
-  Target(const Kind &K) : K(&K) {
-    revng_assert(this->Components.size() == getKind().depth());
+  Target(const Kind &K) : Path(TargetPathInterner::intern({})), K(&K) {
+    revng_assert(getPathComponents().size() == getKind().depth());
+  }
+
+  Target(const Target &Other) : Path(Other.Path), K(Other.K) {
+    TargetPathInterner::retain(Path);
+  }
+
+  Target(Target &&Other) noexcept : Path(Other.Path), K(Other.K) {
+    Other.Path = nullptr;
+  }
+
+  Target &operator=(const Target &Other) {
+    TargetPathInterner::retain(Other.Path);
+    if (Path != nullptr)
+      TargetPathInterner::release(Path);
+    Path = Other.Path;
+    K = Other.K;
+    return *this;
+  }
+
+  Target &operator=(Target &&Other) noexcept {
+    std::swap(Path, Other.Path);
+    K = Other.K;
+    return *this;
+  }
+
+  ~Target() {
+    if (Path != nullptr)
+      TargetPathInterner::release(Path);
   }
 
 public:
   bool operator<(const Target &Other) const {
-    auto Self = std::tie(K, Components);
-    auto OtherSelf = std::tie(Other.K, Other.Components);
-    return Self < OtherSelf;
+    if (K != Other.K)
+      return std::less<const Kind *>()(K, Other.K);
+
+    // Interned paths are equal if and only if they are the same object
+    if (Path == Other.Path)
+      return false;
+
+    return getPathComponents() < Other.getPathComponents();
   }
 
   int operator<=>(const Target &Other) const;
 
-  bool operator==(const Target &Other) const { return (*this <=> Other) == 0; }
+  bool operator==(const Target &Other) const {
+    return K == Other.K and Path == Other.Path;
+  }
 
 public:
   const Kind &getKind() const { return *K; }
-  const PathComponents &getPathComponents() const { return Components; }
+  const PathComponents &getPathComponents() const {
+    return Path->components();
+  }
 
 public:
   void setKind(const Kind &NewKind) { K = &NewKind; }
@@ -106,8 +201,10 @@ public:
       return Component;
     };
 
-    auto Path = llvm::join(llvm::map_range(Components, ComponentToString), "/");
-    OS << Path;
+    auto Joined = llvm::join(llvm::map_range(getPathComponents(),
+                                             ComponentToString),
+                             "/");
+    OS << Joined;
     OS << ':' << K->name().str();
     OS << '\n';
   }
@@ -119,9 +216,9 @@ public:
   template<typename OStream>
   void dumpPathComponents(OStream &OS) const debug_function {
     OS << "/";
-    for (const auto &Entry : Components) {
+    for (const auto &Entry : getPathComponents()) {
       OS << Entry;
-      if (&Entry != &Components.back())
+      if (&Entry != &getPathComponents().back())
         OS << "/";
     }
     OS << ":" << K->name().str();
@@ -153,7 +250,12 @@ private:
 
 public:
   TargetsList() = default;
-  TargetsList(List C) : Contained(std::move(C)) {}
+  TargetsList(List C) : Contained(std::move(C)) {
+    if (not llvm::is_sorted(Contained))
+      llvm::sort(Contained);
+    Contained.erase(unique(Contained.begin(), Contained.end()),
+                    Contained.end());
+  }
   static TargetsList allTargets(const Context &Ctx, const Kind &K) {
     TargetsList ToReturn;
     K.appendAllTargets(Ctx, ToReturn);
@@ -204,20 +306,13 @@ public:
 public:
   template<typename... Args>
   void emplace_back(Args &&...A) {
-    Contained.emplace_back(std::forward<Args>(A)...);
-    llvm::sort(Contained);
-    Contained.erase(unique(Contained.begin(), Contained.end()),
-                    Contained.end());
+    push_back(Target(std::forward<Args>(A)...));
   }
 
   void merge(const TargetsList &Other);
 
-  void push_back(const Target &Target) {
-    Contained.push_back(Target);
-    llvm::sort(Contained);
-    Contained.erase(unique(Contained.begin(), Contained.end()),
-                    Contained.end());
-  }
+  /// Insert \p Target in its position, unless it's already there
+  void push_back(const Target &Target);
 
   template<typename... Args>
   auto erase(Args &&...A) {
@@ -231,7 +326,6 @@ public:
                           Other.begin(),
                           Other.end(),
                           std::back_inserter(ToReturn.Contained));
-    llvm::sort(ToReturn.Contained);
     return ToReturn;
   }
 
@@ -356,8 +450,7 @@ public:
   }
 
   void add(llvm::StringRef Name, const TargetsList &Targets) {
-    for (const auto &Target : Targets)
-      Status[Name].emplace_back(Target);
+    Status[Name].merge(Targets);
   }
 
 public:
@@ -17,7 +17,8 @@ namespace options {
 using pipeline::Option;
 
 constexpr inline std::tuple DiffOptions = { Option("global-name", ""),
-                                            Option("diff-content", "") };
+                                            Option("diff-content", ""),
+                                            Option("full-verification", 0) };
 
 constexpr inline std::tuple SetOptions = { Option("global-name", ""),
                                            Option("global-content", "") };
@@ -26,6 +27,9 @@ constexpr inline std::tuple SetOptions = { Option("global-name", ""),
 
 /// This analysis that applies a tuple-tree diff to the specified global. If
 /// applying the diff fails the global is guaranteed to be left untouched.
+///
+/// Only the parts of the global affected by the diff are verified again, unless
+/// `full-verification` is set.
 struct ApplyDiffAnalysis {
   static constexpr auto Name = "apply-diff";
   constexpr static std::tuple Options = options::DiffOptions;
@@ -34,7 +38,8 @@ struct ApplyDiffAnalysis {
 
   llvm::Error run(pipeline::ExecutionContext &Ctx,
                   std::string DiffGlobalName,
-                  std::string DiffContent);
+                  std::string DiffContent,
+                  int FullVerification);
 };
 
 /// This analysis that verifies that a diff will apply to a global. If
@@ -48,7 +53,8 @@ struct VerifyDiffAnalysis {
 
   llvm::Error run(pipeline::ExecutionContext &Ctx,
                   std::string DiffGlobalNane,
-                  std::string DiffContent);
+                  std::string DiffContent,
+                  int FullVerification);
 };
 
 /// This analysis replaces the contents of the specified global with the one
@@ -8,6 +8,7 @@
 
 #include "revng/EarlyFunctionAnalysis/FunctionMetadataCache.h"
 #include "revng/Model/LoadModelPass.h"
+#include "revng/Pipeline/GenericLLVMPipe.h"
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/LLVMContainer.h"
 #include "revng/Pipes/ModelGlobal.h"
@@ -21,6 +22,7 @@ public:
   void run(const pipeline::ExecutionContext &Ctx,
            pipeline::LLVMContainer &Container) {
     llvm::legacy::PassManager Manager;
+    pipeline::addContainerPasses(Container, Manager);
     registerPasses(Ctx.getContext(), Manager);
     Manager.run(Container.getModule());
   }
@@ -46,7 +48,6 @@ public:
                       llvm::legacy::PassManager &Manager) const {
     auto Global = llvm::cantFail(Ctx.getGlobal<ModelGlobal>(ModelGlobalName));
     Manager.add(new LoadModelWrapperPass(ModelWrapper(Global->get())));
-    Manager.add(new FunctionMetadataCachePass());
     (Manager.add(new Passes()), ...);
   };
 };
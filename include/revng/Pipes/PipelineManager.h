@@ -158,6 +158,10 @@ public:
 
   void dump() const { Runner->dump(); }
 
+  /// Sets the maximum number of worker processes used to produce targets, see
+  /// pipeline::Runner::setJobs.
+  void setJobs(unsigned Jobs) { Runner->setJobs(Jobs); }
+
   const pipeline::Runner &getRunner() const { return *Runner; }
   pipeline::Runner &getRunner() { return *Runner; }
 
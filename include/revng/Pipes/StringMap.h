@@ -5,9 +5,14 @@
 //
 
 #include <map>
+#include <memory>
+#include <string>
 #include <utility>
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/YAMLTraits.h"
 
 #include "revng/Pipeline/Container.h"
@@ -18,6 +23,8 @@
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/ModelGlobal.h"
 #include "revng/Pipes/TypeKind.h"
+#include "revng/Storage/ReadableFile.h"
+#include "revng/Support/GzipStream.h"
 #include "revng/Support/GzipTarFile.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/MetaAddress/YAMLTraits.h"
@@ -35,6 +42,21 @@ struct DataOffset {
 template<typename T>
 using OffsetMap = std::map<T, DataOffset>;
 
+/// The index of an archive, describing where each entry is. It's only valid
+/// for the archive it has been produced for, i.e., the one with the same size
+/// and hash.
+template<typename T>
+struct ArchiveIndex {
+  uint64_t ArchiveSize = 0;
+  std::string ArchiveHash;
+  OffsetMap<T> Entries;
+};
+
+inline std::string hashArchive(llvm::StringRef Archive) {
+  return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(Archive)),
+                     true);
+}
+
 } // namespace detail
 
 namespace llvm::yaml {
@@ -48,6 +70,16 @@ struct MappingTraits<::detail::DataOffset> {
   }
 };
 
+template<typename T>
+  requires HasScalarTraits<T>
+struct MappingTraits<::detail::ArchiveIndex<T>> {
+  static void mapping(IO &IO, ::detail::ArchiveIndex<T> &Value) {
+    IO.mapRequired("ArchiveSize", Value.ArchiveSize);
+    IO.mapRequired("ArchiveHash", Value.ArchiveHash);
+    IO.mapRequired("Entries", Value.Entries);
+  }
+};
+
 template<typename T>
   requires HasScalarTraits<T>
 struct CustomMappingTraits<::detail::OffsetMap<T>> {
@@ -98,14 +130,44 @@ public:
 
 private:
   using OffsetMap = ::detail::OffsetMap<KeyType>;
-  MapType Map;
+  using ArchiveIndex = ::detail::ArchiveIndex<KeyType>;
+
+  /// An entry of an archive loaded through its index which has not been
+  /// decompressed yet
+  struct LazyEntry {
+    /// An in-memory copy of the compressed archive
+    std::shared_ptr<const llvm::MemoryBuffer> Archive;
+    ::detail::DataOffset Offset;
+
+    llvm::ArrayRef<char> compressed() const {
+      const llvm::MemoryBuffer &Buffer = *Archive;
+      return { Buffer.getBufferStart() + Offset.Start,
+               Offset.End - Offset.Start + 1 };
+    }
+
+    std::string decompress() const {
+      std::string Result;
+      Result.reserve(Offset.UncompressedSize);
+      llvm::raw_string_ostream OS(Result);
+      gzipDecompress(OS, compressed());
+      OS.flush();
+      revng_check(Result.size() == Offset.UncompressedSize);
+      return Result;
+    }
+  };
+  using LazyMapType = std::map<KeyType, LazyEntry>;
+
+  /// Entries are either in Map or in LazyMap, never in both. Entries are moved
+  /// from LazyMap to Map the first time their content is accessed.
+  mutable MapType Map;
+  mutable LazyMapType LazyMap;
 
 public:
   inline static char ID = '0';
 
 public:
   GenericStringMap(llvm::StringRef Name) :
-    pipeline::Container<GenericStringMap>(Name), Map() {
+    pipeline::Container<GenericStringMap>(Name), Map(), LazyMap() {
     revng_assert(&K->rank() == Rank);
   }
 
@@ -118,7 +180,10 @@ public:
   ~GenericStringMap() override = default;
 
 public:
-  void clear() override { Map.clear(); }
+  void clear() override {
+    Map.clear();
+    LazyMap.clear();
+  }
 
   std::unique_ptr<pipeline::ContainerBase>
   cloneFiltered(const pipeline::TargetsList &Targets) const override {
@@ -132,8 +197,10 @@ public:
       return Targets.contains(EntryTarget);
     };
 
-    // Drop all the entries in Map that are not in Targets
+    // Drop all the entries in Map that are not in Targets. Lazy entries are
+    // filtered without being decompressed.
     std::erase_if(Clone->Map, std::not_fn(EntryIsInTargets));
+    std::erase_if(Clone->LazyMap, std::not_fn(EntryIsInTargets));
 
     return Clone;
   }
@@ -143,9 +210,16 @@ public:
     revng_check(&Target.getKind() == K);
 
     std::string KeyString = Target.getPathComponents().back();
+    KeyType Key = keyFromString(KeyString);
 
-    auto It = find(keyFromString(KeyString));
-    revng_check(It != end());
+    // Stream lazy entries straight out of the archive, without caching them
+    if (auto It = LazyMap.find(Key); It != LazyMap.end()) {
+      gzipDecompress(OS, It->second.compressed());
+      return llvm::Error::success();
+    }
+
+    auto It = Map.find(Key);
+    revng_check(It != Map.end());
 
     OS << It->second;
 
@@ -154,8 +228,10 @@ public:
 
   pipeline::TargetsList enumerate() const override {
     pipeline::TargetsList::List Result;
-    for (const auto &[Key, Value] : Map)
+    const auto AddTarget = [&](const KeyType &Key, const auto &) {
       Result.push_back({ keyToString(Key), *K });
+    };
+    visitInOrder(AddTarget, AddTarget);
 
     return Result;
   }
@@ -163,16 +239,13 @@ public:
   bool remove(const pipeline::TargetsList &Targets) override {
     bool Changed = false;
 
-    auto End = Map.end();
     for (const pipeline::Target &T : Targets) {
       revng_assert(&T.getKind() == K);
 
       std::string KeyString = T.getPathComponents().back();
-      auto It = Map.find(keyFromString(KeyString));
-      if (It != End) {
-        Map.erase(It);
+      KeyType Key = keyFromString(KeyString);
+      if (Map.erase(Key) > 0 or LazyMap.erase(Key) > 0)
         Changed = true;
-      }
     }
 
     return Changed;
@@ -194,8 +267,16 @@ public:
     if (not MaybeWritableFile)
       return MaybeWritableFile.takeError();
 
-    OffsetMap Offsets = serializeWithOffsets(MaybeWritableFile.get()->os());
+    // Keep a copy of the archive, the index records its hash
+    std::string Archive;
+    llvm::raw_string_ostream ArchiveStream(Archive);
+    ArchiveIndex Index;
+    Index.Entries = serializeWithOffsets(ArchiveStream);
+    ArchiveStream.flush();
+    Index.ArchiveSize = Archive.size();
+    Index.ArchiveHash = ::detail::hashArchive(Archive);
 
+    MaybeWritableFile.get()->os() << Archive;
     if (auto Error = MaybeWritableFile.get()->commit(); Error)
       return Error;
 
@@ -203,7 +284,7 @@ public:
     auto MaybeWritableIndexFile = IndexPath.getWritableFile();
     if (!!MaybeWritableIndexFile) {
       llvm::yaml::Output IndexOutput(MaybeWritableIndexFile.get()->os());
-      IndexOutput << Offsets;
+      IndexOutput << Index;
 
       if (auto Error = MaybeWritableIndexFile.get()->commit(); Error)
         return Error;
@@ -224,6 +305,14 @@ public:
       return llvm::Error::success();
     }
 
+    auto MaybeLoaded = loadFromIndex(Path);
+    if (not MaybeLoaded)
+      return MaybeLoaded.takeError();
+
+    if (MaybeLoaded.get())
+      return llvm::Error::success();
+
+    // No usable index, decompress the whole archive
     auto MaybeBuffer = Path.getReadableFile();
     if (not MaybeBuffer)
       return MaybeBuffer.takeError();
@@ -246,17 +335,35 @@ protected:
     // We first merge this->Map into Other.Map (which keeps Other's version if
     // present), and then we replace this->Map with the newly merged version of
     // Other.Map.
+    // Since an entry can be either lazy or not, first drop from this container
+    // all the entries that Other is going to replace.
+    for (const auto &Entry : Other.Map)
+      this->LazyMap.erase(Entry.first);
+    for (const auto &Entry : Other.LazyMap)
+      this->Map.erase(Entry.first);
+
     Other.Map.merge(std::move(this->Map));
     this->Map = std::move(Other.Map);
+    Other.LazyMap.merge(std::move(this->LazyMap));
+    this->LazyMap = std::move(Other.LazyMap);
   }
 
 public:
   /// std::map-like methods
 
-  std::string &operator[](KeyType M) { return Map[M]; };
+  std::string &operator[](KeyType M) {
+    materialize(M);
+    return Map[M];
+  };
 
-  std::string &at(KeyType M) { return Map.at(M); };
-  const std::string &at(KeyType M) const { return Map.at(M); };
+  std::string &at(KeyType M) {
+    materialize(M);
+    return Map.at(M);
+  };
+  const std::string &at(KeyType M) const {
+    materialize(M);
+    return Map.at(M);
+  };
 
 private:
   using IteratedValue = std::pair<const KeyType &, std::string &>;
@@ -280,28 +387,42 @@ public:
   };
 
   auto insert_or_assign(KeyType Key, const std::string &Value) {
+    LazyMap.erase(Key);
     auto [Iterator, Success] = Map.insert_or_assign(Key, Value);
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
   auto insert_or_assign(KeyType Key, std::string &&Value) {
+    LazyMap.erase(Key);
     auto [Iterator, Success] = Map.insert_or_assign(Key, std::move(Value));
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
 
-  bool contains(KeyType Key) const { return Map.contains(Key); }
+  bool contains(KeyType Key) const {
+    return Map.contains(Key) or LazyMap.contains(Key);
+  }
 
   auto find(KeyType Key) {
+    materialize(Key);
     return revng::map_iterator(Map.find(Key), this->mapIt);
   }
 
   auto find(KeyType Key) const {
+    materialize(Key);
     return revng::map_iterator(Map.find(Key), this->mapCIt);
   }
 
-  auto begin() { return revng::map_iterator(Map.begin(), this->mapIt); }
+  // Note: end() does not need to decompress anything, since the end iterator
+  // of a std::map is not affected by insertions
+  auto begin() {
+    materializeAll();
+    return revng::map_iterator(Map.begin(), this->mapIt);
+  }
   auto end() { return revng::map_iterator(Map.end(), this->mapIt); }
 
-  auto begin() const { return revng::map_iterator(Map.begin(), this->mapCIt); }
+  auto begin() const {
+    materializeAll();
+    return revng::map_iterator(Map.begin(), this->mapCIt);
+  }
   auto end() const { return revng::map_iterator(Map.end(), this->mapCIt); }
 
 private:
@@ -311,21 +432,124 @@ private:
       revng_assert(Name.consume_back(ArchiveSuffix));
       KeyType Key = keyFromString(Name);
       std::string Data = std::string(Entry.Data.data(), Entry.Data.size());
+      LazyMap.erase(Key);
       Map[Key] = Data;
     }
   }
 
+  /// Try to load the archive at \p Path lazily, using the index produced by
+  /// store. Returns false if there's no usable index, e.g., if it has been
+  /// left behind by an interrupted store and describes another archive.
+  llvm::Expected<bool> loadFromIndex(const revng::FilePath &Path) {
+    revng::FilePath IndexPath = Path.addExtension("idx");
+    auto MaybeIndexExists = IndexPath.exists();
+    if (not MaybeIndexExists)
+      return MaybeIndexExists.takeError();
+
+    if (not MaybeIndexExists.get())
+      return false;
+
+    auto MaybeIndexFile = IndexPath.getReadableFile();
+    if (not MaybeIndexFile)
+      return MaybeIndexFile.takeError();
+
+    ArchiveIndex Index;
+    llvm::yaml::Input IndexInput(MaybeIndexFile.get()->buffer());
+    IndexInput >> Index;
+    if (IndexInput.error())
+      return false;
+
+    auto MaybeArchive = Path.getReadableFile();
+    if (not MaybeArchive)
+      return MaybeArchive.takeError();
+
+    // Lazy entries must not refer to the file itself: storing to the same
+    // path, from this container or from one of its clones, truncates it while
+    // they are still in use. Keep the compressed archive in memory instead.
+    llvm::StringRef Mapped = MaybeArchive.get()->buffer().getBuffer();
+    if (Mapped.size() != Index.ArchiveSize
+        or ::detail::hashArchive(Mapped) != Index.ArchiveHash)
+      return false;
+
+    std::shared_ptr<const llvm::MemoryBuffer> Archive;
+    Archive = llvm::MemoryBuffer::getMemBufferCopy(Mapped);
+    for (const auto &[Key, Offset] : Index.Entries)
+      if (Offset.Start > Offset.End or Offset.End >= Index.ArchiveSize)
+        return false;
+
+    for (const auto &[Key, Offset] : Index.Entries) {
+      Map.erase(Key);
+      LazyMap.insert_or_assign(Key, LazyEntry{ Archive, Offset });
+    }
+
+    return true;
+  }
+
+  void materialize(const KeyType &Key) const {
+    auto It = LazyMap.find(Key);
+    if (It == LazyMap.end())
+      return;
+
+    Map.emplace(Key, It->second.decompress());
+    LazyMap.erase(It);
+  }
+
+  void materializeAll() const {
+    for (const auto &[Key, Entry] : LazyMap)
+      Map.emplace(Key, Entry.decompress());
+    LazyMap.clear();
+  }
+
+  /// Visit all the entries in key order, invoking \p OnValue on the
+  /// decompressed ones and \p OnLazy on the lazy ones
+  template<typename ValueCallable, typename LazyCallable>
+  void visitInOrder(ValueCallable &&OnValue, LazyCallable &&OnLazy) const {
+    auto MapIt = Map.begin();
+    auto LazyIt = LazyMap.begin();
+    while (MapIt != Map.end() or LazyIt != LazyMap.end()) {
+      bool TakeLazy = MapIt == Map.end()
+                      or (LazyIt != LazyMap.end()
+                          and Map.key_comp()(LazyIt->first, MapIt->first));
+      if (TakeLazy) {
+        OnLazy(LazyIt->first, LazyIt->second);
+        ++LazyIt;
+      } else {
+        OnValue(MapIt->first, MapIt->second);
+        ++MapIt;
+      }
+    }
+  }
+
   OffsetMap serializeWithOffsets(llvm::raw_ostream &OS) const {
     OffsetMap Result;
     revng::GzipTarWriter Writer(OS);
-    for (auto &[Key, Data] : Map) {
+
+    const auto Record = [&Result](const KeyType &Key,
+                                  size_t UncompressedSize,
+                                  const OffsetDescriptor &Offsets) {
+      Result[Key] = { .UncompressedSize = UncompressedSize,
+                      .Start = Offsets.DataStart,
+                      .End = Offsets.PaddingStart - 1 };
+    };
+
+    const auto AppendValue = [&](const KeyType &Key, const std::string &Data) {
       std::string Name = keyToString(Key) + ArchiveSuffix;
       OffsetDescriptor Offsets = Writer.append(Name,
                                                { Data.data(), Data.size() });
-      Result[Key] = { .UncompressedSize = Data.size(),
-                      .Start = Offsets.DataStart,
-                      .End = Offsets.PaddingStart - 1 };
-    }
+      Record(Key, Data.size(), Offsets);
+    };
+
+    // Lazy entries are copied over as they are, without recompressing them
+    const auto AppendLazy = [&](const KeyType &Key, const LazyEntry &Entry) {
+      std::string Name = keyToString(Key) + ArchiveSuffix;
+      size_t Size = Entry.Offset.UncompressedSize;
+      OffsetDescriptor Offsets = Writer.appendCompressed(Name,
+                                                         Size,
+                                                         Entry.compressed());
+      Record(Key, Size, Offsets);
+    };
+
+    visitInOrder(AppendValue, AppendLazy);
     Writer.close();
 
     return Result;
@@ -20,21 +20,27 @@
 
 namespace revng::pipes {
 
+/// \tparam DefaultFormat the encoding used by `store` for the content of new
+///         containers, `load` and `deserialize` accept any of them.
 template<TupleTreeCompatible T,
          pipeline::SingleElementKind *K,
          const char *TypeName,
-         const char *MIME>
+         const char *MIME,
+         TupleTreeFormat DefaultFormat = TupleTreeFormat::YAML>
 class TupleTreeContainer
-  : public pipeline::Container<TupleTreeContainer<T, K, TypeName, MIME>> {
+  : public pipeline::Container<
+      TupleTreeContainer<T, K, TypeName, MIME, DefaultFormat>> {
 private:
   std::optional<TupleTree<T>> Content;
+  TupleTreeFormat StorageFormat = DefaultFormat;
 
 public:
   inline static const char ID = 0;
   inline static const llvm::StringRef MIMEType = MIME;
   inline static const char *Name = TypeName;
 
-  using Base = pipeline::Container<TupleTreeContainer<T, K, TypeName, MIME>>;
+  using Base = pipeline::Container<
+    TupleTreeContainer<T, K, TypeName, MIME, DefaultFormat>>;
 
   TupleTreeContainer(llvm::StringRef Name) :
     pipeline::Container<TupleTreeContainer>(Name), Content(std::nullopt) {}
@@ -42,11 +48,13 @@ public:
   TupleTreeContainer(const TupleTreeContainer &Other) :
     TupleTreeContainer(Other.name()) {
     Content = Other.Content;
+    StorageFormat = Other.StorageFormat;
   }
 
   TupleTreeContainer(TupleTreeContainer &&Other) :
     TupleTreeContainer(Other.name()) {
     Content = std::move(Other.Content);
+    StorageFormat = Other.StorageFormat;
   }
 
   bool empty() const { return not Content.has_value(); }
@@ -70,6 +78,9 @@ public:
     return *Content;
   }
 
+  TupleTreeFormat getStorageFormat() const { return StorageFormat; }
+  void setStorageFormat(TupleTreeFormat Format) { StorageFormat = Format; }
+
   TupleTreeContainer &operator=(const TupleTreeContainer &Other) {
     if (this == &Other)
       return *this;
@@ -153,7 +164,16 @@ public:
       return llvm::Error::success();
     }
 
-    return Base::store(Path);
+    if (StorageFormat == TupleTreeFormat::YAML)
+      return Base::store(Path);
+
+    auto MaybeWritableFile = Path.getWritableFile();
+    if (not MaybeWritableFile)
+      return MaybeWritableFile.takeError();
+
+    auto &WritableFile = MaybeWritableFile.get();
+    Content->serialize(WritableFile->os(), StorageFormat);
+    return WritableFile->commit();
   }
 
   llvm::Error load(const revng::FilePath &Path) override {
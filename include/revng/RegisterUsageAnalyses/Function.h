@@ -154,9 +154,7 @@ public:
 
 public:
   void simplify(const llvm::SmallPtrSetImpl<Function::Node *> &ToPreserve) {
-    llvm::erase_if(Nodes, [&ToPreserve](std::unique_ptr<Node> &Owning) -> bool {
-      auto *N = Owning.get();
-
+    removeNodesIf([&ToPreserve](Node *N) -> bool {
       // Check preconditions
       if (N->predecessorCount() != 1)
         return false;
@@ -32,7 +32,12 @@ public:
     Counter &= ~0x1;
     IsTracking = true;
   }
-  void access() { Counter |= (0x1 & IsTracking); }
+  void access() {
+    // Do not write when not tracking, so that a model whose tracking has been
+    // stopped can be safely read from multiple threads
+    if (IsTracking)
+      Counter |= 0x1;
+  }
   void push() {
     bool HasLeadingZeroes = llvm::countLeadingZeros(Counter) != 0;
     revng_assert(HasLeadingZeroes, "More than 8 pushes have been performed");
@@ -0,0 +1,11 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+/// \return true if this process is known to have a single thread.
+///
+/// fork only duplicates the calling thread: if another thread is holding a
+/// lock, the child process could deadlock on it.
+bool isSingleThreaded();
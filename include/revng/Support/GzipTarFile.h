@@ -68,6 +68,15 @@ public:
   GzipTarWriter &operator=(GzipTarWriter &&Other) = default;
 
   OffsetDescriptor append(llvm::StringRef Name, llvm::ArrayRef<char> Data);
+
+  /// Like ::append, but \p CompressedData is an already gzip-compressed stream
+  /// which decompresses to \p UncompressedSize bytes. The stream is copied
+  /// verbatim, which allows moving a file between archives without
+  /// recompressing it.
+  OffsetDescriptor appendCompressed(llvm::StringRef Name,
+                                    size_t UncompressedSize,
+                                    llvm::ArrayRef<char> CompressedData);
+
   void close();
 };
 
@@ -0,0 +1,474 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <set>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include "revng/ADT/Concepts.h"
+#include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/UpcastablePointer.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/TupleLikeTraits.h"
+
+// Binary encoding of tuple trees
+//
+// The encoding is driven entirely by the introspection of tuple trees
+// (`TupleLikeTraits`), just like the YAML one, and round-trips losslessly with
+// it. A document is composed by:
+//
+// * `BinaryTupleTreeMagic`;
+// * a hash of the schema of the root type, so that documents produced by a
+//   different version of the schema are rejected instead of misread;
+// * a table of all the distinct strings in the document;
+// * the root object.
+//
+// Objects are encoded as follows:
+//
+// * tuple-likes: their fields, in order;
+// * `UpcastablePointer`s: 0 if empty, otherwise 1 plus the index of the
+//   concrete type in `concrete_types_traits`, followed by the object;
+// * containers: the number of elements followed by the elements, in order;
+// * booleans and integers: (S)LEB128;
+// * strings and anything else with YAML scalar traits (enums, references,
+//   `MetaAddress`...): the index of their (YAML) textual representation in the
+//   string table.
+//
+// The string table is parsed without copying from the input buffer, which can
+// therefore be a memory mapped file.
+
+/// Prefix of the binary encoding of a tuple tree. A YAML document cannot start
+/// with a NUL character, so this is never ambiguous.
+inline constexpr auto
+  BinaryTupleTreeMagic = llvm::StringLiteral::withInnerNUL("\0TTB\1");
+
+/// \return true if \p Buffer holds a tuple tree in binary form
+inline bool isBinaryTupleTree(llvm::StringRef Buffer) {
+  return Buffer.startswith(BinaryTupleTreeMagic);
+}
+
+namespace revng::detail {
+
+template<typename T>
+concept BinaryString = std::same_as<T, std::string>
+                       or std::derived_from<T, llvm::SmallVectorImpl<char>>;
+
+template<typename T>
+concept BinarySequence = requires(T &Sequence, typename T::value_type &&V) {
+  Sequence.push_back(std::move(V));
+};
+
+template<typename T>
+struct BinaryTupleTreeSchema {
+  /// Append to \p Out a description of the layout of the encoding of T
+  static void describe(std::string &Out, std::set<llvm::StringRef> &Visited) {
+    if constexpr (StrictSpecializationOf<T, UpcastablePointer>) {
+      using concrete_types = concrete_types_traits_t<typename T::element_type>;
+      Out += '*';
+      describeConcrete<concrete_types>(Out, Visited);
+    } else if constexpr (TraitedTupleLike<T>) {
+      llvm::StringRef Name = TupleLikeTraits<T>::FullName;
+      Out.append(Name.begin(), Name.end());
+      if (not Visited.insert(Name).second)
+        return;
+      Out += '{';
+      describeFields(Out, Visited);
+      Out += '}';
+    } else if constexpr (BinaryString<T>) {
+      Out += 's';
+    } else if constexpr (KeyedObjectContainer<T>
+                         or StrictSpecializationOf<T, std::set>
+                         or BinarySequence<T>) {
+      Out += '[';
+      BinaryTupleTreeSchema<typename T::value_type>::describe(Out, Visited);
+      Out += ']';
+    } else if constexpr (std::same_as<T, bool>) {
+      Out += 'b';
+    } else if constexpr (std::unsigned_integral<T>) {
+      Out += 'u';
+    } else if constexpr (std::signed_integral<T>) {
+      Out += 'i';
+    } else {
+      Out += 'y';
+    }
+  }
+
+private:
+  template<size_t I = 0>
+  static void describeFields(std::string &Out,
+                             std::set<llvm::StringRef> &Visited) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      llvm::StringRef Name = TupleLikeTraits<T>::FieldNames[I];
+      Out.append(Name.begin(), Name.end());
+      Out += ':';
+      using Element = std::remove_cvref_t<std::tuple_element_t<I, T>>;
+      BinaryTupleTreeSchema<Element>::describe(Out, Visited);
+      Out += ';';
+      describeFields<I + 1>(Out, Visited);
+    }
+  }
+
+  template<typename Types, size_t I = 0>
+  static void describeConcrete(std::string &Out,
+                               std::set<llvm::StringRef> &Visited) {
+    if constexpr (I < std::tuple_size_v<Types>) {
+      using Element = std::tuple_element_t<I, Types>;
+      BinaryTupleTreeSchema<Element>::describe(Out, Visited);
+      Out += '|';
+      describeConcrete<Types, I + 1>(Out, Visited);
+    }
+  }
+};
+
+/// \return a hash of the layout of the binary encoding of T
+template<typename T>
+uint64_t binaryTupleTreeSchemaHash() {
+  static const uint64_t Hash = [] {
+    std::string Description;
+    std::set<llvm::StringRef> Visited;
+    BinaryTupleTreeSchema<T>::describe(Description, Visited);
+    return llvm::xxHash64(Description);
+  }();
+  return Hash;
+}
+
+class BinaryTupleTreeWriter {
+private:
+  llvm::SmallString<0> Body;
+  llvm::raw_svector_ostream OS;
+  llvm::StringMap<uint64_t> StringIndices;
+  std::vector<llvm::StringRef> Strings;
+
+public:
+  BinaryTupleTreeWriter() : OS(Body) {}
+
+public:
+  template<typename T>
+  void write(const T &Value) {
+    if constexpr (StrictSpecializationOf<T, UpcastablePointer>) {
+      writeUpcastable(Value);
+    } else if constexpr (TraitedTupleLike<T>) {
+      writeFields(Value);
+    } else if constexpr (BinaryString<T>) {
+      writeString(llvm::StringRef(Value.data(), Value.size()));
+    } else if constexpr (KeyedObjectContainer<T>
+                         or StrictSpecializationOf<T, std::set>
+                         or BinarySequence<T>) {
+      writeInteger(Value.size());
+      for (const auto &Element : Value)
+        write(Element);
+    } else if constexpr (std::same_as<T, bool>) {
+      writeInteger(Value ? 1 : 0);
+    } else if constexpr (std::unsigned_integral<T>) {
+      writeInteger(Value);
+    } else if constexpr (std::signed_integral<T>) {
+      llvm::encodeSLEB128(Value, OS);
+    } else {
+      static_assert(HasScalarOrEnumTraits<T>,
+                    "Type not supported by the binary tuple tree encoding");
+      writeString(getNameFromYAMLScalar(Value));
+    }
+  }
+
+  /// Emit the header, the string table and everything written so far
+  template<typename T>
+  void finish(llvm::raw_ostream &Output) {
+    Output << BinaryTupleTreeMagic;
+    llvm::encodeULEB128(binaryTupleTreeSchemaHash<T>(), Output);
+    llvm::encodeULEB128(Strings.size(), Output);
+    for (llvm::StringRef String : Strings) {
+      llvm::encodeULEB128(String.size(), Output);
+      Output << String;
+    }
+    Output << Body;
+  }
+
+private:
+  void writeInteger(uint64_t Value) { llvm::encodeULEB128(Value, OS); }
+
+  void writeString(llvm::StringRef String) {
+    // The keys of a StringMap never move, Strings can point to them
+    auto [It, New] = StringIndices.try_emplace(String, Strings.size());
+    if (New)
+      Strings.push_back(It->first());
+    writeInteger(It->second);
+  }
+
+  template<size_t I = 0, typename T>
+  void writeFields(const T &Value) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      write(get<I>(Value));
+      writeFields<I + 1>(Value);
+    }
+  }
+
+  template<typename T>
+  void writeUpcastable(const T &Value) {
+    using concrete_types = concrete_types_traits_t<typename T::element_type>;
+    if (Value.get() == nullptr) {
+      writeInteger(0);
+      return;
+    }
+
+    writeConcrete<concrete_types>(*Value);
+  }
+
+  template<typename Types, size_t I = 0, typename B>
+  void writeConcrete(const B &Value) {
+    if constexpr (I < std::tuple_size_v<Types>) {
+      using Concrete = std::tuple_element_t<I, Types>;
+      if (auto *Upcasted = llvm::dyn_cast<Concrete>(&Value)) {
+        writeInteger(I + 1);
+        write(*Upcasted);
+      } else {
+        writeConcrete<Types, I + 1>(Value);
+      }
+    } else {
+      revng_abort();
+    }
+  }
+};
+
+class BinaryTupleTreeReader {
+private:
+  llvm::DataExtractor Data;
+  llvm::DataExtractor::Cursor Cursor;
+  std::vector<llvm::StringRef> Strings;
+  std::string Failure;
+
+public:
+  BinaryTupleTreeReader(llvm::StringRef Buffer) :
+    Data(Buffer, /* IsLittleEndian */ true, /* AddressSize */ 8), Cursor(0) {}
+
+public:
+  /// Parse the header and the string table
+  template<typename T>
+  llvm::Error start() {
+    using llvm::StringRef;
+    StringRef Magic = Data.getBytes(Cursor, BinaryTupleTreeMagic.size());
+    if (Magic != BinaryTupleTreeMagic)
+      return error("Not a binary tuple tree");
+
+    if (readInteger() != binaryTupleTreeSchemaHash<T>())
+      return error("The binary tuple tree has been produced for a different "
+                   "schema");
+
+    uint64_t Count = readCount();
+    if (failed())
+      return takeError();
+
+    Strings.reserve(Count);
+    for (uint64_t I = 0; I < Count and Cursor; ++I) {
+      uint64_t Size = readInteger();
+      Strings.push_back(Data.getBytes(Cursor, Size));
+    }
+
+    return takeError();
+  }
+
+  template<typename T>
+  void read(T &Value) {
+    if (failed())
+      return;
+
+    if constexpr (StrictSpecializationOf<T, UpcastablePointer>) {
+      readUpcastable(Value);
+    } else if constexpr (TraitedTupleLike<T>) {
+      readFields(Value);
+    } else if constexpr (BinaryString<T>) {
+      llvm::StringRef String = readString();
+      Value.assign(String.begin(), String.end());
+    } else if constexpr (KeyedObjectContainer<T>) {
+      using value_type = typename T::value_type;
+      using KOT = KeyedObjectTraits<value_type>;
+      using KeyType = revng::detail::Key<value_type>;
+      DefaultKeyObjectComparator<value_type> Less;
+
+      // Elements are written in order: reject anything else here, rather
+      // than letting the container assert on duplicates when the batch ends
+      std::optional<KeyType> LastKey;
+      uint64_t Count = readCount();
+      auto Inserter = Value.batch_insert();
+      for (uint64_t I = 0; I < Count and not failed(); ++I) {
+        value_type Element{};
+        read(Element);
+        if (failed())
+          break;
+
+        KeyType Key = KOT::key(Element);
+        if (LastKey.has_value() and not Less(*LastKey, Key)) {
+          fail("Duplicate or out of order key");
+          break;
+        }
+        LastKey = Key;
+
+        if constexpr (requires { Inserter.emplace(std::move(Element)); })
+          Inserter.emplace(std::move(Element));
+        else
+          Inserter.insert(Element);
+      }
+    } else if constexpr (StrictSpecializationOf<T, std::set>) {
+      uint64_t Count = readCount();
+      for (uint64_t I = 0; I < Count and not failed(); ++I) {
+        typename T::value_type Element{};
+        read(Element);
+        Value.insert(std::move(Element));
+      }
+    } else if constexpr (BinarySequence<T>) {
+      uint64_t Count = readCount();
+      for (uint64_t I = 0; I < Count and not failed(); ++I) {
+        typename T::value_type Element{};
+        read(Element);
+        Value.push_back(std::move(Element));
+      }
+    } else if constexpr (std::same_as<T, bool>) {
+      Value = readInteger() != 0;
+    } else if constexpr (std::unsigned_integral<T>) {
+      uint64_t Read = readInteger();
+      if (Read > std::numeric_limits<T>::max())
+        fail("Integer out of range");
+      Value = static_cast<T>(Read);
+    } else if constexpr (std::signed_integral<T>) {
+      int64_t Read = Data.getSLEB128(Cursor);
+      if (Read < std::numeric_limits<T>::min()
+          or Read > std::numeric_limits<T>::max())
+        fail("Integer out of range");
+      Value = static_cast<T>(Read);
+    } else {
+      Value = getValueFromYAMLScalar<T>(readString());
+    }
+  }
+
+  llvm::Error finish() {
+    if (not failed() and Cursor.tell() != Data.size())
+      fail("Trailing data after the binary tuple tree");
+    return takeError();
+  }
+
+private:
+  // Not const: checking a Cursor marks its error as checked
+  bool failed() { return not Failure.empty() or not Cursor; }
+
+  void fail(llvm::StringRef Reason) {
+    if (Failure.empty())
+      Failure = Reason.str();
+  }
+
+  llvm::Error error(llvm::StringRef Reason) {
+    fail(Reason);
+    return takeError();
+  }
+
+  llvm::Error takeError() {
+    if (llvm::Error Error = Cursor.takeError())
+      return Error;
+
+    // Use an actual error code, TupleTree::deserialize needs to convert it
+    if (not Failure.empty())
+      return llvm::createStringError(std::errc::illegal_byte_sequence,
+                                     Failure.c_str());
+
+    return llvm::Error::success();
+  }
+
+  uint64_t readInteger() { return Data.getULEB128(Cursor); }
+
+  /// Read the size of a container, making sure it's plausible before anyone
+  /// reserves memory for it
+  uint64_t readCount() {
+    uint64_t Count = readInteger();
+    if (Count > Data.size() - Cursor.tell()) {
+      fail("Invalid container size");
+      return 0;
+    }
+    return Count;
+  }
+
+  llvm::StringRef readString() {
+    uint64_t Index = readInteger();
+    if (Index >= Strings.size()) {
+      fail("Invalid string index");
+      return {};
+    }
+    return Strings[Index];
+  }
+
+  template<size_t I = 0, typename T>
+  void readFields(T &Value) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      read(get<I>(Value));
+      readFields<I + 1>(Value);
+    }
+  }
+
+  template<typename T>
+  void readUpcastable(T &Value) {
+    using concrete_types = concrete_types_traits_t<typename T::element_type>;
+    uint64_t Index = readInteger();
+    if (Index == 0)
+      Value.reset();
+    else
+      readConcrete<concrete_types>(Index - 1, Value);
+  }
+
+  template<typename Types, size_t I = 0, typename T>
+  void readConcrete(uint64_t Index, T &Value) {
+    if constexpr (I < std::tuple_size_v<Types>) {
+      using Concrete = std::tuple_element_t<I, Types>;
+      if (Index == I) {
+        Value = T::template make<Concrete>();
+        read(*llvm::cast<Concrete>(Value.get()));
+      } else {
+        readConcrete<Types, I + 1>(Index, Value);
+      }
+    } else {
+      fail("Invalid concrete type index");
+    }
+  }
+};
+
+} // namespace revng::detail
+
+/// Serialize \p Element in the binary tuple tree encoding
+template<typename T>
+void serializeBinary(llvm::raw_ostream &Stream, const T &Element) {
+  revng::detail::BinaryTupleTreeWriter Writer;
+  Writer.write(Element);
+  Writer.finish<T>(Stream);
+}
+
+/// Deserialize an object from its binary tuple tree encoding
+///
+/// \note references are not bound to any root, see
+///       `TupleTree::initializeReferences`.
+template<typename T>
+llvm::Expected<T> deserializeBinary(llvm::StringRef Buffer) {
+  revng::detail::BinaryTupleTreeReader Reader(Buffer);
+  if (llvm::Error Error = Reader.start<T>())
+    return Error;
+
+  T Result;
+  Reader.read(Result);
+  if (llvm::Error Error = Reader.finish())
+    return Error;
+
+  return Result;
+}
@@ -0,0 +1,381 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/YAMLTraits.h"
+
+#include "revng/ADT/Concepts.h"
+#include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/TupleLikeTraits.h"
+
+// Streaming YAML deserialization of tuple trees
+//
+// `llvm::yaml::Input` builds a node tree for the whole document before mapping
+// it, which makes the peak memory usage a multiple of the size of the
+// document. Tuple trees are dominated by a few large top-level sequences (e.g.,
+// the types and the functions of a model), so we split the top-level block
+// mapping into its entries and each top-level block sequence into chunks of
+// elements, and map each piece on its own, directly into the result. This way,
+// at any time, only the nodes of a single chunk are alive.
+//
+// The splitting works on lines, and only for documents whose root is a block
+// mapping with plain keys (which is what `llvm::yaml::Output` produces).
+// Anything else is handed as a whole to `llvm::yaml::Input`.
+
+/// Use deserializeStreaming when loading YAML tuple trees, see TupleTree
+extern llvm::cl::opt<bool> StreamingYAMLTupleTrees;
+
+namespace revng::detail {
+
+/// A document containing a single field of a tuple-like
+template<typename T>
+struct YAMLField {
+  const char *Name = nullptr;
+  T *Value = nullptr;
+};
+
+} // namespace revng::detail
+
+template<typename T>
+struct llvm::yaml::MappingTraits<revng::detail::YAMLField<T>> {
+  static void mapping(IO &TheIO, revng::detail::YAMLField<T> &Field) {
+    TheIO.mapRequired(Field.Name, *Field.Value);
+  }
+};
+
+namespace revng::detail {
+
+template<typename T>
+concept StreamableYAMLSequence = KeyedObjectContainer<T>
+                                 or StrictSpecializationOf<T, std::vector>;
+
+/// The YAML mapping of \p T tells which of its fields are optional, i.e., it's
+/// a `TupleLikeMappingTraits`
+template<typename T>
+concept DeclaresOptionalFields = TraitedTupleLike<T> and requires {
+  llvm::yaml::MappingTraits<T>::template isOptional<
+    static_cast<typename TupleLikeTraits<T>::Fields>(0)>();
+};
+
+template<DeclaresOptionalFields T>
+class StreamingYAMLLoader {
+private:
+  /// A top-level entry, from the first character of its key to the beginning
+  /// of the next one
+  struct Entry {
+    llvm::StringRef Key;
+    llvm::StringRef Text;
+  };
+
+private:
+  llvm::StringRef Buffer;
+  uint64_t ChunkSize = 0;
+  std::vector<Entry> Entries;
+
+public:
+  StreamingYAMLLoader(llvm::StringRef Buffer, uint64_t ChunkSize) :
+    Buffer(Buffer), ChunkSize(ChunkSize) {}
+
+public:
+  /// Split the document in its top-level entries
+  ///
+  /// \return false if the layout of the document is not supported
+  bool split() {
+    std::optional<size_t> EntryStart;
+    llvm::StringRef EntryKey;
+    auto Close = [&](size_t End) {
+      if (EntryStart) {
+        llvm::StringRef Text = Buffer.slice(*EntryStart, End);
+        Entries.push_back({ EntryKey, Text });
+      }
+    };
+
+    size_t End = Buffer.size();
+    for (size_t Start = 0; Start < Buffer.size();) {
+      size_t LineEnd = std::min(Buffer.find('\n', Start), Buffer.size());
+      llvm::StringRef Line = Buffer.slice(Start, LineEnd).rtrim('\r');
+      size_t LineStart = Start;
+      Start = LineEnd + 1;
+
+      llvm::StringRef Trimmed = Line.ltrim(" \t");
+      if (Trimmed.empty() or Trimmed.startswith("#"))
+        continue;
+
+      // Indented lines belong to the current entry
+      if (Line.front() == ' ' or Line.front() == '\t') {
+        if (not EntryStart)
+          return false;
+        continue;
+      }
+
+      if (Line.startswith("%") or Line.rtrim() == "---") {
+        // Directives and markers are fine only before the first entry
+        if (EntryStart)
+          return false;
+        continue;
+      }
+
+      if (Line.rtrim() == "...") {
+        End = LineStart;
+        break;
+      }
+
+      // Compact sequences (`Key:\n- Element`) are not indented
+      if (isSequenceItem(Line)) {
+        if (not EntryStart)
+          return false;
+        continue;
+      }
+
+      std::optional<llvm::StringRef> Key = parseKey(Line);
+      if (not Key)
+        return false;
+
+      for (const Entry &Previous : Entries)
+        if (Previous.Key == *Key)
+          return false;
+      if (EntryStart and EntryKey == *Key)
+        return false;
+
+      Close(LineStart);
+      EntryStart = LineStart;
+      EntryKey = *Key;
+    }
+    Close(End);
+
+    return not Entries.empty();
+  }
+
+  llvm::Error load(T &Result) {
+    for (const Entry &E : Entries)
+      if (llvm::Error Error = loadField(E, Result))
+        return Error;
+    return checkRequiredFields();
+  }
+
+private:
+  /// Fail if a field that is not optional is missing, just like
+  /// `llvm::yaml::Input` does when mapping the whole document
+  template<size_t I = 0>
+  llvm::Error checkRequiredFields() const {
+    if constexpr (I < std::tuple_size_v<T>) {
+      using Fields = typename TupleLikeTraits<T>::Fields;
+      using Traits = llvm::yaml::MappingTraits<T>;
+      constexpr Fields Field = static_cast<Fields>(I);
+      if constexpr (not Traits::template isOptional<Field>()) {
+        llvm::StringRef Name = TupleLikeTraits<T>::FieldNames[I];
+        auto HasName = [Name](const Entry &E) { return E.Key == Name; };
+        if (llvm::none_of(Entries, HasName))
+          return llvm::createStringError(std::errc::invalid_argument,
+                                         "Missing required key: %s",
+                                         Name.str().c_str());
+      }
+      return checkRequiredFields<I + 1>();
+    } else {
+      return llvm::Error::success();
+    }
+  }
+
+  static bool isSequenceItem(llvm::StringRef Line) {
+    return Line == "-" or Line.startswith("- ") or Line.startswith("-\t");
+  }
+
+  /// \return the key defined by \p Line, if it's a plain `Key: ...` line
+  static std::optional<llvm::StringRef> parseKey(llvm::StringRef Line) {
+    size_t Colon = Line.find(':');
+    if (Colon == 0 or Colon == llvm::StringRef::npos)
+      return std::nullopt;
+
+    llvm::StringRef Key = Line.take_front(Colon);
+    auto IsKeyCharacter = [](char C) { return llvm::isAlnum(C) or C == '_'; };
+    if (not llvm::all_of(Key, IsKeyCharacter))
+      return std::nullopt;
+
+    llvm::StringRef Rest = Line.drop_front(Colon + 1);
+    if (not Rest.empty() and Rest.front() != ' ' and Rest.front() != '\t')
+      return std::nullopt;
+
+    return Key;
+  }
+
+  template<typename FieldT>
+  static llvm::Error parse(llvm::StringRef Text,
+                           const char *Name,
+                           FieldT &Value) {
+    YAMLField<FieldT> Field{ Name, &Value };
+    llvm::yaml::Input YAMLInput(Text);
+    YAMLInput >> Field;
+    if (std::error_code EC = YAMLInput.error())
+      return llvm::errorCodeToError(EC);
+    return llvm::Error::success();
+  }
+
+  template<size_t I = 0>
+  llvm::Error loadField(const Entry &E, T &Result) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      llvm::StringRef Name = TupleLikeTraits<T>::FieldNames[I];
+      if (Name != E.Key)
+        return loadField<I + 1>(E, Result);
+
+      using FieldT = std::remove_cvref_t<decltype(get<I>(Result))>;
+      FieldT &Value = get<I>(Result);
+      if constexpr (StreamableYAMLSequence<FieldT>)
+        return loadSequence(E, Name.data(), Value);
+      else
+        return parse(E.Text, Name.data(), Value);
+    } else {
+      return llvm::createStringError(std::errc::invalid_argument,
+                                     "Unknown key: %s",
+                                     E.Key.str().c_str());
+    }
+  }
+
+  /// Load a sequence one chunk of elements at a time
+  template<typename FieldT>
+  llvm::Error loadSequence(const Entry &E, const char *Name, FieldT &Value) {
+    // Find the first element, if the value is a block sequence
+    llvm::StringRef Rest = E.Text.drop_until([](char C) { return C == '\n'; });
+    llvm::StringRef Header = E.Text.take_front(E.Text.size() - Rest.size());
+    llvm::StringRef Inline = Header.drop_front(E.Key.size() + 1).trim();
+    if (not Inline.empty() and not Inline.startswith("#"))
+      return parse(E.Text, Name, Value);
+
+    std::vector<llvm::StringRef> Elements;
+    std::optional<size_t> Indent;
+    std::optional<size_t> ElementStart;
+    for (size_t Start = Header.size(); Start < E.Text.size();) {
+      size_t LineEnd = std::min(E.Text.find('\n', Start), E.Text.size());
+      llvm::StringRef Line = E.Text.slice(Start, LineEnd).rtrim('\r');
+      size_t LineStart = Start;
+      Start = LineEnd + 1;
+
+      llvm::StringRef Trimmed = Line.ltrim(' ');
+      if (Trimmed.empty() or Trimmed.startswith("#"))
+        continue;
+
+      size_t LineIndent = Line.size() - Trimmed.size();
+      if (not Indent) {
+        if (not isSequenceItem(Trimmed))
+          return parse(E.Text, Name, Value);
+        Indent = LineIndent;
+      }
+
+      // Lines less indented than the elements are not something we expect
+      if (LineIndent < *Indent)
+        return parse(E.Text, Name, Value);
+
+      if (LineIndent == *Indent) {
+        // Everything at the indentation of the sequence must be an element
+        if (not isSequenceItem(Trimmed))
+          return parse(E.Text, Name, Value);
+
+        if (ElementStart)
+          Elements.push_back(E.Text.slice(*ElementStart, LineStart));
+        ElementStart = LineStart;
+      }
+    }
+
+    if (ElementStart)
+      Elements.push_back(E.Text.drop_front(*ElementStart));
+
+    if (Elements.empty())
+      return parse(E.Text, Name, Value);
+
+    return loadChunks(Elements, Name, Value);
+  }
+
+  template<typename FieldT>
+  llvm::Error loadChunks(llvm::ArrayRef<llvm::StringRef> Elements,
+                         const char *Name,
+                         FieldT &Value) {
+    if constexpr (KeyedObjectContainer<FieldT>) {
+      // Sort once, after all the chunks have been appended
+      auto Inserter = Value.batch_insert();
+      auto Append = [&Inserter](auto &Element) {
+        if constexpr (requires { Inserter.emplace(std::move(Element)); })
+          Inserter.emplace(std::move(Element));
+        else
+          Inserter.insert(Element);
+      };
+      return loadChunksWith<FieldT>(Elements, Name, Append);
+    } else {
+      auto Append = [&Value](auto &Element) {
+        Value.push_back(std::move(Element));
+      };
+      return loadChunksWith<FieldT>(Elements, Name, Append);
+    }
+  }
+
+  template<typename FieldT, typename AppendT>
+  llvm::Error loadChunksWith(llvm::ArrayRef<llvm::StringRef> Elements,
+                             const char *Name,
+                             AppendT &Append) {
+    std::string Document;
+    auto Flush = [&](llvm::StringRef Chunk) -> llvm::Error {
+      Document = (llvm::Twine(Name) + ":\n" + Chunk).str();
+      FieldT Parsed;
+      if (llvm::Error Error = parse(Document, Name, Parsed))
+        return Error;
+      for (auto &Element : Parsed)
+        Append(Element);
+      return llvm::Error::success();
+    };
+
+    // Elements are contiguous in the buffer: chunks are slices of it
+    const char *ChunkStart = Elements.front().begin();
+    for (llvm::StringRef Element : Elements) {
+      if (static_cast<uint64_t>(Element.end() - ChunkStart) > ChunkSize
+          and Element.begin() != ChunkStart) {
+        llvm::StringRef Chunk(ChunkStart, Element.begin() - ChunkStart);
+        if (llvm::Error Error = Flush(Chunk))
+          return Error;
+        ChunkStart = Element.begin();
+      }
+    }
+
+    llvm::StringRef Chunk(ChunkStart, Elements.back().end() - ChunkStart);
+    return Flush(Chunk);
+  }
+};
+
+} // namespace revng::detail
+
+/// Deserialize a YAML document, splitting it in chunks of approximately
+/// \p ChunkSize bytes that are mapped one at a time.
+///
+/// Returns the same result as `deserialize`. Documents that cannot be split,
+/// and types whose YAML mapping does not tell which fields are optional, are
+/// mapped as a whole.
+template<TraitedTupleLike T>
+llvm::Expected<T> deserializeStreaming(llvm::StringRef YAMLString,
+                                       uint64_t ChunkSize = 1024 * 1024) {
+  if constexpr (not revng::detail::DeclaresOptionalFields<T>) {
+    return revng::detail::deserializeImpl<T>(YAMLString);
+  } else {
+    revng::detail::StreamingYAMLLoader<T> Loader(YAMLString, ChunkSize);
+    if (not Loader.split())
+      return revng::detail::deserializeImpl<T>(YAMLString);
+
+    T Result;
+    if (llvm::Error Error = Loader.load(Result))
+      return Error;
+
+    return Result;
+  }
+}
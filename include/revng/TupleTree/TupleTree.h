@@ -21,10 +21,13 @@
 
 #include "revng/ADT/Concepts.h"
 #include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/StructuralMutationEpoch.h"
 #include "revng/ADT/UpcastablePointer.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/BinarySerialization.h"
+#include "revng/TupleTree/StreamingYAML.h"
 #include "revng/TupleTree/Tracking.h"
 #include "revng/TupleTree/TupleTreeCompatible.h"
 #include "revng/TupleTree/TupleTreePath.h"
@@ -78,6 +81,12 @@ private:
   }
 };
 
+/// The encodings a TupleTree can be serialized to, see BinarySerialization.h
+enum class TupleTreeFormat {
+  YAML,
+  Binary
+};
+
 template<TupleTreeCompatible T>
 class TupleTree {
 private:
@@ -93,7 +102,7 @@ public:
   }
   TupleTree &operator=(const TupleTree &Other) {
     if (Other.get() == nullptr) {
-      Root = nullptr;
+      dropRoot();
       AllReferencesAreCached = false;
       return *this;
     }
@@ -110,7 +119,7 @@ public:
   TupleTree(TupleTree &&Other) { *this = std::move(Other); }
   TupleTree &operator=(TupleTree &&Other) {
     if (Other.get() == nullptr) {
-      Root = nullptr;
+      dropRoot();
       AllReferencesAreCached = false;
 
       Other.Root.reset();
@@ -120,6 +129,7 @@ public:
     }
 
     if (this != &Other) {
+      dropRoot();
       Root = std::move(Other.Root);
       AllReferencesAreCached = Other.AllReferencesAreCached;
 
@@ -129,6 +139,21 @@ public:
     return *this;
   }
 
+  ~TupleTree() { dropRoot(); }
+
+private:
+  /// Destroy the whole tree, if any
+  ///
+  /// The objects it owns are destroyed without going through the containers,
+  /// hence this bumps the StructuralMutationEpoch once for all of them.
+  void dropRoot() {
+    if (Root == nullptr)
+      return;
+    StructuralMutationEpoch::bump();
+    Root.reset();
+  }
+
+public:
   template<StrictSpecializationOf<TupleTreeReference> TTR>
   void replaceReferences(const std::map<TTR, TTR> &Map) {
     auto Visitor = [&Map](TTR &Reference) {
@@ -152,10 +177,11 @@ public:
   }
 
 public:
-  static llvm::ErrorOr<TupleTree> deserialize(llvm::StringRef YAMLString) {
+  /// Deserialize a tuple tree, either in YAML or in binary form
+  static llvm::ErrorOr<TupleTree> deserialize(llvm::StringRef Buffer) {
     TupleTree Result{};
 
-    auto MaybeRoot = revng::detail::deserializeImpl<T>(YAMLString);
+    llvm::Expected<T> MaybeRoot = deserializeRoot(Buffer);
     if (not MaybeRoot)
       return llvm::errorToErrorCode(MaybeRoot.takeError());
 
@@ -167,6 +193,21 @@ public:
     return Result;
   }
 
+private:
+  static llvm::Expected<T> deserializeRoot(llvm::StringRef Buffer) {
+    if (isBinaryTupleTree(Buffer))
+      return deserializeBinary<T>(Buffer);
+
+    // On request, avoid building the YAML node tree of the whole document at
+    // once
+    if constexpr (TraitedTupleLike<T>)
+      if (StreamingYAMLTupleTrees)
+        return deserializeStreaming<T>(Buffer);
+
+    return revng::detail::deserializeImpl<T>(Buffer);
+  }
+
+public:
   static llvm::ErrorOr<TupleTree> fromFile(const llvm::StringRef &Path) {
     auto MaybeBuffer = llvm::MemoryBuffer::getFile(Path);
     if (not MaybeBuffer)
@@ -192,6 +233,15 @@ public:
     serialize(Stream);
   }
 
+  void serialize(llvm::raw_ostream &Stream, TupleTreeFormat Format) const {
+    revng_assert(Root);
+
+    if (Format == TupleTreeFormat::Binary)
+      ::serializeBinary(Stream, *Root);
+    else
+      ::serialize(Stream, *Root);
+  }
+
 public:
   const T *get() const noexcept { return Root.get(); }
   T *get() noexcept {
@@ -219,7 +269,7 @@ private:
   void initializeUncachedReferences() {
     TrackGuard Guard(*Root);
     visitReferences([this](auto &Element) {
-      Element.Root = Root.get();
+      Element.setRoot(Root.get());
       Element.evictCachedTarget();
     });
     AllReferencesAreCached = false;
@@ -229,7 +279,7 @@ public:
   void initializeReferences() {
     TrackGuard Guard(*Root);
     revng_assert(not AllReferencesAreCached);
-    visitReferences([this](auto &Element) { Element.Root = Root.get(); });
+    visitReferences([this](auto &Element) { Element.setRoot(Root.get()); });
   }
 
   void cacheReferences() {
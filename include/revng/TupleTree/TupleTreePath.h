@@ -5,7 +5,12 @@
 //
 
 #include <compare>
+#include <cstddef>
+#include <functional>
+#include <tuple>
 
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Twine.h"
 
 #include "revng/ADT/STLExtras.h"
@@ -17,12 +22,40 @@ char *typeID() {
   return &ID;
 };
 
+/// Hash \p Key using std::hash or llvm::hash_value, if available, or
+/// recursively hashing its elements, if it's tuple-like
+template<typename T>
+inline llvm::hash_code hashTupleTreeKey(const T &Key) {
+  if constexpr (requires { std::hash<T>{}(Key); }) {
+    return llvm::hash_value(std::hash<T>{}(Key));
+  } else if constexpr (requires { hash_value(Key); }) {
+    return hash_value(Key);
+  } else if constexpr (requires { std::apply([](const auto &...) {}, Key); }) {
+    auto HashElements = [](const auto &...Elements) {
+      return llvm::hash_combine(hashTupleTreeKey(Elements)...);
+    };
+    return std::apply(HashElements, Key);
+  } else {
+    // Not hashable: all the keys of this type collide, which is still correct
+    return llvm::hash_code(0);
+  }
+}
+
 class TupleTreeKeyWrapper {
 protected:
-  void *Pointer;
+  /// Keys up to this size are stored in Inline rather than on the heap, which
+  /// covers integers, MetaAddress and most of the keys of keyed objects
+  static constexpr size_t InlineSize = 24;
+  static constexpr size_t InlineAlignment = alignof(uint64_t);
+
+  template<typename T>
+  static constexpr bool IsStoredInline = sizeof(T) <= InlineSize
+                                         and alignof(T) <= InlineAlignment;
 
 protected:
-  TupleTreeKeyWrapper(void *Pointer) : Pointer(Pointer) {}
+  /// Points either to Inline or to a heap allocation
+  void *Pointer;
+  alignas(InlineAlignment) std::byte Inline[InlineSize];
 
 public:
   TupleTreeKeyWrapper() : Pointer(nullptr) {}
@@ -66,6 +99,11 @@ public:
     return nullptr;
   }
 
+  virtual llvm::hash_code hash() const {
+    revng_assert(Pointer == nullptr);
+    return llvm::hash_code(0);
+  }
+
   virtual void clone(TupleTreeKeyWrapper *Target) const {
     revng_assert(Pointer == nullptr);
   }
@@ -92,7 +130,6 @@ public:
   }
 };
 
-// TODO: optimize integral types
 template<typename T, bool LastFieldIsKind = false>
 class ConcreteTupleTreeKeyWrapper : public TupleTreeKeyWrapper {
 private:
@@ -103,10 +140,18 @@ public:
 
 public:
   template<typename... Args>
-  ConcreteTupleTreeKeyWrapper(Args... A) : TupleTreeKeyWrapper(new T(A...)) {}
+  ConcreteTupleTreeKeyWrapper(Args... A) : TupleTreeKeyWrapper() {
+    if constexpr (IsStoredInline<T>)
+      Pointer = new (Inline) T(A...);
+    else
+      Pointer = new T(A...);
+  }
 
   ~ConcreteTupleTreeKeyWrapper() override {
-    delete reinterpret_cast<T *>(Pointer);
+    if constexpr (IsStoredInline<T>)
+      get()->~T();
+    else
+      delete get();
   }
 
   bool operator==(const TupleTreeKeyWrapper &Other) const override {
@@ -153,6 +198,10 @@ public:
 
   char *id() const override { return typeID<T>(); }
 
+  llvm::hash_code hash() const override {
+    return llvm::hash_combine(id(), hashTupleTreeKey(*get()));
+  }
+
   void clone(TupleTreeKeyWrapper *Target) const override {
     Target->~TupleTreeKeyWrapper();
     new (Target) ConcreteTupleTreeKeyWrapper(*get());
@@ -161,7 +210,10 @@ public:
 
 class TupleTreePath {
 private:
-  std::vector<TupleTreeKeyWrapper> Storage;
+  /// Most of the paths are not deeper than this, e.g., the name of a field of a
+  /// struct, and are stored without allocating
+  static constexpr unsigned InlineDepth = 5;
+  llvm::SmallVector<TupleTreeKeyWrapper, InlineDepth> Storage;
 
 public:
   TupleTreePath() = default;
@@ -206,13 +258,23 @@ public:
   const TupleTreeKeyWrapper &operator[](size_t Index) const {
     return Storage[Index];
   }
-  bool operator==(const TupleTreePath &Other) const = default;
+  bool operator==(const TupleTreePath &Other) const {
+    return Storage == Other.Storage;
+  }
+
   std::strong_ordering operator<=>(const TupleTreePath &Other) const {
-    if (Storage < Other.Storage)
-      return std::strong_ordering::less;
-    if (Other.Storage < Storage)
-      return std::strong_ordering::greater;
-    return std::strong_ordering::equal;
+    size_t CommonSize = std::min(size(), Other.size());
+    for (size_t I = 0; I < CommonSize; ++I)
+      if (auto Result = Storage[I] <=> Other.Storage[I]; Result != 0)
+        return Result;
+    return size() <=> Other.size();
+  }
+
+  friend llvm::hash_code hash_value(const TupleTreePath &Path) {
+    llvm::hash_code Result = llvm::hash_value(Path.size());
+    for (const TupleTreeKeyWrapper &Key : Path.Storage)
+      Result = llvm::hash_combine(Result, Key.hash());
+    return Result;
   }
 
   // TODO: should return ArrayRef<const TupleTreeKeyWrapper>
@@ -234,3 +296,12 @@ public:
 
   bool empty() const { return Storage.empty(); }
 };
+
+namespace std {
+template<>
+struct hash<TupleTreePath> {
+  size_t operator()(const TupleTreePath &Path) const {
+    return hash_value(Path);
+  }
+};
+} // namespace std
@@ -4,14 +4,17 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <atomic>
 #include <compare>
 #include <optional>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 #include "llvm/ADT/StringRef.h"
 
 #include "revng/ADT/Concepts.h"
+#include "revng/ADT/StructuralMutationEpoch.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/YAMLTraits.h"
 #include "revng/TupleTree/TupleTreePath.h"
@@ -29,6 +32,15 @@ private:
   TupleTreePath Path;
   TargetVariant CachedTarget = static_cast<T *>(nullptr);
 
+  /// The result of the last successful lookup of Path, valid as long as
+  /// MemoizedEpoch matches the current StructuralMutationEpoch.
+  ///
+  /// These are atomic since const lookups, which can happen concurrently, set
+  /// them. MemoizedEpoch is published after Memoized, so that a reader
+  /// observing the current epoch also observes the pointer stored with it.
+  mutable std::atomic<const T *> Memoized = nullptr;
+  mutable std::atomic<uint64_t> MemoizedEpoch = 0;
+
 public:
   TupleTreeReference() = default;
   TupleTreeReference(ConstOrNot<RootT> auto *R, const TupleTreePath &P) :
@@ -36,10 +48,21 @@ public:
     Path{ P },
     CachedTarget{ static_cast<T *>(nullptr) } {}
 
-  TupleTreeReference(const TupleTreeReference &) = default;
-  TupleTreeReference &operator=(const TupleTreeReference &) = default;
-  TupleTreeReference(TupleTreeReference &) = default;
-  TupleTreeReference &operator=(TupleTreeReference &) = default;
+  // Copies start without a memoized lookup
+  TupleTreeReference(const TupleTreeReference &Other) :
+    Root(Other.Root), Path(Other.Path), CachedTarget(Other.CachedTarget) {}
+  TupleTreeReference &operator=(const TupleTreeReference &Other) {
+    Root = Other.Root;
+    Path = Other.Path;
+    CachedTarget = Other.CachedTarget;
+    forgetMemoized();
+    return *this;
+  }
+  TupleTreeReference(TupleTreeReference &Other) :
+    TupleTreeReference(std::as_const(Other)) {}
+  TupleTreeReference &operator=(TupleTreeReference &Other) {
+    return *this = std::as_const(Other);
+  }
 
 public:
   const RootT *getRoot() const {
@@ -48,7 +71,10 @@ public:
     return std::visit(GetPtrToConstRoot, Root);
   }
 
-  void setRoot(ConstOrNot<RootT> auto *NewRoot) { Root = NewRoot; }
+  void setRoot(ConstOrNot<RootT> auto *NewRoot) {
+    Root = NewRoot;
+    forgetMemoized();
+  }
 
 private:
   // Friend class that is allowed to manage the cached pointer to the target
@@ -90,6 +116,34 @@ private:
 
   void evictCachedTarget() { CachedTarget = static_cast<T *>(nullptr); }
 
+  void forgetMemoized() const {
+    MemoizedEpoch.store(0, std::memory_order_relaxed);
+    Memoized.store(nullptr, std::memory_order_relaxed);
+  }
+
+  const T *getMemoized() const {
+    uint64_t Epoch = MemoizedEpoch.load(std::memory_order_acquire);
+    if (Epoch != StructuralMutationEpoch::get())
+      return nullptr;
+    return Memoized.load(std::memory_order_relaxed);
+  }
+
+  /// Record \p Result as the target of this reference until the next
+  /// structural mutation. Failed lookups are not memoized: inserting the
+  /// missing element does not move any other, so it would not be noticed.
+  ///
+  /// \p Epoch has to be read *before* performing the lookup: if a mutation
+  /// happens concurrently, the memoized pointer is then tagged with a stale
+  /// epoch and discarded by the next getMemoized.
+  template<typename PointerType>
+  PointerType *memoize(uint64_t Epoch, PointerType *Result) const {
+    if (Result != nullptr) {
+      Memoized.store(Result, std::memory_order_relaxed);
+      MemoizedEpoch.store(Epoch, std::memory_order_release);
+    }
+    return Result;
+  }
+
 public:
   static TupleTreeReference
   fromString(ConstOrNot<TupleTreeReference::RootT> auto *Root,
@@ -143,11 +197,15 @@ public:
     if (Path.size() == 0)
       return nullptr;
 
+    if (const T *Result = getMemoized())
+      return Result;
+
     const auto GetByPathVisitor = [&Path = Path](const auto &RootPointer) {
       return getByPath<T>(Path, *RootPointer);
     };
 
-    return std::visit(GetByPathVisitor, Root);
+    uint64_t Epoch = StructuralMutationEpoch::get();
+    return memoize(Epoch, std::visit(GetByPathVisitor, Root));
   }
 
   T *get() {
@@ -160,7 +218,11 @@ public:
       return nullptr;
 
     if (std::holds_alternative<RootT *>(Root)) {
-      return getByPath<T>(Path, *std::get<RootT *>(Root));
+      // The memoized pointer has been obtained from a non-const root
+      if (const T *Result = getMemoized())
+        return const_cast<T *>(Result);
+      uint64_t Epoch = StructuralMutationEpoch::get();
+      return memoize(Epoch, getByPath<T>(Path, *std::get<RootT *>(Root)));
     } else if (std::holds_alternative<const RootT *>(Root)) {
       revng_abort("Called get() with const root, use getConst!");
     } else {
@@ -177,10 +239,15 @@ public:
     if (Path.size() == 0)
       return nullptr;
 
+    if (const T *Result = getMemoized())
+      return Result;
+
+    uint64_t Epoch = StructuralMutationEpoch::get();
     if (std::holds_alternative<const RootT *>(Root)) {
-      return getByPath<T>(Path, *std::get<const RootT *>(Root));
+      const RootT &ConstRoot = *std::get<const RootT *>(Root);
+      return memoize(Epoch, getByPath<T>(Path, ConstRoot));
     } else if (std::holds_alternative<RootT *>(Root)) {
-      return getByPath<T>(Path, *std::get<RootT *>(Root));
+      return memoize(Epoch, getByPath<T>(Path, *std::get<RootT *>(Root)));
     } else {
       revng_abort("Invalid root variant!");
     }
@@ -0,0 +1,18 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <chrono>
+
+/// Runs \p Callable once and \return the time it took, in \p Duration units.
+/// Used by the benchmark executables in tests/unit, which are built but not
+/// registered with ctest: timings are meaningless on shared CI machines.
+template<typename Duration = std::chrono::microseconds, typename CallableType>
+Duration measure(CallableType &&Callable) {
+  auto Start = std::chrono::steady_clock::now();
+  Callable();
+  auto End = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<Duration>(End - Start);
+}
@@ -7,6 +7,7 @@
 #include <map>
 
 #include "revng/ADT/ConstantRangeSet.h"
+#include "revng/ADT/PersistentMap.h"
 #include "revng/MFP/Graph.h"
 #include "revng/MFP/MFP.h"
 #include "revng/ValueMaterializer/ControlFlowEdgesGraph.h"
@@ -21,7 +22,7 @@ class DataFlowGraph;
 
 class AdvancedValueInfoMFI {
 public:
-  using LatticeElement = std::map<llvm::Instruction *, ConstantRangeSet>;
+  using LatticeElement = PersistentMap<llvm::Instruction *, ConstantRangeSet>;
   using GraphType = const ControlFlowEdgesGraph *;
   using Label = const ControlFlowEdgesGraph::Node *;
   using ResultsMap = std::map<Label, MFP::MFPResult<LatticeElement>>;
@@ -65,8 +66,7 @@ static_assert(MFP::MonotoneFrameworkInstance<AdvancedValueInfoMFI>);
 /// \p Context the position in the function for the current query.
 std::tuple<std::map<llvm::Instruction *, ConstantRangeSet>,
            ControlFlowEdgesGraph,
-           map<const ForwardNode<ControlFlowEdgesNode> *,
-               MFP::MFPResult<map<llvm::Instruction *, ConstantRangeSet>>>>
+           AdvancedValueInfoMFI::ResultsMap>
 runAVI(const DataFlowGraph &DFG,
        llvm::Instruction *Context,
        const llvm::DominatorTree &DT,
@@ -76,4 +76,4 @@ runAVI(const DataFlowGraph &DFG,
 template<>
 void MFP::dump(llvm::raw_ostream &Stream,
                unsigned Indent,
-               const std::map<llvm::Instruction *, ConstantRangeSet> &Element);
+               const AdvancedValueInfoMFI::LatticeElement &Element);
@@ -76,6 +76,7 @@ public:
 class DataFlowGraph : public GenericGraph<BidirectionalNode<DataFlowNode>> {
 public:
   using Node = BidirectionalNode<DataFlowNode>;
+  using GenericGraph::GenericGraph;
 
   class Limits {
   public:
@@ -116,7 +117,7 @@ private:
 
 public:
   static DataFlowGraph fromValue(llvm::Value *Root, Limits Limits) {
-    DataFlowGraph Result;
+    DataFlowGraph Result(NodeAllocation::Arena);
     Result.setEntryNode(Result.processValue(Root, Limits));
     return Result;
   }
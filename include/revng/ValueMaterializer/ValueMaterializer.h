@@ -54,9 +54,7 @@ private:
   //
   DataFlowGraph DataFlowGraph;
   ConstraintsMap OracleConstraints;
-  map<const ForwardNode<ControlFlowEdgesNode> *,
-      MFP::MFPResult<map<llvm::Instruction *, ConstantRangeSet>>>
-    MFIResults;
+  AdvancedValueInfoMFI::ResultsMap MFIResults;
   std::optional<MaterializedValues> Values;
   ControlFlowEdgesGraph CFEG;
 
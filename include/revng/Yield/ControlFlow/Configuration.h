@@ -98,6 +98,14 @@ public:
   /// information see layouter documentation).
   float VirtualNodeWeight;
 
+  /// Specifies the node count starting from which graphs are laid out using
+  /// the time-budgeted median sweep instead of hill climbing (for more
+  /// information see layouter documentation).
+  size_t MedianSweepNodeThreshold;
+
+  /// Specifies the wall-clock budget of the median sweep, in milliseconds.
+  size_t MedianSweepBudget;
+
 public:
   constexpr static Configuration getDefault() {
     return Configuration{ .EdgeMarginSize = 20.f,
@@ -121,7 +129,10 @@ public:
                           .AddExitNode = false,
 
                           .PreserveLinearSegments = true,
-                          .VirtualNodeWeight = 0.1f };
+                          .VirtualNodeWeight = 0.1f,
+
+                          .MedianSweepNodeThreshold = 256,
+                          .MedianSweepBudget = 1000 };
   }
 };
 
@@ -0,0 +1,43 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+namespace revng::pipes {
+
+/// \return the number of threads the yield pipes use to process functions.
+unsigned yieldThreadCount();
+
+/// Invoke \p Body on each index in [0, Count) from a pool of threads. Each
+/// thread owns an instance of \p State, shared by all of its invocations.
+template<typename State, typename CallableType>
+void parallelForEach(size_t Count, CallableType &&Body) {
+  unsigned ThreadsCount = std::min<size_t>(yieldThreadCount(), Count);
+
+  std::atomic<size_t> Next = 0;
+  auto Worker = [&]() {
+    State ThreadState;
+    for (size_t Index = Next++; Index < Count; Index = Next++)
+      Body(ThreadState, Index);
+  };
+
+  if (ThreadsCount <= 1) {
+    Worker();
+    return;
+  }
+
+  llvm::ThreadPool Pool(llvm::hardware_concurrency(ThreadsCount));
+  for (unsigned I = 0; I < ThreadsCount; ++I)
+    Pool.async(Worker);
+  Pool.wait();
+}
+
+} // namespace revng::pipes
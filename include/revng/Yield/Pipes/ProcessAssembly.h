@@ -5,19 +5,43 @@
 //
 
 #include <array>
+#include <memory>
 #include <string>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/Pipeline/Contract.h"
 #include "revng/Pipeline/Target.h"
 #include "revng/Pipes/FileContainer.h"
 #include "revng/Pipes/StringMap.h"
+#include "revng/Support/MetaAddress.h"
+#include "revng/Yield/Function.h"
 #include "revng/Yield/Pipes/YieldControlFlow.h"
 
 namespace revng::pipes {
 
+/// In-process cache of the yield::Function objects produced by
+/// ProcessAssembly.
+///
+/// Pipes consuming a FunctionAssemblyStringMap use it to avoid parsing the YAML
+/// back when the producer ran in the same process. Entries are keyed by a
+/// digest of the serialized function, so a stale entry is never returned.
+/// Only the functions produced by the latest run of ProcessAssembly are kept.
+class DisassembledFunctionCache {
+public:
+  /// Drop all the entries
+  static void reset();
+
+  static void insert(yield::Function &&Function, llvm::StringRef Serialized);
+
+  /// \return the function serialized in \p Serialized, from the cache if
+  ///         possible, otherwise deserializing it
+  static std::shared_ptr<const yield::Function>
+  get(const MetaAddress &Entry, llvm::StringRef Serialized);
+};
+
 class ProcessAssembly {
 public:
   static constexpr const auto Name = "process-assembly";
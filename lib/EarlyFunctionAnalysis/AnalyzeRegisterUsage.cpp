@@ -262,16 +262,18 @@ RUAResults analyzeRegisterUsage(Function *F,
     // Run the liveness analysis
     revng_log(Log, "Running Liveness");
     rua::Liveness Liveness(Function.Function);
-    auto AnalysisResult = MFP::getMaximalFixedPoint(Liveness,
-                                                    &Function.Function,
-                                                    Liveness.defaultValue(),
-                                                    Liveness.defaultValue(),
-                                                    { Function.ReturnNode });
+    auto DefaultValue = Liveness.defaultValue();
+    auto *ReturnNode = Function.ReturnNode;
+    auto AnalysisResult = MFP::getDenseMaximalFixedPoint(Liveness,
+                                                         &Function.Function,
+                                                         DefaultValue,
+                                                         DefaultValue,
+                                                         { ReturnNode });
 
     // Collect registers alive at the entry
     revng_log(Log, "Registers alive at the entry of the function:");
     rua::BlockNode *EntryNode = Function.Function.getEntryNode();
-    const BitVector &EntryResult = AnalysisResult[EntryNode].OutValue;
+    const BitVector &EntryResult = AnalysisResult.at(EntryNode).OutValue;
     for (auto Register : Function.Function.registersInSet(EntryResult)) {
       // This register is alive at the entry of the function
 
@@ -304,11 +306,11 @@ RUAResults analyzeRegisterUsage(Function *F,
     rua::ReachingDefinitions ReachingDefinitions(Function.Function);
     auto DefaultValue = ReachingDefinitions.defaultValue();
     auto *EntryNode = Function.Function.getEntryNode();
-    auto AnalysisResult = MFP::getMaximalFixedPoint(ReachingDefinitions,
-                                                    &Function.Function,
-                                                    DefaultValue,
-                                                    DefaultValue,
-                                                    { EntryNode });
+    auto AnalysisResult = MFP::getDenseMaximalFixedPoint(ReachingDefinitions,
+                                                         &Function.Function,
+                                                         DefaultValue,
+                                                         DefaultValue,
+                                                         { EntryNode });
 
     auto Compute = [&AnalysisResult, &Function](rua::Function::Node *Node,
                                                 bool Before) {
@@ -10,6 +10,7 @@
 
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/SmallSet.h"
@@ -148,7 +149,7 @@ private:
   FunctionSummaryOracle &Oracle;
   CFGAnalyzer &Analyzer;
 
-  CallGraph ApproximateCallGraph;
+  CallGraph ApproximateCallGraph{ NodeAllocation::Arena };
   BasicBlockToNodeMap BasicBlockNodeMap;
 
 public:
@@ -449,25 +450,42 @@ void DetectABI::analyzeABI() {
   LoggerIndent<> Indent(Log);
 
   llvm::Task Task(2, "analyzeABI");
-  std::map<MetaAddress, std::unique_ptr<OutlinedFunction>> Functions;
 
-  // Create all temporary functions
-  Task.advance("Create temporary functions");
-  for (model::Function &Function : Binary->Functions()) {
-    llvm::BasicBlock *Entry = GCBI.getBlockAt(Function.Entry());
-    auto NewFunction = make_unique<OutlinedFunction>(Analyzer.outline(Entry));
-    Functions[Function.Entry()] = std::move(NewFunction);
+  // Rank each function by the position of its SCC in a bottom-up visit of the
+  // approximate call graph: callees come before their callers, and all the
+  // members of a recursive SCC share the same rank.
+  Task.advance("Rank functions bottom-up");
+  std::map<MetaAddress, unsigned> Ranks;
+  unsigned SCCCount = 0;
+  for (auto It = scc_begin(&ApproximateCallGraph),
+            End = scc_end(&ApproximateCallGraph);
+       It != End;
+       ++It) {
+    for (BasicBlockNode *Node : *It)
+      if (Node->Address.isValid())
+        Ranks[Node->Address] = SCCCount;
+    ++SCCCount;
   }
 
+  // Functions that are not part of the call graph form an SCC on their own
+  for (model::Function &Function : Binary->Functions())
+    if (Ranks.try_emplace(Function.Entry(), SCCCount).second)
+      ++SCCCount;
+
   // Push this into analyzeFunction
   OpaqueRegisterUser RegisterUser(&M);
 
-  // TODO: this really needs to become a monotone framework
+  // Always pick the pending function with the lowest rank: this way each SCC
+  // is brought to a local fixed point before any of its callers is analyzed,
+  // and a caller is only revisited if one of its callees actually changed.
   Task.advance("Run fixed-point analyses");
   llvm::Task FixedPointTask({}, "Fixed-point analysis");
-  UniquedQueue<model::Function *> ToAnalyze;
+  std::set<std::pair<unsigned, MetaAddress>> ToAnalyze;
+  auto Enqueue = [&](const MetaAddress &Entry) {
+    ToAnalyze.emplace(Ranks.at(Entry), Entry);
+  };
   for (model::Function &Function : Binary->Functions())
-    ToAnalyze.insert(&Function);
+    Enqueue(Function.Entry());
 
   // Change the oracle default prototype to have no arguments nor return values
   {
@@ -477,26 +495,53 @@ void DetectABI::analyzeABI() {
     Oracle.setDefault(std::move(NewDefault));
   }
 
-  unsigned Runs = 0;
+  // Outlined functions are created the first time they are needed, grouped by
+  // rank. When the function with the lowest pending rank is picked, all the
+  // lower ranks have converged and their outlined functions are released. If
+  // a caller later reports new information about one of them, it is outlined
+  // again. Higher ranks are kept even when the worklist steps back to
+  // re-analyze a callee, since their functions are pending or likely to be
+  // re-enqueued by the callee itself.
+  //
+  // Outlining only depends on the attributes, the clobbered registers and the
+  // final stack offset of the callees, none of which is changed by the ABI
+  // analysis or by the new default prototype: outlining a function lazily
+  // produces the same IR that outlining it up front used to produce.
+  std::map<unsigned, std::map<MetaAddress, std::unique_ptr<OutlinedFunction>>>
+    Functions;
+
   while (not ToAnalyze.empty()) {
-    model::Function &Function = *ToAnalyze.pop();
-    revng_log(Log, "Analyzing " << Function.Entry().toString());
+    auto [Rank, Entry] = *ToAnalyze.begin();
+    ToAnalyze.erase(ToAnalyze.begin());
+
+    auto Converged = Functions.lower_bound(Rank);
+    if (Converged != Functions.begin()) {
+      revng_log(Log, "Releasing the outlined functions of SCCs below " << Rank);
+      Functions.erase(Functions.begin(), Converged);
+    }
+
+    model::Function &Function = Binary->Functions().at(Entry);
+    revng_log(Log, "Analyzing " << Entry.toString());
     FixedPointTask.advance(Function.name());
-    OutlinedFunction &OutlinedFunction = *Functions.at(Function.Entry());
-    Changes Changes = analyzeFunctionABI(Function,
-                                         OutlinedFunction,
-                                         RegisterUser);
+
+    std::unique_ptr<OutlinedFunction> &Outlined = Functions[Rank][Entry];
+    if (not Outlined) {
+      llvm::BasicBlock *EntryBlock = GCBI.getBlockAt(Entry);
+      Outlined = make_unique<OutlinedFunction>(Analyzer.outline(EntryBlock));
+    }
+
+    Changes Changes = analyzeFunctionABI(Function, *Outlined, RegisterUser);
 
     if (Changes.Function) {
       revng_log(Log, "The function has changed, re-enqueing all callers:");
       LoggerIndent<> Indent(Log);
       // The prototype of the function we analyzed has changed, reanalyze
       // callers
-      auto &FunctionNode = BasicBlockNodeMap[GCBI.getBlockAt(Function.Entry())];
+      auto &FunctionNode = BasicBlockNodeMap[GCBI.getBlockAt(Entry)];
       for (auto &CallerNode : FunctionNode->predecessors()) {
         if (CallerNode->Address.isValid()) {
           revng_log(Log, CallerNode->Address.toString());
-          ToAnalyze.insert(&Binary->Functions().at(CallerNode->Address));
+          Enqueue(CallerNode->Address);
         }
       }
     }
@@ -506,7 +551,7 @@ void DetectABI::analyzeABI() {
     for (const MetaAddress &ToReanalyze : Changes.Callees) {
       revng_assert(ToReanalyze.isValid());
       revng_log(Log, "Re-enqueing callee " << ToReanalyze.toString());
-      ToAnalyze.insert(&Binary->Functions().at(ToReanalyze));
+      Enqueue(ToReanalyze);
     }
   }
 }
@@ -98,7 +98,7 @@ void EmitCFG::run(pipeline::ExecutionContext &Context,
   auto *RootFunction = Module->getFunction("root");
   revng_assert(RootFunction != nullptr);
 
-  FunctionMetadataCache Cache;
+  FunctionMetadataCache &Cache = getFunctionMetadataCache(ModuleContainer);
   if (not RootFunction->isDeclaration()) {
     for (BasicBlock &BB : *Module->getFunction("root")) {
       llvm::Instruction *Term = BB.getTerminator();
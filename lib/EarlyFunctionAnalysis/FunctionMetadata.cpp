@@ -15,6 +15,7 @@
 #include "revng/EarlyFunctionAnalysis/FunctionMetadata.h"
 #include "revng/Model/Binary.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/TupleTree/BinarySerialization.h"
 
 using namespace llvm;
 
@@ -129,7 +130,7 @@ void FunctionMetadata::serialize(GeneratedCodeBasicInfo &GCBI) const {
   std::string Buffer;
   {
     raw_string_ostream Stream(Buffer);
-    ::serialize(Stream, *this);
+    ::serializeBinary(Stream, *this);
   }
 
   Instruction *Term = BB->getTerminator();
@@ -2,7 +2,10 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include "llvm/IR/LegacyPassManager.h"
+
 #include "revng/EarlyFunctionAnalysis/FunctionMetadataCache.h"
+#include "revng/Pipeline/GenericLLVMPipe.h"
 
 char FunctionMetadataCachePass::ID = '_';
 
@@ -14,3 +17,12 @@ static llvm::RegisterPass<FunctionMetadataCachePass> _("metadata-cache",
                                                        "used by later passes",
                                                        true,
                                                        true);
+
+// Let the passes run by LLVM pipes share the cache of their container
+static void addCachePass(const pipeline::LLVMContainer &Container,
+                         llvm::legacy::PassManager &Manager) {
+  auto &Cache = getFunctionMetadataCache(Container);
+  Manager.add(new FunctionMetadataCachePass(Cache));
+}
+
+static pipeline::RegisterContainerPasses RegisterCachePass(addCachePass);
@@ -8,7 +8,10 @@
 
 #include "InternalCompute.h"
 
+Logger<> LayoutTimingLog("sugiyama-layout-timing");
+
 namespace sugiyama = yield::layout::sugiyama;
+
 bool sugiyama::detail::computeImpl(InternalGraph &Graph,
                                    const Configuration &Configuration) {
   using RS = sugiyama::RankingStrategy;
@@ -4,12 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <chrono>
 #include <compare>
 #include <map>
 #include <unordered_map>
 #include <vector>
 
 #include "revng/GraphLayout/SugiyamaStyle/Compute.h"
+#include "revng/Support/Debug.h"
 
 using RankingStrategy = yield::layout::sugiyama::RankingStrategy;
 using Configuration = yield::layout::sugiyama::Configuration;
@@ -21,10 +23,32 @@ using Index = size_t;
 using Rank = size_t;
 using RankDelta = std::ptrdiff_t;
 
+using PermutationStrategy = yield::layout::sugiyama::PermutationStrategy;
+
 using InternalGraph = yield::layout::sugiyama::InternalGraph;
 using InternalNode = InternalGraph::Node;
 using InternalEdge = InternalNode::Edge;
 
+/// Reports the time spent in each of the layouter phases.
+extern Logger<> LayoutTimingLog;
+
+/// Measures the wall-clock time elapsed between consecutive phases and reports
+/// it to `LayoutTimingLog`.
+class PhaseTimer {
+private:
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point Start = Clock::now();
+
+public:
+  void done(const char *Phase) {
+    using std::chrono::microseconds;
+    auto Now = Clock::now();
+    auto Elapsed = std::chrono::duration_cast<microseconds>(Now - Start);
+    revng_log(LayoutTimingLog, Phase << ": " << Elapsed.count() << " us");
+    Start = Now;
+  }
+};
+
 /// A wrapper around an `InternalNode` pointer used for comparison overloading.
 class NodeView {
 public:
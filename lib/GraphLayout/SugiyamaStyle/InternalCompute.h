@@ -16,7 +16,8 @@ prepareGraph(InternalGraph &Graph, bool OmitClassification);
 template<RankingStrategy Strategy>
 LayerContainer selectPermutation(InternalGraph &Graph,
                                  RankContainer &Ranks,
-                                 const MaybeClassifier<Strategy> &Classifier);
+                                 const MaybeClassifier<Strategy> &Classifier,
+                                 const Configuration &Configuration);
 
 /// A simplified permutation selection to only be used with simple tree.
 LayerContainer selectSimpleTreePermutation(InternalGraph &Graph,
@@ -109,6 +110,8 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
   if (Graph.size() == 0)
     return true;
 
+  PhaseTimer Timer;
+
   // Prepare the graph for the layouter: this converts `Graph` into
   // a DAG, guaranteeing that it's has no loops (some of the edges might have to
   // be temporarily inverted to ensure this), with every node having a rank
@@ -124,6 +127,7 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
   // For more details on this, see `routeBackwardsCorners` function.
   bool ShouldClassify = !Configuration.UseSimpleTreeOptimization;
   auto [Ranks, Classified] = prepareGraph<RS>(Graph, !ShouldClassify);
+  Timer.done("Graph preparation");
 
   // Try to select an optimal node permutation per layer.
   // NOTE: since this is the part with the highest complexity, it needs extra
@@ -132,10 +136,15 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
   // climbing algorithm.
   auto Layers = Configuration.UseSimpleTreeOptimization ?
                   selectSimpleTreePermutation(Graph, Ranks) :
-                  selectPermutation<RS>(Graph, Ranks, *Classified);
+                  selectPermutation<RS>(Graph,
+                                        Ranks,
+                                        *Classified,
+                                        Configuration);
+  Timer.done("Permutation selection");
 
   // Compute an augmented topological ordering of the nodes of the graph.
   auto Order = extractAugmentedTopologicalOrder(Graph, Layers);
+  Timer.done("Topological ordering");
 
   // Decide on which segments of the graph can be made linear, e.g. each edge
   // within the same linear segment is a straight line.
@@ -144,6 +153,7 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
     LinearSegments = selectLinearSegments(Graph, Ranks, Layers, Order);
   else
     LinearSegments = emptyLinearSegments(Graph);
+  Timer.done("Linear segment selection");
 
   // Finalize the logical positions for each of the nodes.
   const auto Final = convertToLayout(Layers);
@@ -160,13 +170,16 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
     const auto &W = Configuration.VirtualNodeWeight;
     setHorizontalCoordinates(Layers, Order, LinearSegments, Final, Margin, W);
   }
+  Timer.done("Horizontal positioning");
 
   // Distribute edge lanes in a way that minimizes the number of crossings.
   auto Lanes = assignLanes(Graph, LinearSegments, Final);
+  Timer.done("Lane distribution");
 
   // Set the rest of the coordinates. Node layouting is complete after this.
   const auto &EdgeGap = Configuration.EdgeMarginSize;
   setVerticalCoordinates(Layers, Lanes, Margin, EdgeGap);
+  Timer.done("Vertical positioning");
 
   // Route edges forming backwards facing corners.
   CornerContainer Prerouted;
@@ -187,6 +200,7 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
     route(Edges, Margin, EdgeGap);
   else
     routeWithStraightLines(Edges);
+  Timer.done("Edge routing");
 
   return true;
 }
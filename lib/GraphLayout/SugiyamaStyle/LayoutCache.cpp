@@ -0,0 +1,91 @@
+/// \file LayoutCache.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <cstring>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/xxhash.h"
+
+#include "revng/GraphLayout/SugiyamaStyle/LayoutCache.h"
+
+namespace sugiyama = yield::layout::sugiyama;
+
+void sugiyama::GraphShape::append(float Value) {
+  static_assert(sizeof(Value) == sizeof(uint32_t));
+  uint32_t Bits = 0;
+  std::memcpy(&Bits, &Value, sizeof(Bits));
+  append(uint64_t(Bits));
+}
+
+void sugiyama::GraphShape::append(const Configuration &Configuration) {
+  append(uint64_t(Configuration.Ranking));
+  append(uint64_t(Configuration.Orientation));
+  append(uint64_t(Configuration.UseOrthogonalBends));
+  append(uint64_t(Configuration.PreserveLinearSegments));
+  append(uint64_t(Configuration.UseSimpleTreeOptimization));
+  append(Configuration.VirtualNodeWeight);
+  append(Configuration.NodeMarginSize);
+  append(Configuration.EdgeMarginSize);
+  append(uint64_t(Configuration.Permutation));
+  append(uint64_t(Configuration.PermutationBudget.count()));
+
+  // `PermutationThreadCount` does not affect the layout.
+}
+
+uint64_t sugiyama::GraphShape::computeHash() const {
+  llvm::StringRef Bytes(reinterpret_cast<const char *>(Words.data()),
+                        Words.size() * sizeof(uint64_t));
+  return llvm::xxHash64(Bytes);
+}
+
+std::shared_ptr<const sugiyama::CachedLayout>
+sugiyama::LayoutCache::find(const GraphShape &Shape) {
+  std::lock_guard Lock(Mutex);
+
+  auto [Begin, End] = Index.equal_range(Shape.hash());
+  for (auto Iterator = Begin; Iterator != End; ++Iterator) {
+    if (Iterator->second->Shape == Shape) {
+      ++Hits;
+      return Iterator->second->Layout;
+    }
+  }
+
+  ++Misses;
+  return nullptr;
+}
+
+void sugiyama::LayoutCache::insert(GraphShape &&Shape, CachedLayout &&Layout) {
+  std::lock_guard Lock(Mutex);
+
+  // Another thread might have laid out the same shape in the meantime.
+  auto [Begin, End] = Index.equal_range(Shape.hash());
+  for (auto Iterator = Begin; Iterator != End; ++Iterator)
+    if (Iterator->second->Shape == Shape)
+      return;
+
+  uint64_t Hash = Shape.hash();
+  auto Shared = std::make_shared<const CachedLayout>(std::move(Layout));
+  Entries.push_back(Entry{ std::move(Shape), std::move(Shared) });
+  Index.emplace(Hash, std::prev(Entries.end()));
+
+  while (Entries.size() > Capacity) {
+    auto Oldest = Entries.begin();
+    auto [First, Last] = Index.equal_range(Oldest->Shape.hash());
+    for (auto Iterator = First; Iterator != Last; ++Iterator) {
+      if (Iterator->second == Oldest) {
+        Index.erase(Iterator);
+        break;
+      }
+    }
+    Entries.erase(Oldest);
+  }
+}
+
+void sugiyama::LayoutCache::clear() {
+  std::lock_guard Lock(Mutex);
+  Entries.clear();
+  Index.clear();
+}
@@ -4,9 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <atomic>
+#include <future>
 #include <map>
+#include <optional>
+#include <tuple>
 
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "InternalCompute.h"
 
@@ -400,20 +405,382 @@ LayerContainer sortNodes(const RankContainer &Ranks,
   return std::move(Layers);
 }
 
+namespace sugiyama = yield::layout::sugiyama;
+
+uint64_t sugiyama::detail::countBilayerCrossings(llvm::ArrayRef<size_t> Ends,
+                                                 size_t LowerLayerSize) {
+  if (Ends.size() < 2)
+    return 0;
+
+  // Each crossing is an inversion in `Ends`: count them by inserting the ends
+  // one by one in a tree accumulating the number of ends inserted so far
+  // within each range of positions.
+  size_t FirstLeaf = 1;
+  while (FirstLeaf < LowerLayerSize)
+    FirstLeaf *= 2;
+  std::vector<uint64_t> Tree(2 * FirstLeaf - 1, 0);
+  FirstLeaf -= 1;
+
+  uint64_t Result = 0;
+  for (size_t End : Ends) {
+    revng_assert(End < LowerLayerSize);
+    size_t Index = End + FirstLeaf;
+    ++Tree[Index];
+    while (Index > 0) {
+      // Left children count the ends inserted in their right sibling.
+      if (Index % 2 == 1)
+        Result += Tree[Index + 1];
+      Index = (Index - 1) / 2;
+      ++Tree[Index];
+    }
+  }
+
+  return Result;
+}
+
+/// \returns the pool shared by all the layouts of the process.
+///
+/// Layouts are often computed from many threads at once (e.g., by the yield
+/// pipes), a pool per layout would spawn a thread per core for each of them.
+static llvm::ThreadPool &sharedPool() {
+  static llvm::ThreadPool Pool(llvm::hardware_concurrency());
+  return Pool;
+}
+
+/// Invokes \p Body on each index in [0, Count), using up to \p ThreadCount
+/// threads: the calling one and those of the shared pool.
+template<typename CallableType>
+static void
+forEachIndex(unsigned ThreadCount, size_t Count, CallableType &&Body) {
+  std::atomic<size_t> Next = 0;
+  auto Worker = [&]() {
+    for (size_t Index = Next++; Index < Count; Index = Next++)
+      Body(Index);
+  };
+
+  // Only wait for the tasks submitted here, other layouts might be using the
+  // pool at the same time. If the pool is busy, the calling thread just ends
+  // up doing all the work itself.
+  size_t WorkerCount = std::min<size_t>(ThreadCount, Count);
+  std::vector<std::shared_future<void>> Helpers;
+  for (size_t I = 1; I < WorkerCount; ++I)
+    Helpers.push_back(sharedPool().async(Worker));
+
+  Worker();
+  for (std::shared_future<void> &Helper : Helpers)
+    Helper.wait();
+}
+
+/// Minimizes crossing count by repeatedly sorting each layer on the median
+/// position of the neighbors its nodes have in the adjacent layers, as
+/// described in "A technique for drawing directed graphs" by E. R. Gansner
+/// et al. (1993). Barycenters are used to break ties.
+///
+/// Layers of the same parity never share an edge, so each sweep sorts all
+/// the even layers and then all the odd ones, processing the layers within
+/// each half in parallel. Since sorting a layer only looks at the layers next
+/// to it, which do not change in the meantime, the result does not depend on
+/// the number of threads.
+///
+/// Crossings are counted after each sweep using the accumulator tree from
+/// "Simple and Efficient Bilayer Cross Counting" by W. Barth et al. (2004),
+/// in O(|E| log |V|), and the permutation with the fewest crossings is kept.
+template<typename ClusterType>
+class MedianSweep {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// The sweeping stops after this many sweeps in a row without a decrease
+  /// in the crossing count.
+  static constexpr size_t MaximumStalledSweepCount = 4;
+
+  /// A hard limit on the number of sweeps, regardless of the time budget.
+  static constexpr size_t MaximumSweepCount = 64;
+
+private:
+  const ClusterType &Cluster;
+  LayerContainer &Layers;
+  unsigned ThreadCount;
+
+  // All of the following are indexed by `InternalNode::index()`.
+
+  /// The neighbors of each node in the layer above it.
+  std::vector<std::vector<size_t>> Above;
+
+  /// The neighbors of each node in the layer below it.
+  std::vector<std::vector<size_t>> Below;
+
+  /// The index of each node within its layer.
+  std::vector<Rank> Slot;
+
+  /// The position of each node relative to the width of its layer, so that
+  /// the positions of the nodes of differently sized layers are comparable.
+  std::vector<double> Position;
+
+public:
+  MedianSweep(const RankContainer &Ranks,
+              const ClusterType &Cluster,
+              LayerContainer &Layers,
+              unsigned ThreadCount) :
+    Cluster(Cluster), Layers(Layers), ThreadCount(ThreadCount) {
+    size_t IndexCount = 0;
+    for (auto &[Node, _] : Ranks)
+      IndexCount = std::max(IndexCount, Node->index() + 1);
+    Above.resize(IndexCount);
+    Below.resize(IndexCount);
+    Slot.resize(IndexCount);
+    Position.resize(IndexCount);
+
+    auto Record = [&](NodeView Node, Rank NodeRank, NodeView Neighbor) {
+      Rank NeighborRank = Ranks.at(Neighbor);
+      if (NeighborRank + 1 == NodeRank)
+        Above[Node->index()].push_back(Neighbor->index());
+      else if (NeighborRank == NodeRank + 1)
+        Below[Node->index()].push_back(Neighbor->index());
+    };
+    for (auto &[Node, NodeRank] : Ranks) {
+      for (auto *Successor : Node->successors())
+        Record(Node, NodeRank, Successor);
+      for (auto *Predecessor : Node->predecessors())
+        Record(Node, NodeRank, Predecessor);
+    }
+
+    for (size_t Index = 0; Index < Layers.size(); ++Index)
+      updatePositions(Index);
+  }
+
+public:
+  struct Statistics {
+    /// Whether the sweeping was stopped by the time budget, in which case the
+    /// result depends on the speed of the machine.
+    bool OutOfBudget = false;
+    size_t SweepCount = 0;
+    Rank InitialCrossingCount = 0;
+    Rank FinalCrossingCount = 0;
+  };
+
+  /// Sweeps until the crossing count stops decreasing or \p Deadline is
+  /// reached, leaving the best permutation found in the layers.
+  Statistics run(std::optional<Clock::time_point> Deadline) {
+    Statistics Result;
+    Result.InitialCrossingCount = countCrossings();
+
+    Rank BestCount = Result.InitialCrossingCount;
+    LayerContainer BestLayers = Layers;
+    size_t StalledSweepCount = 0;
+    while (BestCount != 0 && Result.SweepCount < MaximumSweepCount) {
+      if (Deadline.has_value() && Clock::now() >= *Deadline) {
+        Result.OutOfBudget = true;
+        break;
+      }
+
+      ++Result.SweepCount;
+      if (!sweep())
+        break;
+
+      Rank CurrentCount = countCrossings();
+      if (CurrentCount < BestCount) {
+        BestCount = CurrentCount;
+        BestLayers = Layers;
+        StalledSweepCount = 0;
+      } else if (++StalledSweepCount == MaximumStalledSweepCount) {
+        break;
+      }
+    }
+
+    Layers = std::move(BestLayers);
+    Result.FinalCrossingCount = BestCount;
+    return Result;
+  }
+
+private:
+  void updatePositions(size_t LayerIndex) {
+    const auto &Layer = Layers[LayerIndex];
+    for (size_t Index = 0; Index < Layer.size(); ++Index) {
+      Slot[Layer[Index]->index()] = Index;
+      Position[Layer[Index]->index()] = (Index + 0.5) / Layer.size();
+    }
+  }
+
+  /// Sorts every layer once.
+  ///
+  /// \returns false if none of the layers changed.
+  bool sweep() {
+    std::vector<char> Changed(Layers.size(), false);
+    for (size_t Parity = 0; Parity < 2; ++Parity) {
+      size_t Count = (Layers.size() + 1 - Parity) / 2;
+      forEachIndex(ThreadCount, Count, [&](size_t I) {
+        size_t LayerIndex = Parity + 2 * I;
+        Changed[LayerIndex] = sortLayer(LayerIndex);
+      });
+    }
+
+    return llvm::any_of(Changed, [](char Value) { return Value; });
+  }
+
+  /// \returns true if the order of the nodes changed.
+  bool sortLayer(size_t LayerIndex) {
+    struct Key {
+      size_t Cluster;
+      double Median;
+      double Barycenter;
+      NodeView Node;
+    };
+
+    auto &Layer = Layers[LayerIndex];
+    std::vector<Key> Keys;
+    Keys.reserve(Layer.size());
+    std::vector<double> Neighbors;
+    for (NodeView Node : Layer) {
+      Neighbors.clear();
+      for (size_t Neighbor : Above[Node->index()])
+        Neighbors.push_back(Position[Neighbor]);
+      for (size_t Neighbor : Below[Node->index()])
+        Neighbors.push_back(Position[Neighbor]);
+
+      // Nodes without neighbors stay where they are.
+      double Median = Position[Node->index()];
+      double Barycenter = Median;
+      if (!Neighbors.empty()) {
+        llvm::sort(Neighbors);
+        size_t Middle = Neighbors.size() / 2;
+        Median = Neighbors[Middle];
+        if (Neighbors.size() % 2 == 0)
+          Median = (Neighbors[Middle - 1] + Median) / 2;
+
+        Barycenter = 0;
+        for (double Neighbor : Neighbors)
+          Barycenter += Neighbor;
+        Barycenter /= Neighbors.size();
+      }
+
+      Keys.push_back({ Cluster(Node), Median, Barycenter, Node });
+    }
+
+    // Ties keep the current order.
+    std::stable_sort(Keys.begin(), Keys.end(), [](const Key &A, const Key &B) {
+      return std::tie(A.Cluster, A.Median, A.Barycenter)
+             < std::tie(B.Cluster, B.Median, B.Barycenter);
+    });
+
+    bool Changed = false;
+    for (size_t Index = 0; Index < Layer.size(); ++Index) {
+      if (&*Layer[Index] != &*Keys[Index].Node) {
+        Layer[Index] = Keys[Index].Node;
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      updatePositions(LayerIndex);
+    return Changed;
+  }
+
+  /// Counts the crossings between the edges connecting the layer at
+  /// \p LayerIndex to the one below it.
+  Rank countCrossings(size_t LayerIndex) const {
+    // List the positions of the lower ends of the edges, sorted by their upper
+    // end first, and by their lower end second.
+    std::vector<size_t> LowerEnds;
+    for (NodeView Node : Layers[LayerIndex]) {
+      size_t First = LowerEnds.size();
+      for (size_t Neighbor : Below[Node->index()])
+        LowerEnds.push_back(Slot[Neighbor]);
+      std::sort(LowerEnds.begin() + First, LowerEnds.end());
+    }
+
+    size_t LowerLayerSize = Layers[LayerIndex + 1].size();
+    return sugiyama::detail::countBilayerCrossings(LowerEnds, LowerLayerSize);
+  }
+
+  Rank countCrossings() const {
+    if (Layers.size() < 2)
+      return 0;
+
+    std::vector<Rank> Counts(Layers.size() - 1, 0);
+    forEachIndex(ThreadCount, Counts.size(), [&](size_t LayerIndex) {
+      Counts[LayerIndex] = countCrossings(LayerIndex);
+    });
+
+    Rank Result = 0;
+    for (Rank Count : Counts)
+      Result += Count;
+    return Result;
+  }
+};
+
+/// Minimizes crossing count using `MedianSweep`, within the time budget and
+/// with the threads allowed by \p Configuration.
+template<typename ClusterType>
+LayerContainer sweepLayers(const RankContainer &Ranks,
+                           const ClusterType &Cluster,
+                           const Configuration &Configuration,
+                           LayerContainer &&Layers) {
+  revng_assert(countNodes(Layers) == Ranks.size());
+
+  // Spawning threads is not worth it for small graphs.
+  constexpr size_t MinimumParallelNodeCount = 1024;
+
+  unsigned ThreadCount = Configuration.PermutationThreadCount;
+  if (ThreadCount == 0)
+    ThreadCount = llvm::hardware_concurrency().compute_thread_count();
+  if (Ranks.size() < MinimumParallelNodeCount)
+    ThreadCount = 1;
+
+  using Clock = std::chrono::steady_clock;
+  std::optional<Clock::time_point> Deadline;
+  if (Configuration.PermutationBudget.count() != 0)
+    Deadline = Clock::now() + Configuration.PermutationBudget;
+
+  MedianSweep<ClusterType> Sweeper(Ranks, Cluster, Layers, ThreadCount);
+  auto Statistics = Sweeper.run(Deadline);
+  revng_log(LayoutTimingLog,
+            "Median sweep: " << Statistics.SweepCount << " sweeps, "
+                             << Statistics.InitialCrossingCount << " -> "
+                             << Statistics.FinalCrossingCount << " crossings"
+                             << (Statistics.OutOfBudget ? ", out of budget" :
+                                                          ""));
+
+  return std::move(Layers);
+}
+
 template<RankingStrategy Strategy>
 LayerContainer selectPermutation(InternalGraph &Graph,
                                  RankContainer &Ranks,
-                                 const MaybeClassifier<Strategy> &Classifier) {
+                                 const MaybeClassifier<Strategy> &Classifier,
+                                 const Configuration &Configuration) {
   revng_assert(Classifier.has_value());
 
+  PhaseTimer Timer;
+
   // Build a layer container based on a given ranking, then remove layers
   // without any original nodes or nodes that are required for correct
   // backwards edge routing. Update ranks accordingly.
   auto InitialLayers = optimizeLayers(Graph, Ranks);
+  Timer.done("Layer optimization");
+
+  if (Configuration.Permutation == PermutationStrategy::MedianSweep) {
+    // A few barycentric passes are cheap and provide a good starting point:
+    // sweeping never makes the crossing count worse than it.
+    size_t Iterations = std::log2(InitialLayers.size());
+    auto SortedLayers = sortNodes(Ranks,
+                                  Iterations + 1,
+                                  *Classifier,
+                                  std::move(InitialLayers));
+    Timer.done("Barycentric sorting");
+
+    auto Result = sweepLayers(Ranks,
+                              *Classifier,
+                              Configuration,
+                              std::move(SortedLayers));
+    Timer.done("Median sweeping");
+    return Result;
+  }
 
   auto MinimalCrossingLayers = minimizeCrossingCount(Ranks,
                                                      *Classifier,
                                                      std::move(InitialLayers));
+  Timer.done("Hill climbing");
 
   // Iteration counts are chosen arbitrarily. If the computation time was not
   // an issue, we could keep iterating until convergence, but since it's not
@@ -432,6 +799,7 @@ LayerContainer selectPermutation(InternalGraph &Graph,
                                 Iterations * 3 + 10,
                                 *Classifier,
                                 std::move(MinimalCrossingLayers));
+  Timer.done("Barycentric sorting");
 
   return SortedLayers;
 }
@@ -444,22 +812,26 @@ constexpr auto DDFSRS = RankingStrategy::DisjointDepthFirstSearch;
 template LayerContainer
 selectPermutation<BFSRS>(InternalGraph &Graph,
                          RankContainer &Ranks,
-                         const MaybeClassifier<BFSRS> &Classifier);
+                         const MaybeClassifier<BFSRS> &Classifier,
+                         const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<DFSRS>(InternalGraph &Graph,
                          RankContainer &Ranks,
-                         const MaybeClassifier<DFSRS> &Classifier);
+                         const MaybeClassifier<DFSRS> &Classifier,
+                         const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<TRS>(InternalGraph &Graph,
                        RankContainer &Ranks,
-                       const MaybeClassifier<TRS> &Classifier);
+                       const MaybeClassifier<TRS> &Classifier,
+                       const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<DDFSRS>(InternalGraph &Graph,
                           RankContainer &Ranks,
-                          const MaybeClassifier<DDFSRS> &Classifier);
+                          const MaybeClassifier<DDFSRS> &Classifier,
+                          const Configuration &Configuration);
 
 static std::unordered_map<NodeView, size_t> rankSubtrees(InternalGraph &Graph) {
   std::unordered_map<NodeView, size_t> Result;
@@ -6,9 +6,16 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <set>
 #include <sstream>
@@ -17,6 +24,7 @@
 #include <vector>
 
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/CFG.h"
@@ -29,6 +37,8 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_os_ostream.h"
@@ -41,12 +51,14 @@
 #include "revng/ADT/STLExtras.h"
 #include "revng/FunctionCallIdentification/FunctionCallIdentification.h"
 #include "revng/FunctionCallIdentification/PruneRetSuccessors.h"
+#include "revng/Lift/LiftRegions.h"
 #include "revng/Model/Architecture.h"
 #include "revng/Model/Importer/DebugInfo/DwarfImporter.h"
 #include "revng/Model/RawBinaryView.h"
 #include "revng/Model/SerializeModelPass.h"
 #include "revng/Support/CommandLine.h"
 #include "revng/Support/Debug.h"
+#include "revng/Support/Fork.h"
 #include "revng/Support/FunctionTags.h"
 #include "revng/Support/ProgramCounterHandler.h"
 
@@ -67,8 +79,27 @@ static cl::opt<bool> RecordPTC("record-ptc",
                                cl::desc("create metadata for PTC"),
                                cl::cat(MainCategory));
 
+static cl::opt<std::string> LiftCheckpoint("lift-checkpoint",
+                                           cl::desc("file where to record the "
+                                                    "jump targets found so "
+                                                    "far, restoring them if it "
+                                                    "already exists"),
+                                           cl::value_desc("path"),
+                                           cl::cat(MainCategory));
+
+static cl::opt<unsigned> LiftRegions("lift-regions",
+                                     cl::desc("explore the entry points of "
+                                              "the model split in this many "
+                                              "regions, each in a separate "
+                                              "process, before lifting "
+                                              "(experimental)"),
+                                     cl::value_desc("count"),
+                                     cl::init(1),
+                                     cl::cat(MainCategory));
+
 static Logger<> PTCLog("ptc");
 static Logger<> Log("lift");
+static Logger<> RegionsLog("lift-regions");
 
 template<typename T, typename... ArgTypes>
 inline std::array<T, sizeof...(ArgTypes)> make_array(ArgTypes &&...Args) {
@@ -584,6 +615,92 @@ bool CpuLoopExitPass::runOnModule(llvm::Module &M) {
   return true;
 }
 
+namespace {
+
+/// The region of the entry points a worker process has to explore, and where
+/// to save the jump targets it finds
+struct RegionWorker {
+  std::vector<MetaAddress> EntryPoints;
+  std::string OutputPath;
+  JumpTargetCheckpoint Header;
+};
+
+} // namespace
+
+/// Splits the entry points of the model in `LiftRegions` regions, explores
+/// each of them in a separate process and registers the jump targets they
+/// found. Each process gets its own copy of PTC and of the module, so their
+/// exploration can proceed in parallel. The lifting that follows is still
+/// serial, but it starts from all the jump targets the workers found.
+///
+/// \return in the worker processes, the region they have to explore. In the
+///         parent, std::nullopt, once all the workers are done.
+static std::optional<RegionWorker>
+exploreRegions(JumpTargetManager &JumpTargets) {
+  JumpTargetCheckpoint Header = JumpTargets.describeRun();
+
+  std::set<MetaAddress> EntryPoints;
+  for (const MetaAddress &Address : make_first_range(Header.EntryPoints))
+    EntryPoints.insert(Address);
+
+  auto Regions = partitionIntoRegions(EntryPoints, LiftRegions);
+  if (Regions.size() < 2 or not isSingleThreaded()) {
+    revng_log(RegionsLog, "Not exploring the regions in separate processes");
+    return std::nullopt;
+  }
+
+  SmallString<128> Directory;
+  if (auto EC = sys::fs::createUniqueDirectory("revng-lift-regions",
+                                               Directory)) {
+    revng_log(RegionsLog, "Cannot create a directory: " << EC.message());
+    return std::nullopt;
+  }
+
+  auto GetOutputPath = [&Directory](size_t Index) {
+    SmallString<128> Result;
+    sys::path::append(Result, Directory, std::to_string(Index));
+    return Result.str().str();
+  };
+
+  // Don't let the workers print what the parent has buffered so far
+  outs().flush();
+  errs().flush();
+
+  std::map<pid_t, size_t> Workers;
+  for (size_t Index = 0; Index < Regions.size(); ++Index) {
+    pid_t Worker = fork();
+    if (Worker == 0)
+      return RegionWorker{ std::move(Regions[Index]),
+                           GetOutputPath(Index),
+                           std::move(Header) };
+
+    // Regions without a worker are simply explored by the serial lifting
+    if (Worker < 0)
+      revng_log(RegionsLog, "Cannot spawn the worker for region " << Index);
+    else
+      Workers[Worker] = Index;
+  }
+
+  for (auto [Worker, Index] : Workers) {
+    int Status = 0;
+    pid_t Completed = 0;
+    do {
+      Completed = waitpid(Worker, &Status, 0);
+    } while (Completed < 0 and errno == EINTR);
+
+    if (Completed != Worker or not WIFEXITED(Status)
+        or WEXITSTATUS(Status) != EXIT_SUCCESS) {
+      revng_log(RegionsLog, "The worker for region " << Index << " failed");
+      continue;
+    }
+
+    JumpTargets.restoreCheckpoint(GetOutputPath(Index), Header);
+  }
+
+  sys::fs::remove_directories(Directory);
+  return std::nullopt;
+}
+
 void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
   using FT = FunctionType;
 
@@ -824,13 +941,32 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
                                 RawBinary);
 
   MetaAddress VirtualAddress = MetaAddress::invalid();
+  std::optional<RegionWorker> Worker;
   if (RawVirtualAddress) {
     VirtualAddress = JumpTargets.fromPC(*RawVirtualAddress);
   } else {
-    JumpTargets.harvestGlobalData();
-    VirtualAddress = Model->EntryPoint();
+    if (LiftRegions > 1)
+      Worker = exploreRegions(JumpTargets);
+
+    if (Worker) {
+      // Workers only start from the entry points of their region
+      for (MetaAddress Address : Worker->EntryPoints) {
+        bool IsFunction = Model->Functions().count(Address) != 0;
+        JumpTargets.registerJT(Address,
+                               IsFunction ? JTReason::FunctionSymbol :
+                                            JTReason::GlobalData);
+      }
+    } else {
+      JumpTargets.harvestGlobalData();
+      VirtualAddress = Model->EntryPoint();
+    }
   }
 
+  // Seed the exploration with the jump targets found by a previous run, so
+  // that we don't have to rediscover them one harvesting round at a time
+  if (not LiftCheckpoint.empty() and not Worker)
+    JumpTargets.useCheckpoint(LiftCheckpoint);
+
   if (VirtualAddress.isValid()) {
     revng_assert(VirtualAddress.isCode());
     JumpTargets.registerJT(VirtualAddress, JTReason::GlobalData);
@@ -1098,6 +1234,16 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
 
   LiftTask.complete();
 
+  // Workers only report the jump targets they found to the parent process
+  if (Worker) {
+    JumpTargets.writeCheckpoint(Worker->OutputPath, Worker->Header);
+
+    // Do not run destructors and atexit handlers of the parent process
+    outs().flush();
+    errs().flush();
+    _exit(EXIT_SUCCESS);
+  }
+
   OI.drop();
 
   // Reorder basic blocks in RPOT
@@ -0,0 +1,151 @@
+/// \file JumpTargetCheckpoint.cpp
+/// Parsing and serialization of the jump targets saved by the lifter.
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <optional>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "revng/Lift/JumpTargetCheckpoint.h"
+
+using namespace llvm;
+
+static std::optional<JTReason::Values> parseReason(StringRef Name) {
+  uint32_t LastReason = static_cast<uint32_t>(JTReason::LastReason);
+  for (uint32_t Reason = 1; Reason <= LastReason; Reason <<= 1) {
+    auto Result = static_cast<JTReason::Values>(Reason);
+    if (Name == JTReason::getName(Result))
+      return Result;
+  }
+
+  return std::nullopt;
+}
+
+static Error makeError(const Twine &Message) {
+  return createStringError(inconvertibleErrorCode(), Message.str());
+}
+
+Expected<JumpTargetCheckpoint> JumpTargetCheckpoint::parse(StringRef Text) {
+  JumpTargetCheckpoint Result;
+  bool HasVersion = false;
+
+  auto Buffer = MemoryBuffer::getMemBuffer(Text, "", false);
+  for (line_iterator It(*Buffer, true, '#'); not It.is_at_eof(); ++It) {
+    SmallVector<StringRef, 4> Fields;
+    It->split(Fields, ' ', -1, false);
+    if (Fields.empty())
+      continue;
+
+    StringRef Keyword = Fields.front();
+
+    // The version has to come first: the rest of the format depends on it
+    if (not HasVersion and Keyword != "version")
+      return makeError("Missing version");
+
+    if (Keyword == "version") {
+      unsigned Version = 0;
+      if (HasVersion or Fields.size() != 3
+          or Fields[1].getAsInteger(10, Version))
+        return makeError("Malformed version");
+      if (Version != FormatVersion)
+        return makeError("Unsupported version " + Fields[1]);
+
+      HasVersion = true;
+      Result.ComponentsHash = Fields[2].str();
+    } else if (Keyword == "binary") {
+      if (Fields.size() != 2)
+        return makeError("Malformed binary hash");
+
+      Result.BinaryHash = Fields[1].str();
+    } else if (Keyword == "model") {
+      if (Fields.size() != 2)
+        return makeError("Malformed model hash");
+
+      Result.ModelHash = Fields[1].str();
+    } else if (Keyword == "entry" or Keyword == "jt") {
+      if (Fields.size() < 2)
+        return makeError("Missing address");
+
+      MetaAddress Address = MetaAddress::fromString(Fields[1]);
+      if (Address.isInvalid())
+        return makeError("Malformed address " + Fields[1]);
+
+      if (Keyword == "entry") {
+        if (Fields.size() > 3)
+          return makeError("Malformed entry point " + Fields[1]);
+        StringRef FunctionHash = Fields.size() == 3 ? Fields[2] : "";
+        Result.EntryPoints[Address] = FunctionHash.str();
+        continue;
+      }
+
+      uint32_t &Reasons = Result.JumpTargets[Address];
+      for (StringRef Name : drop_begin(Fields, 2)) {
+        std::optional<JTReason::Values> Reason = parseReason(Name);
+        if (not Reason)
+          return makeError("Unknown jump target reason " + Name);
+        Reasons |= static_cast<uint32_t>(*Reason);
+      }
+    } else {
+      return makeError("Unknown keyword " + Keyword);
+    }
+  }
+
+  if (not HasVersion)
+    return makeError("Missing version");
+
+  return Result;
+}
+
+void JumpTargetCheckpoint::dump(raw_ostream &Output) const {
+  Output << "# Jump targets found by the lifter\n";
+  Output << "version " << FormatVersion << " " << ComponentsHash << "\n";
+  Output << "binary " << BinaryHash << "\n";
+  Output << "model " << ModelHash << "\n";
+
+  for (const auto &[Address, FunctionHash] : EntryPoints) {
+    Output << "entry " << Address.toString();
+    if (not FunctionHash.empty())
+      Output << " " << FunctionHash;
+    Output << "\n";
+  }
+
+  uint32_t LastReason = static_cast<uint32_t>(JTReason::LastReason);
+  for (const auto &[Address, Reasons] : JumpTargets) {
+    Output << "jt " << Address.toString();
+    for (uint32_t Reason = 1; Reason <= LastReason; Reason <<= 1)
+      if ((Reasons & Reason) != 0)
+        Output << " " << JTReason::getName(JTReason::Values(Reason));
+    Output << "\n";
+  }
+}
+
+Error JumpTargetCheckpoint::checkCompatibility(const JumpTargetCheckpoint
+                                                 &Current) const {
+  if (ComponentsHash != Current.ComponentsHash)
+    return makeError("Produced by a different version of revng");
+
+  if (BinaryHash != Current.BinaryHash)
+    return makeError("Produced from a different binary");
+
+  if (ModelHash != Current.ModelHash)
+    return makeError("Produced from a different model");
+
+  // New entry points are fine, exploration will start from them too
+  for (const auto &[Address, FunctionHash] : EntryPoints) {
+    auto It = Current.EntryPoints.find(Address);
+    if (It == Current.EntryPoints.end())
+      return makeError("Entry point " + Address.toString()
+                       + " is no longer in the model");
+    if (It->second != FunctionHash)
+      return makeError("The function at " + Address.toString()
+                       + " has changed");
+  }
+
+  return Error::success();
+}
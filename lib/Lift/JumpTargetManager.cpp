@@ -7,11 +7,18 @@
 //
 
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Progress.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
 
+#include "revng/Support/ResourceFinder.h"
 #include "revng/Support/Statistics.h"
+#include "revng/Support/YAMLTraits.h"
 
 #include "JumpTargetManager.h"
 #include "RootAnalyzer.h"
@@ -23,8 +30,7 @@ namespace {
 
 Logger<> JTCountLog("jtcount");
 Logger<> RegisterJTLog("registerjt");
-
-CounterMap<std::string> HarvestingStats("harvesting");
+Logger<> CheckpointLog("lift-checkpoint");
 
 RegisterPass<TranslateDirectBranchesPass> X("translate-db",
                                             "Translate Direct Branches"
@@ -34,6 +40,8 @@ RegisterPass<TranslateDirectBranchesPass> X("translate-db",
 
 } // namespace
 
+CounterMap<std::string> HarvestingStats("harvesting");
+
 char TranslateDirectBranchesPass::ID = 0;
 
 void TranslateDirectBranchesPass::getAnalysisUsage(AnalysisUsage &AU) const {
@@ -537,6 +545,133 @@ void JumpTargetManager::findCodePointers(MetaAddress StartVirtualAddress,
   }
 }
 
+static std::string hashOf(StringRef Serialized) {
+  return toHex(SHA1::hash(arrayRefFromStringRef(Serialized)), true);
+}
+
+/// Hashes everything the lifter reads from \p Model, except for the entry
+/// points: the checkpoint is still valid if new ones are added.
+static std::string hashModel(const model::Binary &Model) {
+  SHA1 Hasher;
+  auto Add = [&Hasher](StringRef Data) {
+    Hasher.update(Data);
+    // Separator, so that adjacent strings cannot be confused
+    Hasher.update(StringRef("\0", 1));
+  };
+
+  Add(model::Architecture::getName(Model.Architecture()));
+  Add(model::ABI::getName(Model.DefaultABI()));
+  Add(Model.DefaultPrototype().toString());
+  Add(serializeToString(Model.Segments()));
+  Add(serializeToString(Model.ImportedDynamicFunctions()));
+  Add(serializeToString(Model.Types()));
+
+  return toHex(Hasher.final(), true);
+}
+
+JumpTargetCheckpoint JumpTargetManager::describeRun() const {
+  JumpTargetCheckpoint Result;
+  Result.ComponentsHash = revng::getComponentsHash();
+  Result.BinaryHash = toHex(SHA1::hash(BinaryView.data()), true);
+  Result.ModelHash = hashModel(*Model);
+
+  if (Model->EntryPoint().isValid())
+    Result.EntryPoints[Model->EntryPoint()];
+  for (MetaAddress Address : Model->ExtraCodeAddresses())
+    Result.EntryPoints[Address];
+
+  // Functions also carry the data the lifter reads about them (e.g., their
+  // prototype)
+  for (const model::Function &Function : Model->Functions())
+    Result.EntryPoints[Function.Entry()] = hashOf(serializeToString(Function));
+
+  return Result;
+}
+
+void JumpTargetManager::useCheckpoint(StringRef Path) {
+  revng_assert(CheckpointPath.empty());
+  CheckpointPath = Path.str();
+  CheckpointHeader = describeRun();
+
+  // A checkpoint we can't use is not an error: it's overwritten at the end of
+  // the first harvesting round
+  restoreCheckpoint(Path, CheckpointHeader);
+}
+
+void JumpTargetManager::restoreCheckpoint(StringRef Path,
+                                          const JumpTargetCheckpoint &Current) {
+  auto MaybeBuffer = MemoryBuffer::getFile(Path);
+  if (not MaybeBuffer) {
+    // No previous run, start from scratch
+    revng_log(JTCountLog, "No checkpoint in " << Path);
+    return;
+  }
+
+  auto Checkpoint = JumpTargetCheckpoint::parse((*MaybeBuffer)->getBuffer());
+  llvm::Error Problem = Checkpoint ?
+                          Checkpoint->checkCompatibility(Current) :
+                          Checkpoint.takeError();
+  if (Problem) {
+    revng_log(CheckpointLog,
+              "Ignoring the lift checkpoint " << Path << ": "
+                                              << toString(std::move(Problem)));
+    return;
+  }
+
+  unsigned Ignored = 0;
+  for (const auto &[PC, Reasons] : Checkpoint->JumpTargets) {
+    uint32_t LastReason = static_cast<uint32_t>(JTReason::LastReason);
+    for (uint32_t Reason = 1; Reason <= LastReason; Reason <<= 1) {
+      auto Value = static_cast<JTReason::Values>(Reason);
+
+      // finalizeJumpTargets recomputes this at the end of lifting
+      if (not JTReason::hasReason(Reasons, Value)
+          or Value == JTReason::UnusedGlobalData)
+        continue;
+
+      // The binary is the same, but play it safe
+      if (registerJT(PC, Value) == nullptr) {
+        ++Ignored;
+        break;
+      }
+    }
+  }
+
+  revng_log(JTCountLog,
+            "JumpTargets restored from "
+              << Path << ": " << std::dec
+              << (Checkpoint->JumpTargets.size() - Ignored)
+              << ", ignored: " << Ignored);
+}
+
+void JumpTargetManager::saveCheckpoint() const {
+  if (not CheckpointPath.empty())
+    writeCheckpoint(CheckpointPath, CheckpointHeader);
+}
+
+void JumpTargetManager::writeCheckpoint(StringRef Path,
+                                        const JumpTargetCheckpoint &Header)
+  const {
+  JumpTargetCheckpoint Checkpoint = Header;
+  for (const auto &[PC, JT] : JumpTargets)
+    Checkpoint.JumpTargets[PC] = JT.getReasons();
+
+  // Write a temporary file and then rename it, so that interrupting lifting
+  // never leaves a truncated checkpoint behind
+  std::string TemporaryPath = (Path + ".tmp").str();
+  {
+    std::error_code EC;
+    raw_fd_ostream Output(TemporaryPath, EC);
+    if (EC)
+      revng_abort(Twine("Error opening file ", TemporaryPath).str().c_str());
+
+    Checkpoint.dump(Output);
+  }
+
+  std::error_code EC = sys::fs::rename(TemporaryPath, Path);
+  revng_check(not EC, "Cannot update the lift checkpoint");
+}
+
 /// Handle a new program counter. We might already have a basic block for that
 /// program counter, or we could even have a translation for it. Return one of
 /// these, if appropriate.
@@ -783,6 +918,9 @@ void JumpTargetManager::translateIndirectJumps() {
 }
 
 JumpTargetManager::BlockWithAddress JumpTargetManager::peek() {
+  // harvest only does something if there's nothing left to translate
+  bool Harvesting = Unexplored.empty();
+
   // If we just harvested new branches, keep exploring
   do {
     harvest();
@@ -793,6 +931,9 @@ JumpTargetManager::BlockWithAddress JumpTargetManager::peek() {
     purgeTranslation(BB);
   ToPurge.clear();
 
+  if (Harvesting)
+    saveCheckpoint();
+
   if (Unexplored.empty()) {
     revng_log(JTCountLog, "We're done looking for jump targets");
     return NoMoreTargets;
@@ -1238,9 +1379,15 @@ void JumpTargetManager::harvest() {
 
     if (empty()) {
       T.advance("Advanced Value Info");
-      HarvestingStats.push("harvest 3: cloneOptimizeAndHarvest");
-      revng_log(JTCountLog, "Harvesting with Advanced Value Info");
-      RootAnalyzer(*this).cloneOptimizeAndHarvest(TheFunction);
+      if (hasCodeToHarvest()) {
+        HarvestingStats.push("harvest 3: cloneOptimizeAndHarvest");
+        revng_log(JTCountLog, "Harvesting with Advanced Value Info");
+        RootAnalyzer(*this).cloneOptimizeAndHarvest(TheFunction);
+      } else {
+        // Nothing changed since the previous run: it would find nothing new
+        HarvestingStats.push("harvest 3: skipped, no new code");
+        revng_log(JTCountLog, "No new code for Advanced Value Info");
+      }
     }
 
     // TODO: eventually, `setCFGForm` should be replaced by using a CustomCFG
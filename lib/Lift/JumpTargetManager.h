@@ -6,6 +6,8 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -20,6 +22,7 @@
 #include "llvm/IR/PassManager.h"
 
 #include "revng/BasicAnalyses/MaterializedValue.h"
+#include "revng/Lift/JumpTargetCheckpoint.h"
 #include "revng/Lift/Lift.h"
 #include "revng/Model/Architecture.h"
 #include "revng/Model/Binary.h"
@@ -27,6 +30,7 @@
 #include "revng/Support/IRHelpers.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/ProgramCounterHandler.h"
+#include "revng/Support/Statistics.h"
 
 // Forward declarations
 namespace llvm {
@@ -44,6 +48,10 @@ class JumpTargetManager;
 class ProgramCounterHandler;
 class SummaryCallsBuilder;
 
+/// How many times each stage of `JumpTargetManager::harvest` ran, or was
+/// skipped, and how much work it did
+extern CounterMap<std::string> HarvestingStats;
+
 template<typename Map>
 auto containing(Map const &M, typename Map::key_type const &K) {
   auto It = M.upper_bound(K);
@@ -236,6 +244,24 @@ public:
   /// Collect jump targets from the program's segments
   void harvestGlobalData();
 
+  /// Register the jump targets recorded in the checkpoint at \p Path by a
+  /// previous run, if any, and keep it up to date after each harvesting round
+  void useCheckpoint(llvm::StringRef Path);
+
+  /// \return a checkpoint without jump targets, identifying this run: the
+  ///         checkpoints of other runs can be used only if compatible with it
+  JumpTargetCheckpoint describeRun() const;
+
+  /// Register the jump targets recorded in the checkpoint at \p Path, if any
+  /// and if compatible with \p Current
+  void restoreCheckpoint(llvm::StringRef Path,
+                         const JumpTargetCheckpoint &Current);
+
+  /// Record all the known jump targets, and why, in a checkpoint at \p Path
+  /// starting with \p Header
+  void writeCheckpoint(llvm::StringRef Path,
+                       const JumpTargetCheckpoint &Header) const;
+
   auto createCSAA() { return CreateCSAA(); }
 
   /// Handle a new program counter. We might already have a basic block for that
@@ -442,6 +468,26 @@ public:
     ValueMaterializerPCWhiteList.clear();
   }
 
+  /// \return true if code has been translated, or new branches emitted, since
+  ///         the last time RootAnalyzer ran
+  ///
+  /// \note RootAnalyzer also depends on the model (e.g., on the registers
+  ///       preserved by the prototypes of the functions), but `Model` is
+  ///       constant for the whole lifetime of the JumpTargetManager.
+  bool hasCodeToHarvest() const {
+    return not ValueMaterializerPCWhiteList.empty();
+  }
+
+  /// Record that RootAnalyzer collected the values written in the PC by the
+  /// \p ExitIndex-th `exit_tb` of the instruction at \p PC
+  void recordHarvestedExit(MetaAddress PC, unsigned ExitIndex) {
+    HarvestedExits.emplace(PC, ExitIndex);
+  }
+
+  bool isHarvestedExit(MetaAddress PC, unsigned ExitIndex) const {
+    return HarvestedExits.contains({ PC, ExitIndex });
+  }
+
   /// Finalizes information about the jump targets
   ///
   /// Call this function once no more jump targets can be discovered.  It will
@@ -592,6 +638,9 @@ private:
 
   void harvest();
 
+  /// Record all the known jump targets, and why, in the checkpoint file
+  void saveCheckpoint() const;
+
   llvm::CallInst *getJumpTarget(llvm::BasicBlock *Target);
 
 private:
@@ -630,6 +679,18 @@ private:
   ProgramCounterHandler *PCH;
 
   MetaAddressSet ValueMaterializerPCWhiteList;
+
+  /// The `exit_tb` already analyzed by RootAnalyzer, identified by the address
+  /// of their instruction and by their index among the `exit_tb` of that
+  /// instruction, in program order
+  std::set<std::pair<MetaAddress, unsigned>> HarvestedExits;
+
+  /// Where to save the jump targets found so far, if not empty
+  std::string CheckpointPath;
+
+  /// The header of the checkpoint, computed once since it hashes the binary
+  JumpTargetCheckpoint CheckpointHeader;
+
   const TupleTree<model::Binary> &Model;
   const RawBinaryView &BinaryView;
 };
@@ -0,0 +1,23 @@
+/// \file LiftRegions.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <algorithm>
+
+#include "revng/Lift/LiftRegions.h"
+
+std::vector<std::vector<MetaAddress>>
+partitionIntoRegions(const std::set<MetaAddress> &Addresses, size_t Count) {
+  Count = std::min(Count, Addresses.size());
+
+  std::vector<std::vector<MetaAddress>> Result(Count);
+  size_t Index = 0;
+  for (const MetaAddress &Address : Addresses) {
+    Result[Index * Count / Addresses.size()].push_back(Address);
+    ++Index;
+  }
+
+  return Result;
+}
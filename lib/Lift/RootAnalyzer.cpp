@@ -271,13 +271,31 @@ RootAnalyzer::RootAnalyzer(JumpTargetManager &JTM) :
   JTM(JTM), TheModule(JTM.module()), Model(JTM.model()) {
 }
 
-RootAnalyzer::MetaAddressSet RootAnalyzer::inflateValueMaterializerWhitelist() {
+/// \return the basic blocks translated since the last run, i.e., those
+///         containing an instruction in ValueMaterializerPCWhiteList
+SmallVector<BasicBlock *, 16> RootAnalyzer::collectNewBlocks() {
+  SmallVector<BasicBlock *, 16> Result;
+
+  // TODO: OriginalInstructionAddresses is not reliable, we should drop it
+  for (User *NewPCUser : TheModule.getFunction("newpc")->users()) {
+    auto *I = cast<Instruction>(NewPCUser);
+    auto WhitelistedMA = addressFromNewPC(I);
+    if (WhitelistedMA.isValid()
+        and JTM.isInValueMaterializerPCWhitelist(WhitelistedMA)) {
+      Result.push_back(I->getParent());
+    }
+  }
+
+  return Result;
+}
+
+RootAnalyzer::MetaAddressSet
+RootAnalyzer::inflateValueMaterializerWhitelist(ArrayRef<BasicBlock *> New) {
   MetaAddressSet Result;
 
-  // We start from all the new basic blocks (i.e., those in
-  // ValueMaterializerPCWhiteList) and proceed backward in the CFG in order to
-  // whitelist all the jump targets we meet. We stop when we meet the dispatcher
-  // or a function call.
+  // We start from all the new basic blocks and proceed backward in the CFG in
+  // order to whitelist all the jump targets we meet. We stop when we meet the
+  // dispatcher or a function call.
 
   // Prepare the backward visit
   df_iterator_default_set<BasicBlock *> VisitSet;
@@ -285,20 +303,12 @@ RootAnalyzer::MetaAddressSet RootAnalyzer::inflateValueMaterializerWhitelist() {
   // Stop at the dispatcher
   VisitSet.insert(JTM.dispatcher());
 
-  // TODO: OriginalInstructionAddresses is not reliable, we should drop it
-  for (User *NewPCUser : TheModule.getFunction("newpc")->users()) {
-    auto *I = cast<Instruction>(NewPCUser);
-    auto WhitelistedMA = addressFromNewPC(I);
-    if (WhitelistedMA.isValid()) {
-      if (JTM.isInValueMaterializerPCWhitelist(WhitelistedMA)) {
-        BasicBlock *BB = I->getParent();
-        auto VisitRange = inverse_depth_first_ext(BB, VisitSet);
-        for (const BasicBlock *Reachable : VisitRange) {
-          auto MA = getBasicBlockAddress(Reachable);
-          if (MA.isValid() and JTM.isJumpTarget(MA)) {
-            Result.insert(MA);
-          }
-        }
+  for (BasicBlock *BB : New) {
+    auto VisitRange = inverse_depth_first_ext(BB, VisitSet);
+    for (const BasicBlock *Reachable : VisitRange) {
+      auto MA = getBasicBlockAddress(Reachable);
+      if (MA.isValid() and JTM.isJumpTarget(MA)) {
+        Result.insert(MA);
       }
     }
   }
@@ -306,6 +316,27 @@ RootAnalyzer::MetaAddressSet RootAnalyzer::inflateValueMaterializerWhitelist() {
   return Result;
 }
 
+/// \return the basic blocks where the values written in the PC might differ
+///         from the previous run, i.e., those reachable from the new ones
+DenseSet<BasicBlock *>
+RootAnalyzer::computeAffectedBlocks(ArrayRef<BasicBlock *> New) {
+  DenseSet<BasicBlock *> Result;
+
+  // Values going through the dispatcher, or through any of the other blocks
+  // handling unknown PCs, are unknown anyway: stop there
+  df_iterator_default_set<BasicBlock *> VisitSet;
+  VisitSet.insert(JTM.dispatcher());
+  VisitSet.insert(JTM.dispatcherFail());
+  VisitSet.insert(JTM.anyPC());
+  VisitSet.insert(JTM.unexpectedPC());
+
+  for (BasicBlock *BB : New)
+    for (BasicBlock *Reachable : depth_first_ext(BB, VisitSet))
+      Result.insert(Reachable);
+
+  return Result;
+}
+
 // Update CPUStateAccessAnalysisPass
 void RootAnalyzer::updateCSAA() {
   legacy::PassManager PM;
@@ -326,7 +357,8 @@ getPreservedRegisters(const model::TypePath &Prototype) {
 
 // Clone the root function.
 Function *RootAnalyzer::createTemporaryRoot(Function *TheFunction,
-                                            ValueToValueMapTy &OldToNew) {
+                                            ValueToValueMapTy &OldToNew,
+                                            ArrayRef<BasicBlock *> New) {
   Function *OptimizedFunction = nullptr;
   Module *M = TheFunction->getParent();
   // Break all the call edges. We want to ignore those for CFG recovery
@@ -353,13 +385,11 @@ Function *RootAnalyzer::createTemporaryRoot(Function *TheFunction,
     }
   }
 
-  // Compute ValueMaterializerJumpTargetWhitelist
-  auto
-    ValueMaterializerJumpTargetWhitelist = inflateValueMaterializerWhitelist();
+  // Compute the jump targets the dispatcher has to keep
+  MetaAddressSet JumpTargetWhitelist = inflateValueMaterializerWhitelist(New);
 
   // Prune the dispatcher
-  JTM.setCFGForm(CFGForm::NoFunctionCalls,
-                 &ValueMaterializerJumpTargetWhitelist);
+  JTM.setCFGForm(CFGForm::NoFunctionCalls, &JumpTargetWhitelist);
 
   // Detach all the unreachable basic blocks, so they don't get copied
   llvm::DenseSet<BasicBlock *> UnreachableBBs = JTM.computeUnreachable();
@@ -813,8 +843,25 @@ static MetaAddress::Features findCommonFeatures(Function *F) {
 void RootAnalyzer::cloneOptimizeAndHarvest(Function *TheFunction) {
   updateCSAA();
 
+  // Only the exit_tb reachable from new code can have new values: the others
+  // have already been harvested in a previous run
+  SmallVector<BasicBlock *, 16> NewBlocks = collectNewBlocks();
+  DenseSet<BasicBlock *> Affected = computeAffectedBlocks(NewBlocks);
+
+  // An instruction can have several exit_tb: tell them apart by numbering
+  // them in program order, which does not change across runs. Do it before
+  // the unreachable blocks are detached from the root.
+  DenseMap<CallBase *, unsigned> ExitIndices;
+  std::map<MetaAddress, unsigned> ExitCounts;
+  for (BasicBlock &BB : *TheFunction)
+    for (Instruction &I : BB)
+      if (CallInst *Call = getCallTo(&I, JTM.exitTB()))
+        ExitIndices[Call] = ExitCounts[getPC(Call).first]++;
+
   ValueToValueMapTy OldToNew;
-  Function *OptimizedFunction = createTemporaryRoot(TheFunction, OldToNew);
+  Function *OptimizedFunction = createTemporaryRoot(TheFunction,
+                                                    OldToNew,
+                                                    NewBlocks);
 
   MetaAddress::Features CommonFeatures = findCommonFeatures(OptimizedFunction);
 
@@ -822,20 +869,37 @@ void RootAnalyzer::cloneOptimizeAndHarvest(Function *TheFunction) {
 
   // Register for analysis the value written in the PC before each exit_tb call
   IRBuilder<> Builder(TheModule.getContext());
+  uint64_t AnalyzedExits = 0;
+  uint64_t SkippedExits = 0;
   for (CallBase *Call : callersIn(JTM.exitTB(), TheFunction)) {
     BasicBlock *BB = Call->getParent();
     auto It = OldToNew.find(Call);
     if (It == OldToNew.end())
       continue;
+
+    MetaAddress PC = getPC(Call).first;
+    if (PC.isValid()) {
+      unsigned ExitIndex = ExitIndices.lookup(Call);
+      if (not Affected.contains(BB) and JTM.isHarvestedExit(PC, ExitIndex)) {
+        ++SkippedExits;
+        continue;
+      }
+      JTM.recordHarvestedExit(PC, ExitIndex);
+    }
+    ++AnalyzedExits;
+
     Builder.SetInsertPoint(cast<CallInst>(&*It->second));
     ProgramCounterHandler *PCH = JTM.programCounterHandler();
     Instruction *ComposedIntegerPC = PCH->composeIntegerPC(Builder);
-    AR.registerValue(getPC(Call).first,
+    AR.registerValue(PC,
                      Call,
                      ComposedIntegerPC,
                      TrackedInstructionType::WrittenInPC);
   }
 
+  HarvestingStats.push("harvest 3: exit_tb analyzed", AnalyzedExits);
+  HarvestingStats.push("harvest 3: exit_tb skipped", SkippedExits);
+
   promoteHelpersToIntrinsics(OptimizedFunction, Builder);
 
   // Replace calls to newpc with stores to the PC
@@ -6,7 +6,10 @@
 
 #include <unordered_set>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
@@ -40,9 +43,16 @@ private:
   void updateCSAA();
 
   llvm::Function *createTemporaryRoot(llvm::Function *TheFunction,
-                                      llvm::ValueToValueMapTy &OldToNew);
+                                      llvm::ValueToValueMapTy &OldToNew,
+                                      llvm::ArrayRef<llvm::BasicBlock *> New);
 
-  MetaAddressSet inflateValueMaterializerWhitelist();
+  llvm::SmallVector<llvm::BasicBlock *, 16> collectNewBlocks();
+
+  MetaAddressSet
+  inflateValueMaterializerWhitelist(llvm::ArrayRef<llvm::BasicBlock *> New);
+
+  llvm::DenseSet<llvm::BasicBlock *>
+  computeAffectedBlocks(llvm::ArrayRef<llvm::BasicBlock *> New);
 
   void promoteHelpersToIntrinsics(llvm::Function *OptimizedFunction,
                                   llvm::IRBuilder<> &Builder);
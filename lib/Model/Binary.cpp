@@ -5,6 +5,8 @@
 //
 
 #include <system_error>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/ScopeExit.h"
@@ -143,17 +145,9 @@ bool Binary::verifyTypes(bool Assert) const {
   return verifyTypes(VH);
 }
 
-bool Binary::verifyTypes(VerifyHelper &VH) const {
-  auto Guard = VH.suspendTracking(*this);
-
-  // All types on their own should verify
+static bool verifyTypeNames(VerifyHelper &VH, const model::Binary &Model) {
   std::set<Identifier> Names;
-  for (auto &Type : Types()) {
-    // Verify the type
-    if (not Type.get()->verify(VH))
-      return VH.fail();
-
-    // Ensure the names are unique
+  for (auto &Type : Model.Types()) {
     auto Name = Type->name();
     if (not Names.insert(Name).second)
       return VH.fail(Twine("Multiple types with the following name: ") + Name);
@@ -162,6 +156,18 @@ bool Binary::verifyTypes(VerifyHelper &VH) const {
   return true;
 }
 
+bool Binary::verifyTypes(VerifyHelper &VH) const {
+  auto Guard = VH.suspendTracking(*this);
+
+  // All types on their own should verify
+  for (auto &Type : Types())
+    if (not Type.get()->verify(VH))
+      return VH.fail();
+
+  // Ensure the names are unique
+  return verifyTypeNames(VH, *this);
+}
+
 void Binary::dump() const {
   TrackGuard Guard(*this);
   serialize(dbg, *this);
@@ -267,6 +273,24 @@ static bool verifyGlobalNamespace(VerifyHelper &VH,
   return true;
 }
 
+static bool verifySegments(VerifyHelper &VH, const model::Binary &Model) {
+  for (const Segment &S : Model.Segments())
+    if (not S.verify(VH))
+      return VH.fail();
+
+  // Make sure no segments overlap
+  for (const auto &[LHS, RHS] : zip_pairs(Model.Segments())) {
+    revng_assert(LHS.StartAddress() <= RHS.StartAddress());
+    if (LHS.endAddress() > RHS.StartAddress()) {
+      std::string Error = "Overlapping segments:\n" + serializeToString(LHS)
+                          + "and\n" + serializeToString(RHS);
+      return VH.fail(Error);
+    }
+  }
+
+  return true;
+}
+
 bool Binary::verify(VerifyHelper &VH) const {
   auto Guard = VH.suspendTracking(*this);
 
@@ -286,19 +310,8 @@ bool Binary::verify(VerifyHelper &VH) const {
       return VH.fail();
 
   // Verify Segments
-  for (const Segment &S : Segments())
-    if (not S.verify(VH))
-      return VH.fail();
-
-  // Make sure no segments overlap
-  for (const auto &[LHS, RHS] : zip_pairs(Segments())) {
-    revng_assert(LHS.StartAddress() <= RHS.StartAddress());
-    if (LHS.endAddress() > RHS.StartAddress()) {
-      std::string Error = "Overlapping segments:\n" + serializeToString(LHS)
-                          + "and\n" + serializeToString(RHS);
-      return VH.fail(Error);
-    }
-  }
+  if (not verifySegments(VH, *this))
+    return VH.fail();
 
   //
   // Verify the type system
@@ -306,6 +319,217 @@ bool Binary::verify(VerifyHelper &VH) const {
   return verifyTypes(VH);
 }
 
+namespace {
+
+/// The objects that a diff requires to verify again
+struct DirtyObjects {
+  std::unordered_set<TupleTreePath> Types;
+  std::unordered_set<TupleTreePath> Functions;
+  std::unordered_set<TupleTreePath> DynamicFunctions;
+  bool Segments = false;
+
+  /// Some global symbol or the name of some type might have changed
+  bool Names = false;
+};
+
+} // namespace
+
+/// \return the objects affected by \p Diff, or `std::nullopt` if it's not
+///         possible to tell without a full verification
+static std::optional<DirtyObjects>
+collectDirtyObjects(const TupleTreeDiff<model::Binary> &Diff) {
+  DirtyObjects Result;
+  for (const auto &Change : Diff.Changes) {
+    // Replacing entire top-level fields requires a full verification
+    if (Change.Path.size() < 2)
+      return std::nullopt;
+
+    std::optional<std::string> Path = pathAsString<model::Binary>(Change.Path);
+    if (not Path)
+      return std::nullopt;
+
+    // Paths look like `/Types/...`, `/Functions/...` and so on
+    StringRef Field = StringRef(*Path).drop_front().split('/').first;
+
+    // Adding or removing an object, or changing a name, can introduce clashes
+    // in the global namespace
+    bool IsWhole = Change.Path.size() == 2 or not Change.Old or not Change.New;
+    if (IsWhole or StringRef(*Path).contains("CustomName"))
+      Result.Names = true;
+
+    TupleTreePath Object = Change.Path;
+    Object.resize(2);
+    if (Field == "Types")
+      Result.Types.insert(std::move(Object));
+    else if (Field == "Functions")
+      Result.Functions.insert(std::move(Object));
+    else if (Field == "ImportedDynamicFunctions")
+      Result.DynamicFunctions.insert(std::move(Object));
+    else if (Field == "Segments")
+      Result.Segments = true;
+    else
+      return std::nullopt;
+  }
+
+  return Result;
+}
+
+/// Collect the global symbols defined by the objects in \p Dirty
+static std::set<Identifier>
+collectDirtyGlobalSymbols(const model::Binary &Model,
+                          const DirtyObjects &Dirty) {
+  std::set<Identifier> Result;
+  auto Add = [&Result](const Identifier &Name) {
+    if (not Name.empty())
+      Result.insert(Name);
+  };
+
+  for (const TupleTreePath &Path : Dirty.Functions)
+    if (auto *F = getByPath<const model::Function>(Path, Model))
+      Add(F->CustomName());
+
+  for (const TupleTreePath &Path : Dirty.DynamicFunctions)
+    if (auto *DF = getByPath<const model::DynamicFunction>(Path, Model))
+      Add(DF->CustomName());
+
+  for (const TupleTreePath &Path : Dirty.Types) {
+    if (auto *T = getByPath<const model::Type>(Path, Model)) {
+      Add(T->CustomName());
+      if (auto *Enum = dyn_cast<EnumType>(T))
+        for (const EnumEntry &Entry : Enum->Entries())
+          Add(Entry.CustomName());
+    }
+  }
+
+  if (Dirty.Segments)
+    for (const Segment &S : Model.Segments())
+      Add(S.CustomName());
+
+  return Result;
+}
+
+/// \return true if any of the local names of \p T is in \p Names
+static bool hasLocalNameIn(const model::Type &T,
+                           const std::set<Identifier> &Names) {
+  auto IsIn = [&Names](const auto &Element) {
+    return Names.contains(Element.CustomName());
+  };
+
+  if (auto *Struct = dyn_cast<StructType>(&T))
+    return llvm::any_of(Struct->Fields(), IsIn);
+  else if (auto *Union = dyn_cast<UnionType>(&T))
+    return llvm::any_of(Union->Fields(), IsIn);
+  else if (auto *CABI = dyn_cast<CABIFunctionType>(&T))
+    return llvm::any_of(CABI->Arguments(), IsIn);
+  else if (auto *Raw = dyn_cast<RawFunctionType>(&T))
+    return llvm::any_of(Raw->Arguments(), IsIn);
+
+  return false;
+}
+
+bool verifyDiff(const model::Binary &Model,
+                const TupleTreeDiff<model::Binary> &Diff,
+                VerifyHelper &VH) {
+  std::optional<DirtyObjects> MaybeDirty = collectDirtyObjects(Diff);
+  if (not MaybeDirty)
+    return Model.verify(VH);
+  DirtyObjects &Dirty = *MaybeDirty;
+
+  auto Guard = VH.suspendTracking(Model);
+
+  // The global namespace is needed to verify the local ones
+  if (not verifyGlobalNamespace(VH, Model))
+    return VH.fail();
+
+  // A new global symbol might clash with the local names of any type
+  if (Dirty.Names) {
+    if (not verifyTypeNames(VH, Model))
+      return VH.fail();
+
+    std::set<Identifier> Symbols = collectDirtyGlobalSymbols(Model, Dirty);
+    if (not Symbols.empty())
+      for (const UpcastablePointer<model::Type> &T : Model.Types())
+        if (hasLocalNameIn(*T, Symbols))
+          Dirty.Types.insert(Model.getTypePath(T->key()).path());
+  }
+
+  // The verification of a type depends on the types it refers to (e.g., for
+  // their size), propagate the changes to all the types depending on them
+  std::unordered_set<TupleTreePath> &Affected = Dirty.Types;
+  if (not Affected.empty()) {
+    std::unordered_map<TupleTreePath, SmallVector<TupleTreePath, 2>> Users;
+    for (const UpcastablePointer<model::Type> &T : Model.Types()) {
+      TupleTreePath User = Model.getTypePath(T->key()).path();
+      for (const model::QualifiedType &Edge : T->edges())
+        Users[Edge.UnqualifiedType().path()].push_back(User);
+    }
+
+    SmallVector<TupleTreePath, 16> Worklist(Affected.begin(), Affected.end());
+    while (not Worklist.empty()) {
+      TupleTreePath Current = Worklist.pop_back_val();
+      auto It = Users.find(Current);
+      if (It == Users.end())
+        continue;
+
+      for (const TupleTreePath &User : It->second)
+        if (Affected.insert(User).second)
+          Worklist.push_back(User);
+    }
+  }
+
+  for (const TupleTreePath &Path : Affected)
+    if (auto *T = getByPath<const model::Type>(Path, Model))
+      if (not T->verify(VH))
+        return VH.fail();
+
+  auto IsAffected = [&Affected](const model::TypePath &Reference) {
+    return not Reference.empty() and Affected.contains(Reference.path());
+  };
+
+  std::set<const Function *> ChangedFunctions;
+  for (const TupleTreePath &Path : Dirty.Functions)
+    if (auto *F = getByPath<const model::Function>(Path, Model))
+      ChangedFunctions.insert(F);
+
+  // Verify the functions that changed or that use an affected type
+  for (const Function &F : Model.Functions()) {
+    bool IsDirty = ChangedFunctions.contains(&F);
+    bool UsesAffected = IsAffected(F.Prototype())
+                        or IsAffected(F.StackFrameType())
+                        or llvm::any_of(F.CallSitePrototypes(),
+                                        [&](const CallSitePrototype &CSP) {
+                                          return IsAffected(CSP.Prototype());
+                                        });
+    if ((IsDirty or UsesAffected) and not F.verify(VH))
+      return VH.fail();
+  }
+
+  std::set<const DynamicFunction *> ChangedDynamicFunctions;
+  for (const TupleTreePath &Path : Dirty.DynamicFunctions)
+    if (auto *DF = getByPath<const model::DynamicFunction>(Path, Model))
+      ChangedDynamicFunctions.insert(DF);
+
+  for (const DynamicFunction &DF : Model.ImportedDynamicFunctions()) {
+    bool IsDirty = ChangedDynamicFunctions.contains(&DF);
+    if ((IsDirty or IsAffected(DF.Prototype())) and not DF.verify(VH))
+      return VH.fail();
+  }
+
+  auto UsesAffected = [&](const Segment &S) { return IsAffected(S.Type()); };
+  if (Dirty.Segments or llvm::any_of(Model.Segments(), UsesAffected))
+    if (not verifySegments(VH, Model))
+      return VH.fail();
+
+  return true;
+}
+
+bool verifyDiff(const model::Binary &Model,
+                const TupleTreeDiff<model::Binary> &Diff,
+                bool Assert) {
+  VerifyHelper VH(Assert);
+  return verifyDiff(Model, Diff, VH);
+}
+
 Identifier Function::name() const {
   using llvm::Twine;
   if (not CustomName().empty()) {
@@ -0,0 +1,212 @@
+/// \file DependencyModelCache.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Model/Importer/Binary/DependencyModelCache.h"
+#include "revng/Model/Importer/Binary/Options.h"
+#include "revng/Model/Pass/PurgeUnnamedAndUnreachableTypes.h"
+#include "revng/Support/Debug.h"
+#include "revng/Support/ResourceFinder.h"
+#include "revng/TupleTree/BinarySerialization.h"
+
+using namespace llvm;
+
+static Logger<> Log("dependency-model-cache");
+
+/// Bump this every time the content of the entries changes in an incompatible
+/// way, e.g., when `prune` starts dropping something else.
+static constexpr StringRef FormatVersion = "2";
+
+static constexpr StringRef Extension = ".ttb";
+
+DependencyModelCache::DependencyModelCache(std::string Directory) :
+  Directory(std::move(Directory)) {}
+
+DependencyModelCache::DependencyModelCache() {
+  if (not CacheDependencyModels)
+    return;
+
+  if (not DependencyModelsCachePath.empty()) {
+    Directory = DependencyModelsCachePath;
+    return;
+  }
+
+  SmallString<128> Path;
+  if (auto XDGCacheHome = sys::Process::GetEnv("XDG_CACHE_HOME")) {
+    sys::path::append(Path, *XDGCacheHome, "revng");
+  } else {
+    SmallString<64> Home;
+    if (not sys::path::home_directory(Home))
+      return;
+    sys::path::append(Path, Home, ".cache", "revng");
+  }
+  sys::path::append(Path, "dependency-models");
+  Directory = Path.str().str();
+}
+
+std::string
+DependencyModelCache::key(StringRef BuildID,
+                          const std::optional<std::string> &DebugInfoPath,
+                          model::Architecture::Values Architecture,
+                          const ImporterOptions &Options) {
+  if (BuildID.empty())
+    return {};
+
+  SHA1 Hasher;
+  auto Add = [&Hasher](StringRef Data) {
+    Hasher.update(Data);
+    // Separator, so that adjacent strings cannot be confused
+    Hasher.update(StringRef("\0", 1));
+  };
+
+  Add(FormatVersion);
+  Add(revng::getComponentsHash());
+
+  // Installing or removing the debug information of a library changes the
+  // imported model
+  if (DebugInfoPath) {
+    sys::fs::file_status Status;
+    if (sys::fs::status(*DebugInfoPath, Status))
+      return {};
+
+    Add(*DebugInfoPath);
+    Add(utostr(Status.getSize()));
+    Add(utostr(sys::toTimeT(Status.getLastModificationTime())));
+  } else {
+    Add("no-debug-info");
+  }
+
+  Add(model::Architecture::getName(Architecture));
+  Add(utostr(Options.BaseAddress));
+  Add(utostr(static_cast<unsigned>(Options.DebugInfo)));
+  Add(Options.EnableRemoteDebugInfo ? "remote" : "local");
+  for (const std::string &Path : Options.AdditionalDebugInfoPaths)
+    Add(Path);
+
+  // The build-id already identifies the library, a prefix of the digest of
+  // the options is enough to tell apart different configurations.
+  std::string OptionsDigest = toHex(Hasher.final(), true);
+  return (BuildID + "-" + StringRef(OptionsDigest).take_front(16)).str();
+}
+
+std::string DependencyModelCache::pathFor(StringRef Key) const {
+  SmallString<128> Path;
+  sys::path::append(Path, Directory, Key + Extension);
+  return Path.str().str();
+}
+
+std::optional<TupleTree<model::Binary>>
+DependencyModelCache::load(StringRef Key) const {
+  if (not isEnabled() or Key.empty())
+    return std::nullopt;
+
+  std::string Path = pathFor(Key);
+  auto MaybeBuffer = MemoryBuffer::getFile(Path,
+                                           /* IsText */ false,
+                                           /* RequiresNullTerminator */ false);
+  if (not MaybeBuffer) {
+    revng_log(Log, "Miss: " << Path);
+    return std::nullopt;
+  }
+
+  // Entries are written atomically, but they might have been produced by a
+  // version of revng with a different schema: deserialization checks that
+  StringRef Serialized = (*MaybeBuffer)->getBuffer();
+  if (not isBinaryTupleTree(Serialized)) {
+    revng_log(Log, "Ignoring malformed entry " << Path);
+    return std::nullopt;
+  }
+
+  auto MaybeModel = TupleTree<model::Binary>::deserialize(Serialized);
+  if (not MaybeModel or not(*MaybeModel)->verify()) {
+    revng_log(Log, "Ignoring invalid entry " << Path);
+    return std::nullopt;
+  }
+
+  revng_log(Log, "Hit: " << Path);
+  return std::move(*MaybeModel);
+}
+
+void DependencyModelCache::store(StringRef Key,
+                                 const TupleTree<model::Binary> &Model) const {
+  if (not isEnabled() or Key.empty())
+    return;
+
+  if (auto EC = sys::fs::create_directories(Directory)) {
+    revng_log(Log, "Can't create " << Directory << ": " << EC.message());
+    return;
+  }
+
+  // Write to a temporary file and then move it in place, so that concurrent
+  // importers never observe a partially written entry
+  int FD = -1;
+  SmallString<128> TemporaryPath;
+  SmallString<128> TemporaryModel;
+  sys::path::append(TemporaryModel, Directory, Key + "-%%%%%%%%.tmp");
+  if (auto EC = sys::fs::createUniqueFile(TemporaryModel, FD, TemporaryPath)) {
+    revng_log(Log, "Can't create a temporary file: " << EC.message());
+    return;
+  }
+
+  {
+    raw_fd_ostream OS(FD, /* shouldClose */ true);
+    serializeBinary(OS, *Model);
+    if (OS.has_error()) {
+      revng_log(Log, "Can't write " << TemporaryPath);
+      OS.clear_error();
+      sys::fs::remove(TemporaryPath);
+      return;
+    }
+  }
+
+  std::string Path = pathFor(Key);
+  if (auto EC = sys::fs::rename(TemporaryPath, Path)) {
+    revng_log(Log, "Can't move the entry in place: " << EC.message());
+    sys::fs::remove(TemporaryPath);
+    return;
+  }
+
+  revng_log(Log, "Stored: " << Path);
+}
+
+void DependencyModelCache::prune(TupleTree<model::Binary> &Model) {
+  Model->Segments().clear();
+  Model->ImportedLibraries().clear();
+  Model->ExtraCodeAddresses().clear();
+  Model->EntryPoint() = MetaAddress::invalid();
+
+  llvm::erase_if(Model->Functions(), [](model::Function &Function) {
+    return not Function.Prototype().isValid();
+  });
+  for (model::Function &Function : Model->Functions()) {
+    Function.Comment().clear();
+    Function.StackFrameType() = {};
+    Function.CallSitePrototypes().clear();
+  }
+
+  auto &DynamicFunctions = Model->ImportedDynamicFunctions();
+  llvm::erase_if(DynamicFunctions, [](model::DynamicFunction &Function) {
+    return not Function.Prototype().isValid();
+  });
+  for (model::DynamicFunction &Function : DynamicFunctions) {
+    Function.Comment().clear();
+    Function.Relocations().clear();
+  }
+
+  // Elements have been moved around, drop any cached pointer
+  Model.evictCachedReferences();
+  Model.initializeReferences();
+
+  model::purgeUnreachableTypes(Model);
+}
@@ -17,6 +17,7 @@
 #include "revng/Model/Binary.h"
 #include "revng/Model/IRHelpers.h"
 #include "revng/Model/Importer/Binary/BinaryImporterHelper.h"
+#include "revng/Model/Importer/Binary/DependencyModelCache.h"
 #include "revng/Model/Importer/Binary/Options.h"
 #include "revng/Model/Importer/DebugInfo/DwarfImporter.h"
 #include "revng/Model/Pass/AllPasses.h"
@@ -391,6 +392,8 @@ void ELFImporter<T, HasAddend>::findMissingTypes(object::ELFFile<T> &TheELF,
   //       the `ImporterOptions::DebugInfo`, if the need ever arises.
   unsigned MaximumRecursionDepth = 1;
 
+  DependencyModelCache Cache;
+
   LDDTree Dependencies;
   lddtree(Dependencies, TheBinary.getFileName().str(), MaximumRecursionDepth);
   for (auto &Library : Dependencies) {
@@ -414,17 +417,33 @@ void ELFImporter<T, HasAddend>::findMissingTypes(object::ELFFile<T> &TheELF,
       if (!TheBinary)
         continue;
 
-      using model::Binary;
-      using std::make_unique;
-      ModelsOfLibraries[DependencyLibrary] = TupleTree<Binary>();
-      TupleTree<model::Binary> &DepModel = ModelsOfLibraries[DependencyLibrary];
-      DepModel->Architecture() = Model->Architecture();
       ImporterOptions AdjustedOptions{
         .BaseAddress = Opts.BaseAddress,
         .DebugInfo = DebugInfoLevel::IgnoreLibraries,
         .EnableRemoteDebugInfo = Opts.EnableRemoteDebugInfo,
         .AdditionalDebugInfoPaths = Opts.AdditionalDebugInfoPaths
       };
+
+      std::string CacheKey;
+      std::optional<std::string> DebugInfo;
+      if (Cache.isEnabled()) {
+        DebugInfo = findLocalDebugInfo(DependencyLibrary, TheBinary);
+        CacheKey = DependencyModelCache::key(getBuildID(TheBinary),
+                                             DebugInfo,
+                                             Model->Architecture(),
+                                             AdjustedOptions);
+        if (auto Cached = Cache.load(CacheKey)) {
+          revng_log(ELFImporterLog, " Using the cached model");
+          ModelsOfLibraries[DependencyLibrary] = std::move(*Cached);
+          continue;
+        }
+      }
+
+      using model::Binary;
+      using std::make_unique;
+      ModelsOfLibraries[DependencyLibrary] = TupleTree<Binary>();
+      TupleTree<model::Binary> &DepModel = ModelsOfLibraries[DependencyLibrary];
+      DepModel->Architecture() = Model->Architecture();
       if (auto E = importELF(DepModel, *TheBinary, AdjustedOptions)) {
         revng_log(ELFImporterLog,
                   "Can't import model for " << DependencyLibrary << " due to "
@@ -433,6 +452,30 @@ void ELFImporter<T, HasAddend>::findMissingTypes(object::ELFFile<T> &TheELF,
         ModelsOfLibraries.erase(DependencyLibrary);
         continue;
       }
+
+      // Cached models are pruned: prune the model on a miss too, so that the
+      // results do not depend on whether the entry was already there
+      if (Cache.isEnabled()) {
+        DependencyModelCache::prune(DepModel);
+
+        // The debug information might have been fetched during the import:
+        // the entry has to be keyed by what has actually been imported
+        if (not DebugInfo) {
+          DebugInfo = findLocalDebugInfo(DependencyLibrary, TheBinary);
+          if (DebugInfo)
+            CacheKey = DependencyModelCache::key(getBuildID(TheBinary),
+                                                 DebugInfo,
+                                                 Model->Architecture(),
+                                                 AdjustedOptions);
+        }
+
+        // If fetching failed, e.g., due to a network error, a later import
+        // might succeed: don't store a model lacking the debug information
+        if (DebugInfo or not AdjustedOptions.EnableRemoteDebugInfo)
+          Cache.store(CacheKey, DepModel);
+        else
+          revng_log(ELFImporterLog, " Not caching, debug info unavailable");
+      }
     }
   }
 
@@ -57,6 +57,21 @@ cl::opt<bool> EnableRemoteDebugInfo("enable-remote-debug-info",
                                     cl::cat(MainCategory),
                                     cl::init(false));
 
+constexpr SR DescCache = "Cache on disk the models imported from the "
+                         "libraries the input depends on.";
+cl::opt<bool> CacheDependencyModels("cache-dependency-models",
+                                    cl::desc(DescCache),
+                                    cl::cat(MainCategory),
+                                    cl::init(false));
+
+constexpr SR DescCachePath = "Directory holding the cached models of "
+                             "dependencies. Defaults to "
+                             "$XDG_CACHE_HOME/revng/dependency-models.";
+cl::opt<std::string> DependencyModelsCachePath("dependency-models-cache-path",
+                                               cl::desc(DescCachePath),
+                                               cl::value_desc("directory"),
+                                               cl::cat(MainCategory));
+
 const ImporterOptions importerOptions() {
   return ImporterOptions{ .BaseAddress = BaseAddress,
                           .DebugInfo = DebugInfo,
@@ -1091,7 +1091,7 @@ ArrayRef<uint8_t> getSectionsContents(StringRef Name, T &ELF) {
   return {};
 }
 
-static std::string getBuildID(const object::Binary *B) {
+std::string getBuildID(const object::Binary *B) {
   using namespace llvm::object;
 
   auto Handler = [&](auto *ELFObject) -> std::string {
@@ -1189,7 +1189,7 @@ static bool fileExists(const Twine &Path) {
 static std::optional<std::string>
 findDebugInfoFileByName(StringRef FileName,
                         StringRef DebugFileName,
-                        llvm::object::ObjectFile *ELF) {
+                        const llvm::object::ObjectFile *ELF) {
   // Let's find it in canonical places, where debug info was fetched.
   //  1) Look for a .gnu_debuglink/.gnu_debugaltlink/.debug_sup section.
   //  The .debug file should be in canonical places.
@@ -1300,6 +1300,40 @@ findDebugInfoFileByName(StringRef FileName,
   return std::nullopt;
 }
 
+static bool hasDebugInfo(const object::ObjectFile *Object) {
+  for (const object::SectionRef &Section : Object->sections()) {
+    StringRef SectionName;
+    if (Expected<StringRef> NameOrErr = Section.getName()) {
+      SectionName = *NameOrErr;
+    } else {
+      llvm::consumeError(NameOrErr.takeError());
+      continue;
+    }
+
+    // TODO: When adding support for Split dwarf, there will be
+    // .debug_info.dwo section, so we need to handle it.
+    if (SectionName == ".debug_info")
+      return true;
+  }
+  return false;
+}
+
+std::optional<std::string> findLocalDebugInfo(StringRef FileName,
+                                              const object::Binary *B) {
+  auto *ELF = dyn_cast<object::ObjectFile>(B);
+  if (ELF == nullptr)
+    return std::nullopt;
+
+  if (hasDebugInfo(ELF))
+    return FileName.str();
+
+  StringRef DebugFile = getDebugFileName(B);
+  if (DebugFile.empty())
+    return std::nullopt;
+
+  return findDebugInfoFileByName(FileName, DebugFile, ELF);
+}
+
 void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
   Task T(3,
          "Importing DWARF information for "
@@ -1320,24 +1354,6 @@ void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
   // it on the device.
   // TODO: When we add support for Split DWARF, this will need additional
   // improvement.
-  auto HasDebugInfo = [](ObjectFile *Object) {
-    for (const SectionRef &Section : Object->sections()) {
-      StringRef SectionName;
-      if (Expected<StringRef> NameOrErr = Section.getName()) {
-        SectionName = *NameOrErr;
-      } else {
-        llvm::consumeError(NameOrErr.takeError());
-        continue;
-      }
-
-      // TODO: When adding support for Split dwarf, there will be
-      // .debug_info.dwo section, so we need to handle it.
-      if (SectionName == ".debug_info")
-        return true;
-    }
-    return false;
-  };
-
   auto PerformImport = [this, &T, &Options](StringRef FilePath,
                                             StringRef TheDebugFile) {
     auto ExpectedBinary = object::createBinary(FilePath);
@@ -1354,7 +1370,7 @@ void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
   };
 
   if (auto *ELF = dyn_cast<ObjectFile>(BinOrErr->get())) {
-    if (Options.DebugInfo != DebugInfoLevel::No && !HasDebugInfo(ELF)) {
+    if (Options.DebugInfo != DebugInfoLevel::No && !hasDebugInfo(ELF)) {
       // There are no .debug_* sections in the file itself, let's try to find it
       // on the device, otherwise find it on web by using the `fetch-debuginfo`
       // tool.
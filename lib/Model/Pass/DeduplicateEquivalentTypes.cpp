@@ -5,8 +5,12 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
 
 #include "revng/ADT/GenericGraph.h"
@@ -14,12 +18,15 @@
 #include "revng/Model/Pass/DeduplicateEquivalentTypes.h"
 #include "revng/Model/Pass/RegisterModelPass.h"
 #include "revng/Support/Debug.h"
+#include "revng/Support/Statistics.h"
 
 using namespace llvm;
 using namespace model;
 
 static Logger<> Log("model-types-deduplication");
 
+static CounterMap<std::string> Statistics("deduplicate-equivalent-types");
+
 static RegisterModelPass R("deduplicate-equivalent-types",
                            "Best-effort deduplication of types that are "
                            "structurally equivalent",
@@ -40,6 +47,54 @@ compareAll(SmallVector<model::Type *> &ToTest,
   }
 }
 
+static uint64_t pairsCount(uint64_t Size) {
+  return Size * (Size - 1) / 2;
+}
+
+/// Like compareAll, but only compare types with the same \p Hash.
+///
+/// \p Hash must return the same value for any two types that \p Compare
+/// considers equivalent. \p ToTest is left with the types that have not been
+/// found to be equivalent to any type preceding them.
+static void
+compareAllByHash(SmallVector<model::Type *> &ToTest,
+                 const llvm::DenseMap<model::Type *, uint64_t> &Hash,
+                 std::function<bool(model::Type *, model::Type *)> Compare,
+                 llvm::StringRef Phase) {
+  if (ToTest.size() < 2)
+    return;
+
+  // Note: the relative order of the types is preserved in each bucket, so the
+  //       leaders are the same compareAll would have picked
+  llvm::MapVector<uint64_t, SmallVector<model::Type *>> Buckets;
+  for (model::Type *T : ToTest)
+    Buckets[Hash.lookup(T)].push_back(T);
+
+  uint64_t Skipped = pairsCount(ToTest.size());
+  ToTest.clear();
+  for (auto &Bucket : Buckets) {
+    Skipped -= pairsCount(Bucket.second.size());
+    compareAll(Bucket.second, Compare);
+    ToTest.append(Bucket.second.begin(), Bucket.second.end());
+  }
+
+  Statistics.push((Phase + "-pairs-skipped").str(), Skipped);
+}
+
+/// Hash the parts of \p T that model::Type::localCompare considers, i.e.,
+/// everything but the ID and the types it refers to
+static uint64_t localHash(const model::Type *T) {
+  llvm::hash_code Result = llvm::hash_combine(T->Kind(),
+                                              StringRef(T->OriginalName()));
+  for (const model::QualifiedType &QT : T->edges()) {
+    Result = llvm::hash_combine(Result, QT.Qualifiers().size());
+    for (const model::Qualifier &Q : QT.Qualifiers())
+      Result = llvm::hash_combine(Result, Q.Kind(), Q.Size());
+  }
+
+  return Result;
+}
+
 class TypeSystemDeduplicator {
 private:
   struct TypeNode {
@@ -52,14 +107,27 @@ private:
   std::vector<model::Type *> Types;
   EquivalenceClasses<model::Type *> StrongEquivalence;
   EquivalenceClasses<model::Type *> WeakEquivalence;
-  Graph TypeGraph;
+  Graph TypeGraph{ NodeAllocation::Arena };
   std::map<const model::Type *, Node *> TypeToNode;
   std::vector<model::Type *> VisitOrder;
 
+  /// Hash of the local part of each type
+  llvm::DenseMap<model::Type *, uint64_t> LocalHash;
+
+  /// Hash of each type taking into account all the types reachable from it
+  llvm::DenseMap<model::Type *, uint64_t> StructuralHash;
+
+  /// The number of refinement rounds in computeStructuralHashes is capped, in
+  /// case of long chains of types. Stopping early is safe, it just makes the
+  /// hashes less precise.
+  static constexpr unsigned MaxRefinementRounds = 64;
+
 private:
   TypeSystemDeduplicator(TupleTree<model::Binary> &Model) {
-    for (auto &T : Model->Types())
+    for (auto &T : Model->Types()) {
       Types.push_back(&*T);
+      LocalHash[&*T] = localHash(&*T);
+    }
   }
 
 public:
@@ -68,6 +136,7 @@ public:
     TypeSystemDeduplicator Helper(Model);
     Helper.computeWeakEquivalenceClasses();
     Helper.createTypeGraph();
+    Helper.computeStructuralHashes();
     Helper.computeVisitOrder();
     Helper.computeStrongEquivalenceClasses();
     return std::move(Helper.StrongEquivalence);
@@ -110,6 +179,7 @@ private:
         auto Compare = [this](model::Type *Left, model::Type *Right) -> bool {
           revng_assert(Left != Right
                        and not WeakEquivalence.isEquivalent(Left, Right));
+          Statistics.push("weak-comparisons");
           if (Left->localCompare(*Right)) {
             revng_log(Log,
                       Left->ID()
@@ -134,7 +204,7 @@ private:
           }
         };
 
-        compareAll(ToTest, Compare);
+        compareAllByHash(ToTest, LocalHash, Compare, "weak");
 
         revng_log(Log,
                   GroupName << " has " << ToTest.size()
@@ -159,6 +229,46 @@ private:
         addEdge(T, QT);
   }
 
+  /// Compute a hash of each type which is equal for all the types deepCompare
+  /// might consider equivalent.
+  ///
+  /// Equivalent types are bisimilar: they are locally equal and so are their
+  /// successors, pairwise. Therefore, we start from the local hash and, in each
+  /// round, combine the hash of each type with the hashes of its successors.
+  /// This is a partition refinement: once a round does not increase the number
+  /// of distinct hashes, we reached a fixed point. Cycles need no special
+  /// handling.
+  void computeStructuralHashes() {
+    revng_log(Log, "Computing structural hashes");
+    LoggerIndent Indent(Log);
+
+    auto CountDistinct = [](const llvm::DenseMap<model::Type *, uint64_t> &M) {
+      llvm::DenseSet<uint64_t> Distinct;
+      for (const auto &Entry : M)
+        Distinct.insert(Entry.second);
+      return Distinct.size();
+    };
+
+    StructuralHash = LocalHash;
+    size_t Classes = CountDistinct(StructuralHash);
+    for (unsigned Round = 0; Round < MaxRefinementRounds; ++Round) {
+      llvm::DenseMap<model::Type *, uint64_t> Refined;
+      for (model::Type *T : Types) {
+        llvm::hash_code Hash = StructuralHash.lookup(T);
+        for (Node *Successor : TypeToNode.at(T)->successors())
+          Hash = llvm::hash_combine(Hash, StructuralHash.lookup(Successor->T));
+        Refined[T] = Hash;
+      }
+
+      StructuralHash = std::move(Refined);
+      size_t NewClasses = CountDistinct(StructuralHash);
+      revng_log(Log, "Round " << Round << ": " << NewClasses << " classes");
+      if (NewClasses == Classes)
+        break;
+      Classes = NewClasses;
+    }
+  }
+
   /// Compute a visit order: post order in the leaders of WeakEquivalence
   void computeVisitOrder() {
     revng_log(Log, "Computing visit order");
@@ -205,6 +315,7 @@ private:
         revng_log(Log, "Comparing " << Left->ID() << " and " << Right->ID());
         LoggerIndent Indent(Log);
 
+        Statistics.push("deep-comparisons");
         bool Result = deepCompare(Left, Right);
 
         revng_log(Log, "Comparison result: " << (Result ? "true" : "false"));
@@ -212,7 +323,7 @@ private:
         return Result;
       };
 
-      compareAll(ToTest, Compare);
+      compareAllByHash(ToTest, StructuralHash, Compare, "deep");
     }
   }
 
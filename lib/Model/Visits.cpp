@@ -18,3 +18,12 @@ getByPath<model::Type, const model::Binary>(const TupleTreePath &Path,
 template model::Type *
 getByPath<model::Type, model::Binary>(const TupleTreePath &Path,
                                       model::Binary &M);
+
+template const model::Function *
+getByPath<const model::Function, const model::Binary>(const TupleTreePath &Path,
+                                                      const model::Binary &M);
+
+template const model::DynamicFunction *
+getByPath<const model::DynamicFunction,
+          const model::Binary>(const TupleTreePath &Path,
+                               const model::Binary &M);
@@ -17,6 +17,21 @@ using namespace llvm;
 using namespace pipeline;
 using namespace cl;
 
+static std::vector<ContainerPassesHook> &getContainerPassesHooks() {
+  static std::vector<ContainerPassesHook> Hooks;
+  return Hooks;
+}
+
+RegisterContainerPasses::RegisterContainerPasses(ContainerPassesHook Hook) {
+  getContainerPassesHooks().push_back(Hook);
+}
+
+void pipeline::addContainerPasses(const LLVMContainer &Container,
+                                  llvm::legacy::PassManager &Manager) {
+  for (ContainerPassesHook Hook : getContainerPassesHooks())
+    Hook(Container, Manager);
+}
+
 void O2Pipe::registerPasses(llvm::legacy::PassManager &Manager) {
   StringMap<llvm::cl::Option *> &Options(getRegisteredOptions());
   getOption<bool>(Options, "disable-machine-licm")->setInitialValue(true);
@@ -31,6 +46,7 @@ std::unique_ptr<LLVMPassWrapperBase> PureLLVMPassWrapper::clone() const {
 
 void GenericLLVMPipe::run(const ExecutionContext &, LLVMContainer &Container) {
   llvm::legacy::PassManager Manager;
+  addContainerPasses(Container, Manager);
   for (const auto &Element : Passes)
     Element->registerPasses(Manager);
   Manager.run(Container.getModule());
@@ -10,6 +10,8 @@
 #include <memory>
 
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DebugInfoMetadata.h"
@@ -20,6 +22,7 @@
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 
@@ -31,6 +34,102 @@
 const char pipeline::LLVMContainer::ID = '0';
 using namespace pipeline;
 
+static llvm::cl::opt<bool> TextualIR("llvm-container-textual-ir",
+                                     llvm::cl::desc("Serialize LLVM containers "
+                                                    "as textual IR instead of "
+                                                    "bitcode. Slow, meant for "
+                                                    "debugging purposes."),
+                                     llvm::cl::init(false));
+
+/// Name of the named metadata used to preserve the metadata attached to
+/// function definitions.
+///
+/// The bitcode reader loads the metadata attached to a function definition
+/// only when its body is materialized, but we need it to enumerate the
+/// targets. Therefore, we save a copy of it at module level before writing the
+/// bitcode and we attach it back to the unmaterialized functions upon loading.
+static constexpr const char *LazyAttachmentsName = "revng.lazy-attachments";
+
+static void saveFunctionAttachments(llvm::Module &Module) {
+  using namespace llvm;
+  LLVMContext &Context = Module.getContext();
+  auto *Index = Module.getOrInsertNamedMetadata(LazyAttachmentsName);
+
+  SmallVector<StringRef, 32> KindNames;
+  Context.getMDKindNames(KindNames);
+
+  for (Function &F : Module.functions()) {
+    if (F.isDeclaration())
+      continue;
+
+    SmallVector<std::pair<unsigned, MDNode *>, 2> MDs;
+    F.getAllMetadata(MDs);
+
+    SmallVector<Metadata *, 5> Entry = { ValueAsMetadata::get(&F) };
+    for (auto &[Kind, MD] : MDs) {
+      // The !dbg attachment cannot be attached to a declaration
+      if (Kind == LLVMContext::MD_dbg)
+        continue;
+
+      Entry.push_back(MDString::get(Context, KindNames[Kind]));
+      Entry.push_back(MD);
+    }
+
+    if (Entry.size() > 1)
+      Index->addOperand(MDTuple::get(Context, Entry));
+  }
+}
+
+static void restoreFunctionAttachments(llvm::Module &Module) {
+  using namespace llvm;
+  auto *Index = Module.getNamedMetadata(LazyAttachmentsName);
+  if (Index == nullptr)
+    return;
+
+  for (MDNode *Entry : Index->operands()) {
+    auto *AsValue = cast<ValueAsMetadata>(Entry->getOperand(0));
+    auto *F = cast<Function>(AsValue->getValue());
+
+    // If the function has already been materialized, it has all of its
+    // attachments already
+    if (not F->isMaterializable())
+      continue;
+
+    for (unsigned I = 1; I < Entry->getNumOperands(); I += 2) {
+      StringRef Kind = cast<MDString>(Entry->getOperand(I))->getString();
+      F->setMetadata(Kind, cast<MDNode>(Entry->getOperand(I + 1)));
+    }
+  }
+
+  Index->eraseFromParent();
+}
+
+void LLVMContainer::materialize(llvm::Function &F) const {
+  if (not F.isMaterializable())
+    return;
+
+  // Drop the attachments restored from the index: the bitcode reader is going
+  // to attach them again
+  F.clearMetadata();
+  llvm::cantFail(F.materialize());
+}
+
+void LLVMContainer::materializeAll() const {
+  if (not IsLazy)
+    return;
+
+  for (llvm::Function &F : Module->functions())
+    materialize(F);
+
+  llvm::cantFail(Module->materializeAll());
+  IsLazy = false;
+
+  // The module no longer refers to the bitcode
+  Bitcode.reset();
+
+  revng::verify(Module.get());
+}
+
 void pipeline::makeGlobalObjectsArray(llvm::Module &Module,
                                       llvm::StringRef GlobalArrayName) {
   auto *IntegerTy = llvm::IntegerType::get(Module.getContext(),
@@ -72,9 +171,16 @@ LLVMContainer::cloneFiltered(const TargetsList &Targets) const {
     return ToClone.contains(F) or ToClonedNotOwned.contains(F);
   };
 
-  llvm::ValueToValueMapTy Map;
+  // Materialize only the functions we are going to clone
+  if (IsLazy) {
+    for (llvm::Function &F : Module->functions())
+      if (Filter(&F))
+        materialize(F);
+  } else {
+    revng::verify(Module.get());
+  }
 
-  revng::verify(Module.get());
+  llvm::ValueToValueMapTy Map;
   auto Cloned = llvm::CloneModule(*Module, Map, Filter);
 
   for (auto &Function : Module->functions()) {
@@ -121,6 +227,7 @@ static void fixGlobals(llvm::Module &Module,
 }
 
 void LLVMContainer::mergeBackImpl(ThisType &&OtherContainer) {
+  materializeAll();
   llvm::Module *ToMerge = &OtherContainer.getModule();
   revng::verify(ToMerge);
 
@@ -188,6 +295,7 @@ void LLVMContainer::mergeBackImpl(ThisType &&OtherContainer) {
   }
 
   Module = std::move(OtherContainer.Module);
+  Caches.clear();
 
   // Checks that module merging commutes w.r.t. enumeration, as specified in
   // the first comment.
@@ -238,12 +346,68 @@ llvm::Error LLVMContainer::extractOne(llvm::raw_ostream &OS,
 }
 
 llvm::Error LLVMContainer::serialize(llvm::raw_ostream &OS) const {
-  getModule().print(OS, nullptr);
+  // Avoid materializing the module: load a separate copy of it instead
+  const llvm::Module *ToSerialize = Module.get();
+  std::unique_ptr<llvm::Module> Copy;
+  if (IsLazy and TextualIR) {
+    auto MaybeCopy = llvm::parseBitcodeFile(Bitcode->getMemBufferRef(),
+                                            Module->getContext());
+    if (not MaybeCopy)
+      return MaybeCopy.takeError();
+
+    Copy = std::move(MaybeCopy.get());
+    restoreFunctionAttachments(*Copy);
+    ToSerialize = Copy.get();
+  }
+
+  if (TextualIR) {
+    ToSerialize->print(OS, nullptr);
+    OS.flush();
+    return llvm::Error::success();
+  }
+
+  if (IsLazy) {
+    OS << Bitcode->getBuffer();
+    OS.flush();
+    return llvm::Error::success();
+  }
+
+  // The index is dropped right away, leaving the module as it was
+  saveFunctionAttachments(*Module);
+  llvm::WriteBitcodeToFile(*Module, OS);
+  Module->getNamedMetadata(LazyAttachmentsName)->eraseFromParent();
+
   OS.flush();
   return llvm::Error::success();
 }
 
 llvm::Error LLVMContainer::deserialize(const llvm::MemoryBuffer &Buffer) {
+  llvm::StringRef Data = Buffer.getBuffer();
+  if (not llvm::isBitcode(Data.bytes_begin(), Data.bytes_end()))
+    return deserializeTextualIR(Buffer);
+
+  // The lazily loaded module keeps referring to the buffer, make a copy
+  using llvm::MemoryBuffer;
+  llvm::StringRef Identifier = Buffer.getBufferIdentifier();
+  auto Owned = MemoryBuffer::getMemBufferCopy(Data, Identifier);
+  auto MaybeModule = llvm::getLazyBitcodeModule(Owned->getMemBufferRef(),
+                                                Module->getContext());
+  if (not MaybeModule)
+    return MaybeModule.takeError();
+
+  // Function bodies will be materialized, and verified, upon request. Drop the
+  // old module before the bitcode it might still refer to.
+  Module = std::move(MaybeModule.get());
+  Caches.clear();
+  Bitcode = std::move(Owned);
+  restoreFunctionAttachments(*Module);
+  IsLazy = true;
+
+  return llvm::Error::success();
+}
+
+llvm::Error
+LLVMContainer::deserializeTextualIR(const llvm::MemoryBuffer &Buffer) {
   llvm::SMDiagnostic Error;
   auto M = llvm::parseIR(Buffer, Error, Module->getContext());
   std::string ErrorMessage;
@@ -265,6 +429,9 @@ llvm::Error LLVMContainer::deserialize(const llvm::MemoryBuffer &Buffer) {
   }
 
   Module = std::move(M);
+  Caches.clear();
+  Bitcode.reset();
+  IsLazy = false;
 
   return llvm::Error::success();
 }
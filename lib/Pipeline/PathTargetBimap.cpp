@@ -0,0 +1,143 @@
+/// \file PathTargetBimap.cpp
+/// A many to many map between tuple tree paths and the targets reading them.
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+
+#include "revng/Pipeline/PathTargetBimap.h"
+#include "revng/Support/Assert.h"
+
+using namespace llvm;
+using namespace pipeline;
+
+PathTargetBimap::PathTargetBimap(const PathTargetBimap &Other) :
+  PathTargetBimap() {
+  Other.visit([this](const TupleTreePath &Path,
+                     ArrayRef<const TargetInContainer *> Readers) {
+    for (const TargetInContainer *Reader : Readers)
+      insert(*Reader, Path);
+  });
+}
+
+PathTargetBimap::TargetID
+PathTargetBimap::getOrCreateID(const TargetInContainer &Target) {
+  auto Iter = IDs.find(Target);
+  if (Iter != IDs.end())
+    return Iter->second;
+
+  TargetID ID;
+  if (not FreeIDs.empty()) {
+    ID = FreeIDs.back();
+    FreeIDs.pop_back();
+    Targets[ID] = Target;
+  } else {
+    ID = Targets.size();
+    Targets.emplace_back(Target);
+    ReverseMap.emplace_back();
+  }
+
+  IDs.emplace(Target, ID);
+  return ID;
+}
+
+const PathTargetBimap::Node *
+PathTargetBimap::lookup(const TupleTreePath &Path) const {
+  const Node *Current = Root.get();
+  for (const TupleTreeKeyWrapper &Key : Path.toArrayRef()) {
+    auto Iter = Current->Children.find(Key);
+    if (Iter == Current->Children.end())
+      return nullptr;
+    Current = Iter->second.get();
+  }
+  return Current;
+}
+
+void PathTargetBimap::insert(const TargetInContainer &TargetInContainer,
+                             const TupleTreePath &Path) {
+  TargetID ID = getOrCreateID(TargetInContainer);
+
+  Node *Current = Root.get();
+  for (const TupleTreeKeyWrapper &Key : Path.toArrayRef()) {
+    std::unique_ptr<Node> &Child = Current->Children[Key];
+    if (not Child)
+      Child = std::make_unique<Node>();
+    Current = Child.get();
+  }
+
+  auto &Readers = Current->Readers;
+  auto Position = lower_bound(Readers, ID);
+  if (Position != Readers.end() and *Position == ID)
+    return;
+
+  Readers.insert(Position, ID);
+  ReverseMap[ID].push_back(Current);
+}
+
+void PathTargetBimap::remove(const TargetsList &List,
+                             StringRef ContainerName) {
+  for (const Target &Target : List) {
+    TargetInContainer ToErase(Target, ContainerName.str());
+    auto Iter = IDs.find(ToErase);
+    if (Iter == IDs.end())
+      continue;
+
+    TargetID ID = Iter->second;
+
+    // Nodes left without readers are kept around: they are cheap and they
+    // will likely be populated again once the target is recomputed
+    for (Node *Reading : ReverseMap[ID]) {
+      auto &Readers = Reading->Readers;
+      auto Position = lower_bound(Readers, ID);
+      revng_assert(Position != Readers.end() and *Position == ID);
+      Readers.erase(Position);
+    }
+
+    ReverseMap[ID].clear();
+    Targets[ID].reset();
+    FreeIDs.push_back(ID);
+    IDs.erase(Iter);
+  }
+}
+
+void PathTargetBimap::merge(PathTargetBimap &&Other) {
+  if (empty()) {
+    *this = std::move(Other);
+    return;
+  }
+
+  Other.visit([this](const TupleTreePath &Path,
+                     ArrayRef<const TargetInContainer *> Readers) {
+    for (const TargetInContainer *Reader : Readers)
+      insert(*Reader, Path);
+  });
+}
+
+void
+PathTargetBimap::collectTargetsReading(ArrayRef<const TupleTreePath *> Paths,
+                                       ContainerToTargetsMap &Out) const {
+  // Gather the readers of all the paths first and deduplicate them, so that
+  // targets depending on many of the paths are only added to Out once
+  SmallVector<TargetID, 16> Found;
+  for (const TupleTreePath *Path : Paths)
+    if (const Node *Reading = lookup(*Path))
+      Found.append(Reading->Readers.begin(), Reading->Readers.end());
+
+  if (Found.empty())
+    return;
+
+  sort(Found);
+  Found.erase(std::unique(Found.begin(), Found.end()), Found.end());
+
+  StringMap<TargetsList::List> ByContainer;
+  for (TargetID ID : Found) {
+    const TargetInContainer &Reader = *Targets[ID];
+    ByContainer[Reader.getContainerName()].push_back(Reader.getTarget());
+  }
+
+  for (auto &Entry : ByContainer)
+    Out.add(Entry.first(), TargetsList(std::move(Entry.second)));
+}
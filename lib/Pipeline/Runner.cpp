@@ -5,11 +5,25 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <map>
+#include <thread>
+
+#include "llvm/ADT/IntEqClasses.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/Errors.h"
@@ -18,6 +32,7 @@
 #include "revng/Pipeline/Runner.h"
 #include "revng/Pipeline/Target.h"
 #include "revng/Support/Assert.h"
+#include "revng/Support/Fork.h"
 
 using namespace std;
 using namespace llvm;
@@ -374,11 +389,17 @@ Error Runner::run(llvm::StringRef EndingStepName,
     T2.advance("Clone and filter input containers", true);
 
     ::Step &Parent = Step->getPredecessor();
-    ContainerSet CurrentContainer = Parent.containers().cloneFiltered(Input);
-
-    // Run the step
-    T2.advance("Run the step", true);
-    Step->run(std::move(CurrentContainer));
+    if (Jobs > 1) {
+      T2.advance("Run the step in worker processes", true);
+      if (auto Error = runInWorkers(*Step, PredictedOutput, Input); Error)
+        return Error;
+    } else {
+      ContainerSet CurrentContainer = Parent.containers().cloneFiltered(Input);
+
+      // Run the step
+      T2.advance("Run the step", true);
+      Step->run(std::move(CurrentContainer));
+    }
 
     T2.advance("Extract the requested targets", true);
     if (VerifyLog.isEnabled()) {
@@ -402,6 +423,212 @@ Error Runner::run(llvm::StringRef EndingStepName,
   return Error::success();
 }
 
+/// Splits the targets that \p Step has to produce into groups that can be
+/// produced independently from each other and returns, for each group, the
+/// targets that have to be cloned from the predecessor step to produce it.
+///
+/// Two targets end up in the same group if the contracts of the pipes of the
+/// step deduce that producing one of them produces the other one as well, so
+/// that no target is produced by more than one group.
+static std::vector<ContainerToTargetsMap>
+splitIndependentGroups(const Step &Step, const ContainerToTargetsMap &Output) {
+  std::vector<ContainerToTargetsMap> Requirements;
+  std::map<std::pair<std::string, Target>, unsigned> Producers;
+  IntEqClasses Classes;
+
+  for (const auto &Entry : Output) {
+    for (const Target &Target : Entry.second) {
+      ContainerToTargetsMap Goal;
+      Goal.add(Entry.first(), Target);
+
+      // Skip targets that are already available in the step
+      ContainerToTargetsMap Required = Step.analyzeGoals(Goal);
+      if (Required.empty())
+        continue;
+
+      unsigned Index = Requirements.size();
+      Classes.grow(Index + 1);
+
+      for (const auto &Produced : Step.deduceResults(Required)) {
+        llvm::StringRef ProducedContainer = Produced.first();
+        for (const pipeline::Target &ProducedTarget : Produced.second) {
+          // Inputs preserved by the pipes are shared, not produced
+          if (Required.contains(ProducedContainer)
+              and Required.at(ProducedContainer).contains(ProducedTarget))
+            continue;
+
+          auto Key = std::make_pair(ProducedContainer.str(), ProducedTarget);
+          auto [Iterator, New] = Producers.try_emplace(std::move(Key), Index);
+          if (not New)
+            Classes.join(Iterator->second, Index);
+        }
+      }
+
+      Requirements.push_back(std::move(Required));
+    }
+  }
+
+  Classes.compress();
+
+  std::vector<ContainerToTargetsMap> Result(Classes.getNumClasses());
+  for (unsigned I = 0; I < Requirements.size(); ++I)
+    Result[Classes[I]].merge(Requirements[I]);
+
+  return Result;
+}
+
+/// Entry point of worker processes: produces the targets of \p Step that can
+/// be obtained from \p Input and stores them in \p Directory.
+[[noreturn]] static void runWorker(Step &Step,
+                                   const ContainerToTargetsMap &Input,
+                                   const revng::DirectoryPath &Directory) {
+  ContainerSet &Parent = Step.getPredecessor().containers();
+  ContainerSet Produced = Step.cloneAndRun(Parent.cloneFiltered(Input));
+
+  int ExitCode = EXIT_SUCCESS;
+  if (llvm::Error Error = Step.storeProduced(Produced, Directory); Error) {
+    llvm::logAllUnhandledErrors(std::move(Error), llvm::errs());
+    ExitCode = EXIT_FAILURE;
+  }
+
+  // Do not run destructors and atexit handlers of the parent process
+  llvm::outs().flush();
+  llvm::errs().flush();
+  _exit(ExitCode);
+}
+
+/// Waits for one of the processes in \p Running to terminate, without reaping
+/// other children of this process.
+///
+/// \return the identifier of the terminated process, or -1 in case of error,
+///         with errno set accordingly.
+static pid_t waitForWorker(const std::map<pid_t, size_t> &Running,
+                           int &Status) {
+  revng_assert(not Running.empty());
+
+  using namespace std::chrono_literals;
+  while (true) {
+    for (pid_t Worker : llvm::make_first_range(Running)) {
+      pid_t Completed = waitpid(Worker, &Status, WNOHANG);
+      if (Completed == Worker)
+        return Worker;
+
+      if (Completed < 0 and errno != EINTR)
+        return -1;
+    }
+
+    // Workers produce entire groups of targets: polling is not an issue
+    std::this_thread::sleep_for(10ms);
+  }
+}
+
+Error Runner::runInWorkers(Step &Step,
+                           const ContainerToTargetsMap &Output,
+                           const ContainerToTargetsMap &Input) {
+  std::vector<ContainerToTargetsMap> Groups = splitIndependentGroups(Step,
+                                                                     Output);
+
+  // Not worth spawning anything. Also, fork only duplicates the calling
+  // thread: if another thread is holding a lock (e.g., the daemon's), the
+  // workers could deadlock on it.
+  if (Groups.size() < 2 or not isSingleThreaded()) {
+    ContainerSet &Parent = Step.getPredecessor().containers();
+    Step.run(Parent.cloneFiltered(Input));
+    return Error::success();
+  }
+
+  // Pack the groups in batches. We create more batches than workers so that
+  // workers that complete early can pick up the remaining work.
+  constexpr size_t BatchesPerJob = 4;
+  size_t BatchesCount = std::min<size_t>(Groups.size(), Jobs * BatchesPerJob);
+  std::vector<ContainerToTargetsMap> Batches(BatchesCount);
+  for (size_t I = 0; I < Groups.size(); ++I)
+    Batches[I % BatchesCount].merge(Groups[I]);
+
+  SmallString<128> TemporaryPath;
+  if (auto EC = sys::fs::createUniqueDirectory("revng-pipeline-jobs",
+                                               TemporaryPath);
+      EC)
+    return createStringError(EC,
+                             "Could not create the directory for the workers");
+  auto Root = revng::DirectoryPath::fromLocalStorage(TemporaryPath);
+
+  const auto GetBatchDirectory = [&Root](size_t Index) {
+    return Root.getDirectory(std::to_string(Index));
+  };
+
+  Task T(Batches.size(), "Merge back the results of the workers");
+  Error Result = Error::success();
+  std::map<pid_t, size_t> Running;
+  size_t Next = 0;
+  while (Running.size() > 0 or (Next < Batches.size() and not Result)) {
+    // Keep up to Jobs workers busy, unless something already went wrong
+    while (Running.size() < Jobs and Next < Batches.size() and not Result) {
+      pid_t Worker = fork();
+      if (Worker < 0) {
+        Result = createStringError(std::error_code(errno,
+                                                   std::generic_category()),
+                                   "Could not spawn a worker process");
+        break;
+      }
+
+      if (Worker == 0)
+        runWorker(Step, Batches[Next], GetBatchDirectory(Next));
+
+      Running[Worker] = Next;
+      ++Next;
+    }
+
+    if (Running.empty())
+      break;
+
+    int Status = 0;
+    pid_t Completed = waitForWorker(Running, Status);
+    if (Completed < 0) {
+      // We can no longer track the workers: stop all of them
+      auto EC = std::error_code(errno, std::generic_category());
+      if (not Result)
+        Result = createStringError(EC, "Could not wait for the workers");
+
+      for (pid_t Worker : llvm::make_first_range(Running)) {
+        kill(Worker, SIGKILL);
+        while (waitpid(Worker, nullptr, 0) < 0 and errno == EINTR)
+          ;
+      }
+      Running.clear();
+      break;
+    }
+
+    auto It = Running.find(Completed);
+    revng_assert(It != Running.end());
+
+    size_t Index = It->second;
+    Running.erase(It);
+
+    if (Result)
+      continue;
+
+    if (not WIFEXITED(Status) or WEXITSTATUS(Status) != EXIT_SUCCESS) {
+      Result = createStringError(inconvertibleErrorCode(),
+                                 "Worker for batch %zu of step %s failed",
+                                 Index,
+                                 Step.getName().str().c_str());
+      continue;
+    }
+
+    // Merge back while other workers are still running
+    T.advance("Batch " + Twine(Index), true);
+    Result = Step.mergeBack(GetBatchDirectory(Index));
+  }
+
+  if (auto EC = sys::fs::remove_directories(TemporaryPath); EC and not Result)
+    Result = createStringError(EC,
+                               "Could not remove %s",
+                               TemporaryPath.c_str());
+
+  return Result;
+}
+
 Error Runner::invalidate(const TargetInStepSet &Invalidations) {
   for (const auto &Step : Invalidations) {
     llvm::StringRef StepName = Step.first();
@@ -437,7 +664,7 @@ const KindsRegistry &Runner::getKindsRegistry() const {
 
 void Runner::getDiffInvalidations(const GlobalTupleTreeDiff &Diff,
                                   TargetInStepSet &Map) const {
-
+  const auto Paths = Diff.getPaths();
   for (const Step &Step : llvm::drop_begin(*this)) {
     auto &StepInvalidations = Map[Step.getName()];
     for (const auto &Container : Step.containers()) {
@@ -457,9 +684,9 @@ void Runner::getDiffInvalidations(const GlobalTupleTreeDiff &Diff,
       }
     }
 
-    for (const TupleTreePath *Path : Diff.getPaths()) {
-      Step.registerTargetsDependingOn(Diff.getGlobalName(), *Path, Map);
-    }
+    // All the paths are looked up at once, so that the targets of the step are
+    // intersected with the content of the containers only once per diff
+    Step.registerTargetsDependingOn(Diff.getGlobalName(), Paths, Map);
   }
 }
 
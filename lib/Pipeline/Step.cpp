@@ -6,8 +6,13 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <numeric>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
 #include "llvm/Support/raw_ostream.h"
@@ -26,107 +31,108 @@ using namespace pipeline;
 
 namespace pipeline {
 
-class TargetInPipe {
+/// The invalidation metadata of a container with respect to a global, i.e.,
+/// for each pipe, which paths of the global have been read to produce each
+/// target in the container.
+///
+/// Paths are serialized once and then referred to by index.
+class ContainerInvalidationMetadata {
 public:
-  std::string SerializedTarget;
-  std::string PipeName;
-
-  llvm::Expected<llvm::SmallVector<TargetInContainer, 2>>
-  deserialize(const Context &Ctx, llvm::StringRef ContainerName) const;
+  struct TargetEntry {
+    std::string SerializedTarget;
+    /// Sorted indices in Paths
+    std::vector<uint64_t> ReadPaths;
+  };
 
-  static TargetInPipe fromTargetInContainer(const TargetInContainer &Target,
-                                            llvm::StringRef PipeName);
-  bool operator<(const TargetInPipe &Other) const {
-    const auto &Tied = std::tie(SerializedTarget, PipeName);
-    return Tied < std::tie(Other.SerializedTarget, Other.PipeName);
-  }
-};
+  struct PipeEntry {
+    std::string PipeName;
+    std::vector<TargetEntry> Targets;
+  };
 
-class ContainerInvalidationMetadata {
 public:
-  using ValueType = std::pair<pipeline::TargetInPipe, std::vector<std::string>>;
-  using Vector = std::vector<ValueType>;
-  Vector Data;
+  std::string GlobalName;
+  std::vector<std::string> Paths;
+  std::vector<PipeEntry> Pipes;
 
-  void merge(ContainerInvalidationMetadata &&Other) {
-    for (ValueType &Entry : Other.Data)
-      Data.emplace_back(std::move(Entry));
-  }
+private:
+  llvm::StringMap<uint64_t> PathIndices;
 
 public:
+  uint64_t getPathIndex(llvm::StringRef SerializedPath) {
+    auto [Iter, New] = PathIndices.try_emplace(SerializedPath, Paths.size());
+    if (New)
+      Paths.push_back(SerializedPath.str());
+    return Iter->second;
+  }
+
+  /// Record the targets in \p ContainerName produced by \p PipeName according
+  /// to \p Map.
+  void add(const PathTargetBimap &Map,
+           const Global &Global,
+           llvm::StringRef PipeName,
+           llvm::StringRef ContainerName);
+
   llvm::Expected<PathTargetBimap>
   deserialize(const Context &Ctx,
-              const Global &Primitives,
+              const Global &Global,
               llvm::StringRef PipeName,
               llvm::StringRef ContainerName) const;
+};
+
+using InvalidationMetadataList = std::vector<ContainerInvalidationMetadata>;
 
-  static ContainerInvalidationMetadata serialize(const PathTargetBimap &Map,
-                                                 const Global &Primitives,
-                                                 llvm::StringRef PipeName,
-                                                 llvm::StringRef ContainerName);
+/// The YAML format in which the invalidation metadata used to be stored. It's
+/// still accepted on load.
+class TargetInPipe {
+public:
+  std::string SerializedTarget;
+  std::string PipeName;
 };
 
-class NamedPathTargetBimapVector {
+class LegacyNamedInvalidationMetadata {
+public:
+  using ValueType = std::pair<TargetInPipe, std::vector<std::string>>;
+
 public:
   std::string GlobalName;
-  ContainerInvalidationMetadata Map;
+  std::vector<ValueType> Map;
 };
+
 } // namespace pipeline
 
-LLVM_YAML_IS_SEQUENCE_VECTOR(ContainerInvalidationMetadata::ValueType);
+LLVM_YAML_IS_SEQUENCE_VECTOR(LegacyNamedInvalidationMetadata::ValueType);
+LLVM_YAML_IS_SEQUENCE_VECTOR(pipeline::LegacyNamedInvalidationMetadata);
 
 namespace llvm {
 namespace yaml {
 
-// YAML traits for TargetInContainer
 template<>
-struct MappingTraits<pipeline::TargetInPipe> {
-  static void mapping(IO &IO, pipeline::TargetInPipe &TargetInContainer) {
-    IO.mapRequired("Target", TargetInContainer.SerializedTarget);
-    IO.mapRequired("PipeName", TargetInContainer.PipeName);
-  }
-};
-
-template<>
-struct MappingTraits<pipeline::ContainerInvalidationMetadata> {
-  static void mapping(IO &Io,
-                      pipeline::ContainerInvalidationMetadata &TargetMap) {
-    Io.mapRequired("Map", TargetMap.Data);
-  }
-};
-
-template<>
-struct MappingTraits<ContainerInvalidationMetadata::Vector::value_type> {
+struct MappingTraits<LegacyNamedInvalidationMetadata::ValueType> {
   static void
   mapping(IO &Io,
-          pipeline::ContainerInvalidationMetadata::Vector::value_type
-            &TargetMap) {
+          pipeline::LegacyNamedInvalidationMetadata::ValueType &TargetMap) {
     Io.mapRequired("Target", TargetMap.first.SerializedTarget);
     Io.mapRequired("PipeName", TargetMap.first.PipeName);
     Io.mapRequired("ReadPaths", TargetMap.second);
   }
 };
 
-} // namespace yaml
-} // namespace llvm
-
-LLVM_YAML_IS_SEQUENCE_VECTOR(pipeline::NamedPathTargetBimapVector);
-
-namespace llvm {
-namespace yaml {
 template<>
-struct MappingTraits<pipeline::NamedPathTargetBimapVector> {
-  static void mapping(IO &Io, pipeline::NamedPathTargetBimapVector &TargetMap) {
+struct MappingTraits<pipeline::LegacyNamedInvalidationMetadata> {
+  static void mapping(IO &Io,
+                      pipeline::LegacyNamedInvalidationMetadata &TargetMap) {
     Io.mapRequired("GlobalName", TargetMap.GlobalName);
-    Io.mapRequired("Map", TargetMap.Map.Data);
+    Io.mapRequired("Map", TargetMap.Map);
   }
 };
+
 } // namespace yaml
 } // namespace llvm
 
-llvm::Expected<llvm::SmallVector<TargetInContainer, 2>>
-TargetInPipe::deserialize(const Context &Ctx,
-                          llvm::StringRef ContainerName) const {
+static llvm::Expected<llvm::SmallVector<TargetInContainer, 2>>
+deserializeTarget(const Context &Ctx,
+                  llvm::StringRef SerializedTarget,
+                  llvm::StringRef ContainerName) {
   TargetsList Targets;
   llvm::Error Error = parseTarget(Ctx,
                                   SerializedTarget,
@@ -142,42 +148,47 @@ TargetInPipe::deserialize(const Context &Ctx,
   return Return;
 }
 
-TargetInPipe
-TargetInPipe::fromTargetInContainer(const TargetInContainer &Target,
-                                    llvm::StringRef PipeName) {
-  TargetInPipe ToReturn;
-  ToReturn.PipeName = PipeName;
-  ToReturn.SerializedTarget = Target.getTarget().serialize();
-
-  return ToReturn;
-}
-
-ContainerInvalidationMetadata
-ContainerInvalidationMetadata::serialize(const PathTargetBimap &Map,
-                                         const Global &Global,
-                                         llvm::StringRef PipeName,
-                                         llvm::StringRef ContainerName) {
-  ContainerInvalidationMetadata ToSerialize;
-  std::map<pipeline::TargetInPipe, std::vector<std::string>> TemporaryMap;
-
-  for (const auto &Content : Map) {
-    for (const TargetInContainer &Entry : Content.second) {
-      if (Entry.getContainerName() != ContainerName)
+void ContainerInvalidationMetadata::add(const PathTargetBimap &Map,
+                                        const Global &Global,
+                                        llvm::StringRef PipeName,
+                                        llvm::StringRef ContainerName) {
+  std::map<const TargetInContainer *, std::vector<uint64_t>> ReadByTarget;
+
+  Map.visit([&](const TupleTreePath &Path,
+                llvm::ArrayRef<const TargetInContainer *> Readers) {
+    std::optional<uint64_t> PathIndex;
+    for (const TargetInContainer *Reader : Readers) {
+      if (Reader->getContainerName() != ContainerName)
         continue;
 
-      std::optional<std::string> AsString = Global.serializePath(Content.first);
-      revng_check(AsString.has_value());
-      TemporaryMap[TargetInPipe::fromTargetInContainer(Entry, PipeName)]
-        .push_back(*AsString);
+      if (not PathIndex.has_value()) {
+        std::optional<std::string> AsString = Global.serializePath(Path);
+        revng_check(AsString.has_value());
+        PathIndex = getPathIndex(*AsString);
+      }
+
+      ReadByTarget[Reader].push_back(*PathIndex);
     }
-  }
+  });
+
+  if (ReadByTarget.empty())
+    return;
 
-  for (const auto &Content : TemporaryMap) {
-    std::pair ToEmplace{ Content.first, Content.second };
-    ToSerialize.Data.emplace_back(std::move(ToEmplace));
+  // Sort by the serialized target, so that the output is deterministic
+  std::map<std::string, std::vector<uint64_t>> Sorted;
+  for (auto &[Reader, ReadPaths] : ReadByTarget) {
+    std::vector<uint64_t> &Entry = Sorted[Reader->getTarget().serialize()];
+    Entry.insert(Entry.end(), ReadPaths.begin(), ReadPaths.end());
   }
 
-  return ToSerialize;
+  PipeEntry &Pipe = Pipes.emplace_back();
+  Pipe.PipeName = PipeName.str();
+  for (auto &[SerializedTarget, ReadPaths] : Sorted) {
+    llvm::sort(ReadPaths);
+    ReadPaths.erase(std::unique(ReadPaths.begin(), ReadPaths.end()),
+                    ReadPaths.end());
+    Pipe.Targets.push_back({ SerializedTarget, std::move(ReadPaths) });
+  }
 }
 
 llvm::Expected<PathTargetBimap>
@@ -188,28 +199,250 @@ ContainerInvalidationMetadata::deserialize(const Context &Ctx,
   const {
 
   PathTargetBimap ToReturn;
-  for (const ValueType &Entry : Data) {
-    if (Entry.first.PipeName != PipeName)
+
+  // Paths are shared among targets and pipes, parse each of them only once
+  std::vector<std::optional<TupleTreePath>> ParsedPaths(Paths.size());
+
+  for (const PipeEntry &Pipe : Pipes) {
+    if (Pipe.PipeName != PipeName)
       continue;
-    llvm::Expected<SmallVector<TargetInContainer>>
-      MaybeTarget = Entry.first.deserialize(Ctx, ContainerName);
-    if (not MaybeTarget)
-      return MaybeTarget.takeError();
-
-    for (auto &SerializedPath : Entry.second) {
-      std::optional<TupleTreePath>
-        MaybeParsedPath = Global.deserializePath(SerializedPath);
-      if (not MaybeParsedPath)
-        return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                       "could not parse " + SerializedPath);
-      for (const TargetInContainer &Path : *MaybeTarget)
-        ToReturn.insert(std::move(Path), std::move(*MaybeParsedPath));
+
+    for (const TargetEntry &Entry : Pipe.Targets) {
+      auto MaybeTargets = deserializeTarget(Ctx,
+                                            Entry.SerializedTarget,
+                                            ContainerName);
+      if (not MaybeTargets)
+        return MaybeTargets.takeError();
+
+      for (uint64_t Index : Entry.ReadPaths) {
+        revng_assert(Index < Paths.size());
+        std::optional<TupleTreePath> &Parsed = ParsedPaths[Index];
+        if (not Parsed.has_value()) {
+          Parsed = Global.deserializePath(Paths[Index]);
+          if (not Parsed.has_value())
+            return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                           "could not parse " + Paths[Index]);
+        }
+
+        for (const TargetInContainer &Target : *MaybeTargets)
+          ToReturn.insert(Target, *Parsed);
+      }
     }
   }
 
   return ToReturn;
 }
 
+/// Prefix of the binary encoding of the invalidation metadata. A YAML document
+/// cannot start with a NUL character, so this is never ambiguous.
+static constexpr auto BinaryMagic = StringLiteral::withInnerNUL("\0INV\1");
+
+namespace {
+
+class BinaryWriter {
+private:
+  raw_ostream &OS;
+
+public:
+  BinaryWriter(raw_ostream &OS) : OS(OS) {}
+
+public:
+  void write(uint64_t Value) { encodeULEB128(Value, OS); }
+
+  void write(StringRef String) {
+    write(String.size());
+    OS << String;
+  }
+};
+
+class BinaryReader {
+private:
+  DataExtractor Data;
+  DataExtractor::Cursor Cursor;
+
+public:
+  BinaryReader(StringRef Buffer) :
+    Data(Buffer, /* IsLittleEndian */ true, /* AddressSize */ 8), Cursor(0) {}
+
+public:
+  Error takeError() { return Cursor.takeError(); }
+
+  bool failed() { return not Cursor; }
+
+  uint64_t readInteger() { return Data.getULEB128(Cursor); }
+
+  std::string readString() {
+    uint64_t Size = readInteger();
+    return Data.getBytes(Cursor, Size).str();
+  }
+
+  bool consumeMagic() {
+    StringRef Magic = Data.getBytes(Cursor, BinaryMagic.size());
+    return Magic == BinaryMagic;
+  }
+};
+
+} // namespace
+
+/// Serialize \p ToStore in a compact binary format.
+///
+/// Paths are sorted and front-coded (each one is stored as the length of the
+/// prefix it shares with the previous one and the rest), and each target
+/// lists the indices of the paths it read as deltas.
+static void writeBinary(raw_ostream &OS,
+                        const InvalidationMetadataList &ToStore) {
+  BinaryWriter Writer(OS);
+
+  OS << BinaryMagic;
+  Writer.write(ToStore.size());
+  for (const ContainerInvalidationMetadata &Entry : ToStore) {
+    Writer.write(Entry.GlobalName);
+
+    const std::vector<std::string> &Paths = Entry.Paths;
+    std::vector<uint64_t> Order(Paths.size());
+    std::iota(Order.begin(), Order.end(), 0);
+    llvm::sort(Order, [&Paths](uint64_t LHS, uint64_t RHS) {
+      return Paths[LHS] < Paths[RHS];
+    });
+
+    std::vector<uint64_t> NewIndex(Paths.size());
+    for (uint64_t I = 0; I < Order.size(); ++I)
+      NewIndex[Order[I]] = I;
+
+    Writer.write(Paths.size());
+    StringRef Previous;
+    for (uint64_t Index : Order) {
+      StringRef Path = Paths[Index];
+      size_t Shared = 0;
+      size_t MaxShared = std::min(Previous.size(), Path.size());
+      while (Shared < MaxShared and Previous[Shared] == Path[Shared])
+        ++Shared;
+
+      Writer.write(Shared);
+      Writer.write(Path.drop_front(Shared));
+      Previous = Path;
+    }
+
+    Writer.write(Entry.Pipes.size());
+    for (const ContainerInvalidationMetadata::PipeEntry &Pipe : Entry.Pipes) {
+      Writer.write(Pipe.PipeName);
+      Writer.write(Pipe.Targets.size());
+      for (const auto &Target : Pipe.Targets) {
+        Writer.write(Target.SerializedTarget);
+
+        std::vector<uint64_t> ReadPaths;
+        ReadPaths.reserve(Target.ReadPaths.size());
+        for (uint64_t Index : Target.ReadPaths)
+          ReadPaths.push_back(NewIndex[Index]);
+        llvm::sort(ReadPaths);
+
+        Writer.write(ReadPaths.size());
+        uint64_t Last = 0;
+        for (uint64_t Index : ReadPaths) {
+          Writer.write(Index - Last);
+          Last = Index;
+        }
+      }
+    }
+  }
+}
+
+static llvm::Expected<InvalidationMetadataList>
+readBinary(StringRef Buffer) {
+  BinaryReader Reader(Buffer);
+  auto Malformed = [&Reader] {
+    consumeError(Reader.takeError());
+    return createStringError(inconvertibleErrorCode(),
+                             "Malformed invalidation metadata");
+  };
+
+  if (not Reader.consumeMagic()) {
+    if (auto Error = Reader.takeError())
+      return std::move(Error);
+    return Malformed();
+  }
+
+  InvalidationMetadataList Result;
+  uint64_t GlobalsCount = Reader.readInteger();
+  for (uint64_t I = 0; I < GlobalsCount and not Reader.failed(); ++I) {
+    ContainerInvalidationMetadata &Entry = Result.emplace_back();
+    Entry.GlobalName = Reader.readString();
+
+    uint64_t PathsCount = Reader.readInteger();
+    for (uint64_t J = 0; J < PathsCount and not Reader.failed(); ++J) {
+      uint64_t Shared = Reader.readInteger();
+      std::string Suffix = Reader.readString();
+      if (Shared > (J == 0 ? 0 : Entry.Paths.back().size()))
+        return Malformed();
+
+      std::string Path;
+      if (Shared != 0)
+        Path = Entry.Paths.back().substr(0, Shared);
+      Path += Suffix;
+      Entry.Paths.push_back(std::move(Path));
+    }
+
+    uint64_t PipesCount = Reader.readInteger();
+    for (uint64_t J = 0; J < PipesCount and not Reader.failed(); ++J) {
+      auto &Pipe = Entry.Pipes.emplace_back();
+      Pipe.PipeName = Reader.readString();
+
+      uint64_t TargetsCount = Reader.readInteger();
+      for (uint64_t K = 0; K < TargetsCount and not Reader.failed(); ++K) {
+        auto &Target = Pipe.Targets.emplace_back();
+        Target.SerializedTarget = Reader.readString();
+
+        uint64_t ReadCount = Reader.readInteger();
+        uint64_t Index = 0;
+        for (uint64_t L = 0; L < ReadCount and not Reader.failed(); ++L) {
+          Index += Reader.readInteger();
+          if (Index >= Entry.Paths.size())
+            return Malformed();
+          Target.ReadPaths.push_back(Index);
+        }
+      }
+    }
+  }
+
+  if (auto Error = Reader.takeError())
+    return std::move(Error);
+
+  return Result;
+}
+
+static llvm::Expected<InvalidationMetadataList>
+readInvalidationMetadata(StringRef Buffer) {
+  if (Buffer.startswith(BinaryMagic))
+    return readBinary(Buffer);
+
+  using LegacyType = llvm::SmallVector<LegacyNamedInvalidationMetadata, 2>;
+  auto Parsed = ::deserialize<LegacyType>(Buffer);
+  if (not Parsed)
+    return Parsed.takeError();
+
+  InvalidationMetadataList Result;
+  for (LegacyNamedInvalidationMetadata &Legacy : *Parsed) {
+    ContainerInvalidationMetadata &Entry = Result.emplace_back();
+    Entry.GlobalName = std::move(Legacy.GlobalName);
+
+    llvm::StringMap<size_t> PipeIndices;
+    for (auto &[Target, ReadPaths] : Legacy.Map) {
+      auto [Iter, New] = PipeIndices.try_emplace(Target.PipeName,
+                                                 Entry.Pipes.size());
+      if (New)
+        Entry.Pipes.emplace_back().PipeName = Target.PipeName;
+
+      auto &Pipe = Entry.Pipes[Iter->second];
+      auto &NewTarget = Pipe.Targets.emplace_back();
+      NewTarget.SerializedTarget = std::move(Target.SerializedTarget);
+      for (const std::string &Path : ReadPaths)
+        NewTarget.ReadPaths.push_back(Entry.getPathIndex(Path));
+    }
+  }
+
+  return Result;
+}
+
 ContainerToTargetsMap
 Step::analyzeGoals(const ContainerToTargetsMap &RequiredGoals) const {
 
@@ -272,9 +505,22 @@ void Step::explainExecutedPipe(const InvokableWrapperBase &Wrapper,
 
 ContainerSet Step::run(ContainerSet &&Input) {
   ContainerToTargetsMap InputEnumeration = Input.enumerate();
-  explainStartStep(InputEnumeration);
 
-  Task T(Pipes.size() + 1, "Step " + getName());
+  Task T(2, "Step " + getName());
+  T.advance("Run the pipes", true);
+  ContainerSet Produced = cloneAndRun(std::move(Input));
+
+  T.advance("Merging back", true);
+  Containers.mergeBack(std::move(Produced));
+  InputEnumeration = deduceResults(InputEnumeration);
+  ContainerSet Cloned = Containers.cloneFiltered(InputEnumeration);
+  return Cloned;
+}
+
+ContainerSet Step::cloneAndRun(ContainerSet &&Input) {
+  explainStartStep(Input.enumerate());
+
+  Task T(Pipes.size(), "Pipes of step " + getName());
   for (PipeWrapper &Pipe : Pipes) {
     T.advance(Pipe.Pipe->getName(), false);
     explainExecutedPipe(*Pipe.Pipe);
@@ -283,12 +529,8 @@ ContainerSet Step::run(ContainerSet &&Input) {
     llvm::cantFail(Input.verify());
   }
 
-  T.advance("Merging back", true);
   explainEndStep(Input.enumerate());
-  Containers.mergeBack(std::move(Input));
-  InputEnumeration = deduceResults(InputEnumeration);
-  ContainerSet Cloned = Containers.cloneFiltered(InputEnumeration);
-  return Cloned;
+  return std::move(Input);
 }
 
 llvm::Error Step::runAnalysis(llvm::StringRef AnalysisName,
@@ -383,6 +625,33 @@ Error Step::load(const revng::DirectoryPath &DirPath) {
   return loadInvalidationMetadata(DirPath);
 }
 
+Error Step::storeProduced(const ContainerSet &Produced,
+                          const revng::DirectoryPath &DirPath) const {
+  if (auto Error = DirPath.create(); Error)
+    return Error;
+
+  if (auto Error = Produced.store(DirPath))
+    return Error;
+
+  return storeInvalidationMetadata(DirPath);
+}
+
+Error Step::mergeBack(const revng::DirectoryPath &DirPath) {
+  ContainerSet Loaded = Containers.cloneFiltered(ContainerToTargetsMap());
+  if (auto Error = Loaded.load(DirPath))
+    return Error;
+
+  Containers.mergeBack(std::move(Loaded));
+
+  // Unlike loadInvalidationMetadata, we do not reset the metadata we already
+  // have, the loaded entries are merged with it
+  for (auto &Container : Containers)
+    if (llvm::Error Error = loadInvalidationMetadataImpl(DirPath, Container))
+      return Error;
+
+  return llvm::Error::success();
+}
+
 llvm::Error
 Step::loadInvalidationMetadataImpl(const revng::DirectoryPath &Path,
                                    ContainerSet::value_type &Container) {
@@ -398,18 +667,17 @@ Step::loadInvalidationMetadataImpl(const revng::DirectoryPath &Path,
   if (not File)
     return File.takeError();
 
-  using Type = llvm::SmallVector<NamedPathTargetBimapVector, 2>;
-  auto Parsed = ::deserialize<Type>(File.get()->buffer().getBuffer());
+  auto Parsed = readInvalidationMetadata(File.get()->buffer().getBuffer());
   if (not Parsed)
     return Parsed.takeError();
 
   for (PipeWrapper &Pipe : Pipes) {
-    for (NamedPathTargetBimapVector &Entry : *Parsed) {
+    for (ContainerInvalidationMetadata &Entry : *Parsed) {
       Global *Global = llvm::cantFail(Ctx->getGlobals().get(Entry.GlobalName));
-      auto Parsed(Entry.Map.deserialize(*Ctx,
-                                        *Global,
-                                        Pipe.Pipe->getName(),
-                                        Container.first()));
+      auto Parsed(Entry.deserialize(*Ctx,
+                                    *Global,
+                                    Pipe.Pipe->getName(),
+                                    Container.first()));
       if (not Parsed)
         return Parsed.takeError();
       Pipe.InvalidationMetadata.getPathCache(Global->getName())
@@ -438,11 +706,10 @@ Step::storeInvalidationMetadata(const revng::DirectoryPath &Path) const {
     if (Container.second == nullptr)
       continue;
 
-    using Type = llvm::SmallVector<NamedPathTargetBimapVector, 2>;
-    Type ToStore = {};
+    InvalidationMetadataList ToStore;
 
     for (const Global *Global : Ctx->getGlobals()) {
-      NamedPathTargetBimapVector Entry;
+      ContainerInvalidationMetadata Entry;
       Entry.GlobalName = Global->getName();
 
       for (const PipeWrapper &Pipe : Pipes) {
@@ -450,23 +717,21 @@ Step::storeInvalidationMetadata(const revng::DirectoryPath &Path) const {
         if (PathCache.count(Entry.GlobalName) == 0)
           continue;
 
-        using MetadataType = ContainerInvalidationMetadata;
-        auto Serialize = MetadataType::serialize;
-        MetadataType Serialized = Serialize(Pipe.InvalidationMetadata
-                                              .getPathCache(Entry.GlobalName),
-                                            *Global,
-                                            Pipe.Pipe->getName(),
-                                            Container.first());
-        Entry.Map.merge(std::move(Serialized));
+        Entry.add(Pipe.InvalidationMetadata.getPathCache(Entry.GlobalName),
+                  *Global,
+                  Pipe.Pipe->getName(),
+                  Container.first());
       }
-      ToStore.emplace_back(std::move(Entry));
+
+      if (not Entry.Pipes.empty())
+        ToStore.emplace_back(std::move(Entry));
     }
 
     auto File = Path.getFile(Container.first().str() + ".cache")
                   .getWritableFile();
     if (not File)
       return File.takeError();
-    ::serialize(File->get()->os(), ToStore);
+    writeBinary(File->get()->os(), ToStore);
     if (auto Error = File->get()->commit())
       return Error;
   }
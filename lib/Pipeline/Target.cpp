@@ -6,7 +6,13 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <array>
+#include <memory>
+#include <mutex>
+
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
 
 #include "revng/Pipeline/Container.h"
@@ -20,14 +26,86 @@ using namespace pipeline;
 using namespace std;
 using namespace llvm;
 
+namespace {
+
+struct InternerShard {
+  std::mutex Mutex;
+  llvm::StringMap<TargetPathInterner::Entry> Entries;
+};
+
+} // namespace
+
+static constexpr unsigned ShardCount = 64;
+
+static std::array<InternerShard, ShardCount> &shards() {
+  // Never destroyed: targets in static storage might outlive it
+  static auto *Shards = new std::array<InternerShard, ShardCount>;
+  return *Shards;
+}
+
+const TargetPathInterner::Entry *
+TargetPathInterner::intern(PathComponents &&Components) {
+  // Terminate each component, so that, e.g., {} and {""} get different keys
+  std::string Key;
+  for (const std::string &Component : Components) {
+    Key += Component;
+    Key += '\0';
+  }
+
+  unsigned Index = llvm::hash_value(Key) % ShardCount;
+  InternerShard &Shard = shards()[Index];
+
+  std::lock_guard Guard(Shard.Mutex);
+  auto [It, New] = Shard.Entries.try_emplace(Key);
+  Entry &Result = It->second;
+  if (New) {
+    Result.Components = std::move(Components);
+    Result.Key = It->first();
+    Result.Shard = Index;
+  }
+
+  // Taking the reference under the lock prevents releaseLast from freeing the
+  // entry in the meantime
+  Result.References.fetch_add(1, std::memory_order_relaxed);
+  return &Result;
+}
+
+void TargetPathInterner::releaseLast(const Entry *Path) {
+  InternerShard &Shard = shards()[Path->Shard];
+
+  std::lock_guard Guard(Shard.Mutex);
+  if (Path->References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    Shard.Entries.erase(Path->Key);
+}
+
 bool TargetsList::contains(const Target &Target) const {
-  return find(*this, Target) != end();
+  return std::binary_search(begin(), end(), Target);
+}
+
+void TargetsList::push_back(const Target &Target) {
+  // Targets are often produced in order, in which case this is an append
+  if (Contained.empty() or Contained.back() < Target) {
+    Contained.push_back(Target);
+    return;
+  }
+
+  auto It = llvm::lower_bound(Contained, Target);
+  if (Target < *It)
+    Contained.insert(It, Target);
 }
 
 void TargetsList::merge(const TargetsList &Source) {
-  copy(Source, back_inserter(Contained));
-  llvm::sort(Contained);
-  Contained.erase(unique(Contained.begin(), Contained.end()), Contained.end());
+  if (Source.empty())
+    return;
+
+  List Merged;
+  Merged.reserve(Contained.size() + Source.size());
+  std::set_union(Contained.begin(),
+                 Contained.end(),
+                 Source.begin(),
+                 Source.end(),
+                 back_inserter(Merged));
+  Contained = std::move(Merged);
 }
 
 void ContainerToTargetsMap::merge(const ContainerToTargetsMap &Other) {
@@ -43,19 +121,24 @@ void ContainerToTargetsMap::merge(const ContainerToTargetsMap &Other) {
 // NOTE: this operator needs to be stable w.r.t. library load order and memory
 // layout
 int Target::operator<=>(const Target &Other) const {
+  if (*this == Other)
+    return 0;
+
   if (K->id() < Other.K->id())
     return -1;
   if (K->id() > Other.K->id())
     return 1;
 
-  if (Components.size() != Other.Components.size()) {
-    if (Components.size() > Other.Components.size())
+  const PathComponents &Components = getPathComponents();
+  const PathComponents &OtherComponents = Other.getPathComponents();
+  if (Components.size() != OtherComponents.size()) {
+    if (Components.size() > OtherComponents.size())
       return -1;
-    if (Components.size() < Other.Components.size())
+    if (Components.size() < OtherComponents.size())
       return 1;
   }
 
-  for (const auto &[l, r] : zip(Components, Other.Components)) {
+  for (const auto &[l, r] : zip(Components, OtherComponents)) {
     if (l < r)
       return -1;
     if (l > r)
@@ -67,6 +150,7 @@ int Target::operator<=>(const Target &Other) const {
 
 std::string Target::serialize() const {
   std::string ToReturn;
+  const PathComponents &Components = getPathComponents();
 
   if (Components.size() == 0) {
     return ":" + K->name().str();
@@ -18,7 +18,8 @@ namespace revng::pipes {
 template<bool commit>
 static llvm::Error applyDiffImpl(pipeline::ExecutionContext &Ctx,
                                  std::string DiffGlobalName,
-                                 std::string DiffContent) {
+                                 std::string DiffContent,
+                                 bool FullVerification) {
   if (DiffGlobalName.empty()) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "global-name must be set");
@@ -41,7 +42,11 @@ static llvm::Error applyDiffImpl(pipeline::ExecutionContext &Ctx,
   if (auto ApplyError = GlobalClone->applyDiff(Diff); ApplyError)
     return ApplyError;
 
-  if (not GlobalClone->verify()) {
+  // The global verified before the diff, there's no need to verify again
+  // what's not affected by it
+  bool Verified = FullVerification ? GlobalClone->verify() :
+                                     GlobalClone->verify(Diff);
+  if (not Verified) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "could not verify %s",
                                    DiffGlobalName.c_str());
@@ -56,14 +61,22 @@ static llvm::Error applyDiffImpl(pipeline::ExecutionContext &Ctx,
 
 llvm::Error ApplyDiffAnalysis::run(pipeline::ExecutionContext &Ctx,
                                    std::string DiffGlobalName,
-                                   std::string DiffContent) {
-  return applyDiffImpl<true>(Ctx, DiffGlobalName, DiffContent);
+                                   std::string DiffContent,
+                                   int FullVerification) {
+  return applyDiffImpl<true>(Ctx,
+                             DiffGlobalName,
+                             DiffContent,
+                             FullVerification != 0);
 }
 
 llvm::Error VerifyDiffAnalysis::run(pipeline::ExecutionContext &Ctx,
                                     std::string DiffGlobalName,
-                                    std::string DiffContent) {
-  return applyDiffImpl<false>(Ctx, DiffGlobalName, DiffContent);
+                                    std::string DiffContent,
+                                    int FullVerification) {
+  return applyDiffImpl<false>(Ctx,
+                              DiffGlobalName,
+                              DiffContent,
+                              FullVerification != 0);
 }
 
 template<bool commit>
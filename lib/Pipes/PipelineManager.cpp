@@ -38,6 +38,12 @@ static cl::opt<bool> CheckComponentsVersion("check-components-version",
                                                      "don't match"),
                                             cl::init(false));
 
+static cl::opt<bool> BinaryModelStorage("binary-model-storage",
+                                        cl::desc("Store the model in the "
+                                                 "execution directory in "
+                                                 "binary form"),
+                                        cl::init(false));
+
 class LoadModelPipePass {
 private:
   ModelWrapper Wrapper;
@@ -64,6 +70,10 @@ static Context setUpContext(LLVMContext &Context) {
   class Context Ctx;
 
   Ctx.addGlobal<revng::ModelGlobal>(ModelName);
+  if (BinaryModelStorage) {
+    auto *Model = cantFail(Ctx.getGlobal<revng::ModelGlobal>(ModelName));
+    Model->setStorageFormat(TupleTreeFormat::Binary);
+  }
   Ctx.addExternalContext("LLVMContext", Context);
   return Ctx;
 }
@@ -452,6 +462,13 @@ llvm::Error PipelineManager::produceAllPossibleTargets(bool ExpandTargets) {
   recalculateAllPossibleTargets(ExpandTargets);
 
   for (const auto &Step : CurrentState) {
+    // Producing the targets one at a time would leave no room to the workers
+    if (Runner->getJobs() > 1) {
+      if (auto Error = Runner->run(Step.first(), Step.second); Error)
+        return Error;
+      continue;
+    }
+
     for (const auto &Container : Step.second) {
       for (const auto &Target : Container.second) {
         ContainerToTargetsMap ToProduce;
@@ -5,20 +5,34 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <deque>
 #include <fstream>
+#include <future>
+#include <set>
+#include <sstream>
 
 #include "aws/core/Aws.h"
 #include "aws/core/auth/AWSCredentials.h"
 #include "aws/core/auth/AWSCredentialsProvider.h"
 #include "aws/core/utils/logging/FormattedLogSystem.h"
 #include "aws/s3/S3Client.h"
+#include "aws/s3/model/AbortMultipartUploadRequest.h"
+#include "aws/s3/model/CompleteMultipartUploadRequest.h"
+#include "aws/s3/model/CompletedMultipartUpload.h"
+#include "aws/s3/model/CompletedPart.h"
 #include "aws/s3/model/CopyObjectRequest.h"
+#include "aws/s3/model/CreateMultipartUploadRequest.h"
 #include "aws/s3/model/DeleteObjectRequest.h"
 #include "aws/s3/model/GetObjectRequest.h"
 #include "aws/s3/model/HeadObjectRequest.h"
 #include "aws/s3/model/PutObjectRequest.h"
+#include "aws/s3/model/UploadPartRequest.h"
 
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/YAMLTraits.h"
 
 #include "revng/Storage/Path.h"
@@ -88,6 +102,26 @@ void initializeSDK() {
 
 } // namespace
 
+static llvm::cl::opt<unsigned> TransferThreads("s3-transfer-threads",
+                                               llvm::cl::desc("Number of "
+                                                              "concurrent S3 "
+                                                              "transfers."),
+                                               llvm::cl::init(8));
+
+static llvm::cl::opt<unsigned> PartSizeMiB("s3-part-size",
+                                           llvm::cl::desc("Size, in MiB, of "
+                                                          "the parts of S3 "
+                                                          "multipart uploads "
+                                                          "and ranged "
+                                                          "downloads."),
+                                           llvm::cl::init(16));
+
+/// S3 rejects multipart uploads with parts (except the last one) smaller than
+/// 5 MiB
+static uint64_t partSize() {
+  return std::max<uint64_t>(PartSizeMiB, 5) * 1024 * 1024;
+}
+
 namespace revng {
 
 static llvm::StringRef consumeSplit(llvm::StringRef &Input, char SplitChar) {
@@ -157,52 +191,262 @@ public:
   llvm::MemoryBuffer &buffer() override { return *Buffer; };
 };
 
-class S3WritableFile : public WritableFile {
+/// Stream uploading its content to S3 while it's being written
+///
+/// Data is accumulated in memory up to the part size. If the whole content
+/// fits in a single part, it's uploaded in the background with a single
+/// PutObject upon commit. Otherwise, a multipart upload is started and each
+/// part is uploaded in the background as soon as it's full, keeping in memory
+/// only a bounded number of parts per file.
+class S3UploadStream : public llvm::raw_pwrite_stream {
+private:
+  /// The outcome of the upload of a part: its ETag or an error message
+  struct PartOutcome {
+    int Number = 0;
+    Aws::String ETag;
+    std::string Error;
+  };
+
 private:
-  TemporaryFile TempFile;
-  std::unique_ptr<llvm::raw_fd_ostream> OS;
-  std::string Path;
-  ContentEncoding Encoding;
   S3StorageClient &Client;
+  std::string Key;
+  ContentEncoding Encoding;
+
+  /// The part being filled
+  std::string Part;
+  /// Number of bytes handed over to previous parts
+  uint64_t Uploaded = 0;
+
+  Aws::String UploadID;
+  /// Parts being uploaded, in order
+  std::deque<std::shared_future<PartOutcome>> InFlight;
+  Aws::Vector<Aws::S3::Model::CompletedPart> CompletedParts;
+  std::string Error;
+
+  /// Set when the stream is destroyed without having been committed: from
+  /// then on, written data is dropped
+  bool Discarded = false;
 
 public:
-  S3WritableFile(TemporaryFile &&TempFile,
-                 std::unique_ptr<llvm::raw_fd_ostream> &&OS,
-                 llvm::StringRef Path,
-                 ContentEncoding Encoding,
-                 S3StorageClient &Client) :
-    TempFile(std::move(TempFile)),
-    OS(std::move(OS)),
-    Path(Path.str()),
-    Encoding(Encoding),
-    Client(Client) {}
+  S3UploadStream(S3StorageClient &Client,
+                 llvm::StringRef Key,
+                 ContentEncoding Encoding) :
+    Client(Client), Key(Key.str()), Encoding(Encoding) {}
+
+  ~S3UploadStream() override {
+    // The file has not been committed (or the commit failed): drop whatever is
+    // still buffered instead of uploading it. raw_ostream requires the buffer
+    // to be empty upon destruction.
+    Discarded = true;
+    flush();
+
+    // Make sure no part references this object after it's gone
+    collectParts(0);
+    abortUpload();
+  }
 
-  llvm::raw_pwrite_stream &os() override { return *OS; }
-  llvm::Error commit() override {
-    OS->flush();
+public:
+  /// Finalize the upload, small files are uploaded in the background
+  llvm::Error commit() {
+    flush();
+
+    if (UploadID.empty() and Error.empty()) {
+      using std::ios_base;
+      auto Body = std::make_shared<std::stringstream>(std::move(Part),
+                                                      ios_base::in
+                                                        | ios_base::binary);
+      Part.clear();
+
+      auto &S3 = Client.Client;
+      Aws::S3::Model::PutObjectRequest Request;
+      Request.SetBucket(Client.Bucket);
+      Request.SetKey(Key);
+      if (Encoding == ContentEncoding::Gzip)
+        Request.SetContentEncoding("gzip");
+      Request.SetBody(Body);
+
+      Client.uploadInBackground(Key, [&S3, Request = std::move(Request)]() {
+        auto Result = S3.PutObject(Request);
+        if (Result.IsSuccess())
+          return std::string();
+        return std::string("Upload of ") + Request.GetKey().c_str()
+               + " failed: " + Result.GetError().GetMessage().c_str();
+      });
+      return llvm::Error::success();
+    }
+
+    if (Error.empty() and not Part.empty())
+      uploadPart();
+    collectParts(0);
+
+    if (not Error.empty()) {
+      abortUpload();
+      return llvm::createStringError(llvm::inconvertibleErrorCode(), Error);
+    }
+
+    Aws::S3::Model::CompletedMultipartUpload Parts;
+    Parts.SetParts(std::move(CompletedParts));
 
-    Aws::S3::Model::PutObjectRequest Request;
+    Aws::S3::Model::CompleteMultipartUploadRequest Request;
     Request.SetBucket(Client.Bucket);
+    Request.SetKey(Key);
+    Request.SetUploadId(UploadID);
+    Request.SetMultipartUpload(std::move(Parts));
+    auto Result = Client.Client.CompleteMultipartUpload(Request);
+    if (not Result.IsSuccess()) {
+      abortUpload();
+      return toError(Result);
+    }
 
-    if (Encoding == ContentEncoding::Gzip)
-      Request.SetContentEncoding("gzip");
+    UploadID.clear();
+    return llvm::Error::success();
+  }
 
-    std::string NewFilename = generateNewFilename(Path);
-    Request.SetKey(Client.resolvePath(NewFilename));
+private:
+  void write_impl(const char *Ptr, size_t Size) override {
+    if (Discarded)
+      return;
+
+    const uint64_t PartSize = partSize();
+    while (Size > 0) {
+      if (Part.capacity() < PartSize)
+        Part.reserve(PartSize);
+
+      size_t Chunk = std::min<uint64_t>(Size, PartSize - Part.size());
+      Part.append(Ptr, Chunk);
+      Ptr += Chunk;
+      Size -= Chunk;
+
+      if (Part.size() == PartSize)
+        uploadPart();
+    }
+  }
 
-    auto File = std::make_shared<Aws::FStream>(TempFile.path().str(),
-                                               std::ios_base::in
-                                                 | std::ios_base::binary);
-    if (File->fail()) {
-      return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                     "Could not open temporary file");
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override {
+    flush();
+    if (Discarded)
+      return;
+
+    // Parts that have been handed over can no longer be changed: fail the
+    // upload, commit will report the error
+    if (Offset < Uploaded or Offset + Size > Uploaded + Part.size()) {
+      if (Error.empty())
+        Error = "Cannot rewrite data of " + Key
+                + " that has already been uploaded";
+      return;
     }
 
-    Request.SetBody(File);
-    Aws::S3::Model::PutObjectOutcome Result = Client.Client.PutObject(Request);
-    if (not Result.IsSuccess())
-      return toError(Result);
+    std::copy(Ptr, Ptr + Size, Part.data() + (Offset - Uploaded));
+  }
+
+  uint64_t current_pos() const override { return Uploaded + Part.size(); }
+
+private:
+  void uploadPart() {
+    uint64_t Size = Part.size();
+    auto Body = std::make_shared<std::stringstream>(std::move(Part),
+                                                    std::ios_base::in
+                                                      | std::ios_base::binary);
+    Part = std::string();
+    Uploaded += Size;
+
+    // After a failure, drop everything: commit will report the error
+    if (not Error.empty())
+      return;
+
+    if (UploadID.empty()) {
+      Aws::S3::Model::CreateMultipartUploadRequest Request;
+      Request.SetBucket(Client.Bucket);
+      Request.SetKey(Key);
+      if (Encoding == ContentEncoding::Gzip)
+        Request.SetContentEncoding("gzip");
+
+      auto Result = Client.Client.CreateMultipartUpload(Request);
+      if (not Result.IsSuccess()) {
+        Error = Result.GetError().GetMessage().c_str();
+        return;
+      }
+
+      UploadID = Result.GetResult().GetUploadId();
+    }
+
+    int Number = CompletedParts.size() + InFlight.size() + 1;
+    Aws::S3::Model::UploadPartRequest Request;
+    Request.SetBucket(Client.Bucket);
+    Request.SetKey(Key);
+    Request.SetUploadId(UploadID);
+    Request.SetPartNumber(Number);
+    Request.SetContentLength(Size);
+    Request.SetBody(Body);
+
+    auto &S3 = Client.Client;
+    InFlight.push_back(Client.pool().async([&S3, Number, Request]() {
+      PartOutcome Outcome{ .Number = Number };
+      auto Result = S3.UploadPart(Request);
+      if (Result.IsSuccess())
+        Outcome.ETag = Result.GetResult().GetETag();
+      else
+        Outcome.Error = Result.GetError().GetMessage().c_str();
+      return Outcome;
+    }));
+
+    // Bound the memory used by each file
+    collectParts(TransferThreads);
+  }
+
+  /// Wait for in-flight parts until there are at most \p MaxInFlight left
+  void collectParts(size_t MaxInFlight) {
+    while (InFlight.size() > MaxInFlight) {
+      const PartOutcome &Outcome = InFlight.front().get();
+      if (not Outcome.Error.empty() and Error.empty())
+        Error = Outcome.Error;
+
+      Aws::S3::Model::CompletedPart Completed;
+      Completed.SetPartNumber(Outcome.Number);
+      Completed.SetETag(Outcome.ETag);
+      CompletedParts.push_back(std::move(Completed));
+
+      InFlight.pop_front();
+    }
+  }
 
+  void abortUpload() {
+    if (UploadID.empty())
+      return;
+
+    Aws::S3::Model::AbortMultipartUploadRequest Request;
+    Request.SetBucket(Client.Bucket);
+    Request.SetKey(Key);
+    Request.SetUploadId(UploadID);
+    // Best effort: at worst the bucket lifecycle will collect the parts
+    Client.Client.AbortMultipartUpload(Request);
+    UploadID.clear();
+  }
+};
+
+class S3WritableFile : public WritableFile {
+private:
+  std::string Path;
+  std::string NewFilename;
+  S3StorageClient &Client;
+  S3UploadStream OS;
+
+public:
+  S3WritableFile(llvm::StringRef Path,
+                 ContentEncoding Encoding,
+                 S3StorageClient &Client) :
+    Path(Path.str()),
+    NewFilename(generateNewFilename(Path)),
+    Client(Client),
+    OS(Client, Client.resolvePath(NewFilename), Encoding) {}
+
+  llvm::raw_pwrite_stream &os() override { return OS; }
+  llvm::Error commit() override {
+    if (auto Error = OS.commit())
+      return Error;
+
+    // The actual upload might still be in progress: StorageClient::commit and
+    // any read will wait for it
     Client.FilenameMap[Path] = NewFilename;
     return llvm::Error::success();
   }
@@ -348,19 +592,26 @@ llvm::Error S3StorageClient::copy(llvm::StringRef Source,
 llvm::Expected<std::unique_ptr<ReadableFile>>
 S3StorageClient::getReadableFile(llvm::StringRef Path) {
   using llvm::MemoryBuffer;
+  namespace fs = llvm::sys::fs;
   if (FilenameMap.count(Path) == 0) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "File %s does not exist",
                                    Path.str().c_str());
   }
 
-  Aws::S3::Model::GetObjectRequest Request;
-  Request.SetBucket(Bucket);
-  Request.SetKey(resolvePath(FilenameMap[Path]));
+  // The file might have been written and not uploaded yet
+  if (auto Error = waitForUploads())
+    return Error;
 
-  Aws::S3::Model::GetObjectOutcome Result = Client.GetObject(Request);
-  if (not Result.IsSuccess())
-    return toError(Result);
+  std::string Key = resolvePath(FilenameMap[Path]);
+
+  Aws::S3::Model::HeadObjectRequest HeadRequest;
+  HeadRequest.SetBucket(Bucket);
+  HeadRequest.SetKey(Key);
+  Aws::S3::Model::HeadObjectOutcome Head = Client.HeadObject(HeadRequest);
+  if (not Head.IsSuccess())
+    return toError(Head);
+  uint64_t Size = Head.GetResult().GetContentLength();
 
   auto MaybeTemporary = TemporaryFile::make("revng-s3-storage");
   if (!MaybeTemporary) {
@@ -368,25 +619,72 @@ S3StorageClient::getReadableFile(llvm::StringRef Path) {
                                    "Could not create temporary file");
   }
 
-  std::ofstream OS(MaybeTemporary->path().str(), std::ios::binary);
-  if (OS.fail()) {
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Could not open temporary file");
-  }
+  if (Size > 0) {
+    int FD = -1;
+    if (auto EC = fs::openFileForReadWrite(MaybeTemporary->path(),
+                                           FD,
+                                           fs::CD_OpenExisting,
+                                           fs::OF_None))
+      return llvm::createStringError(EC, "Could not open temporary file");
+
+    fs::file_t File = fs::convertFDToNativeFile(FD);
+    std::error_code EC = fs::resize_file(FD, Size);
+    std::optional<fs::mapped_file_region> Region;
+    if (not EC)
+      Region.emplace(File, fs::mapped_file_region::readwrite, Size, 0, EC);
+    fs::closeFile(File);
+    if (EC)
+      return llvm::createStringError(EC, "Could not map temporary file");
+
+    // Download the object in ranges of the part size, straight into the
+    // mapped file, fetching multiple ranges in parallel
+    auto Fetch = [this, &Key, &Region](uint64_t Begin,
+                                       uint64_t End) -> std::string {
+      Aws::S3::Model::GetObjectRequest Request;
+      Request.SetBucket(Bucket);
+      Request.SetKey(Key);
+      Request.SetRange("bytes=" + llvm::utostr(Begin) + "-"
+                       + llvm::utostr(End - 1));
+
+      Aws::S3::Model::GetObjectOutcome Result = Client.GetObject(Request);
+      if (not Result.IsSuccess())
+        return Result.GetError().GetMessage().c_str();
+
+      char *Cursor = Region->data() + Begin;
+      char *Limit = Region->data() + End;
+      auto &Body = Result.GetResult().GetBody();
+      while (Cursor != Limit and Body.read(Cursor, Limit - Cursor).gcount() > 0)
+        Cursor += Body.gcount();
+
+      if (Cursor != Limit)
+        return "Short read while downloading " + Key;
+
+      return {};
+    };
+
+    const uint64_t PartSize = partSize();
+    std::vector<std::shared_future<std::string>> Ranges;
+    for (uint64_t Begin = 0; Begin < Size; Begin += PartSize) {
+      uint64_t End = std::min(Size, Begin + PartSize);
+      if (Size <= PartSize) {
+        // Do not bother the thread pool for a single range
+        std::promise<std::string> Promise;
+        Promise.set_value(Fetch(Begin, End));
+        Ranges.push_back(Promise.get_future().share());
+      } else {
+        Ranges.push_back(pool().async(Fetch, Begin, End));
+      }
+    }
 
-  constexpr size_t BufSize = 4096;
-  llvm::SmallVector<char> Buffer;
-  Buffer.resize_for_overwrite(BufSize);
-  auto &Body = Result.GetResult().GetBody();
+    std::string Errors;
+    for (auto &Range : Ranges)
+      if (not Range.get().empty())
+        Errors += Range.get() + "\n";
 
-  while (!Body.eof()) {
-    Body.read(Buffer.data(), BufSize);
-    OS.write(Buffer.data(), Body.gcount());
+    if (not Errors.empty())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(), Errors);
   }
 
-  OS.flush();
-  OS.close();
-
   auto MaybeReadableStream = MemoryBuffer::getFile(MaybeTemporary->path());
   if (not MaybeReadableStream) {
     return llvm::createStringError(MaybeReadableStream.getError(),
@@ -400,25 +698,60 @@ S3StorageClient::getReadableFile(llvm::StringRef Path) {
 llvm::Expected<std::unique_ptr<WritableFile>>
 S3StorageClient::getWritableFile(llvm::StringRef Path,
                                  ContentEncoding Encoding) {
-  auto MaybeTemporary = TemporaryFile::make("revng-s3-storage");
-  if (!MaybeTemporary) {
-    return llvm::createStringError(MaybeTemporary.getError(),
-                                   "Could not create temporary file");
+  return std::make_unique<S3WritableFile>(Path, Encoding, *this);
+}
+
+llvm::ThreadPool &S3StorageClient::pool() {
+  if (not Pool) {
+    auto Strategy = llvm::hardware_concurrency(TransferThreads);
+    Pool = std::make_unique<llvm::ThreadPool>(Strategy);
   }
 
-  std::error_code EC;
-  auto OS = std::make_unique<llvm::raw_fd_ostream>(MaybeTemporary->path(), EC);
-  if (EC)
-    return llvm::createStringError(EC, "Could not open temporary file");
+  return *Pool;
+}
 
-  return std::make_unique<S3WritableFile>(std::move(MaybeTemporary.get()),
-                                          std::move(OS),
-                                          Path,
-                                          Encoding,
-                                          *this);
+void S3StorageClient::uploadInBackground(llvm::StringRef Key,
+                                         std::function<std::string()> Upload) {
+  pool().async([this, Key = Key.str(), Upload = std::move(Upload)]() {
+    std::string Error = Upload();
+    if (not Error.empty()) {
+      std::lock_guard Guard(Mutex);
+      FailedUploads[Key] = std::move(Error);
+    }
+  });
+}
+
+llvm::Error S3StorageClient::waitForUploads() {
+  if (not Pool)
+    return llvm::Error::success();
+
+  Pool->wait();
+
+  std::lock_guard Guard(Mutex);
+  if (FailedUploads.empty())
+    return llvm::Error::success();
+
+  // Failures are not cleared: until the affected paths are written again or
+  // removed, every read and commit has to fail
+  std::set<std::string> Messages;
+  for (auto &[_, Filename] : FilenameMap) {
+    auto It = FailedUploads.find(resolvePath(Filename));
+    if (It != FailedUploads.end())
+      Messages.insert(It->second);
+  }
+
+  if (Messages.empty())
+    return llvm::Error::success();
+
+  std::string Message = llvm::join(Messages, "\n");
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), Message);
 }
 
 llvm::Error S3StorageClient::commit() {
+  // Never publish an index pointing to files that haven't been uploaded
+  if (auto Error = waitForUploads())
+    return Error;
+
   std::string SerializedIndex;
 
   {
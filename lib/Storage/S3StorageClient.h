@@ -4,16 +4,23 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "aws/core/auth/AWSCredentials.h"
 #include "aws/s3/S3Client.h"
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "revng/Storage/StorageClient.h"
 
 namespace revng {
 
+class S3UploadStream;
 class S3WritableFile;
 
 class S3StorageClient : public StorageClient {
@@ -26,6 +33,17 @@ private:
   llvm::StringMap<std::string> FilenameMap;
   static constexpr auto IndexName = "index.yml";
 
+  /// Protects FailedUploads, which is populated by background uploads
+  std::mutex Mutex;
+  /// Error message of each background upload that failed, by key. Entries
+  /// are kept as long as FilenameMap refers to the key, so that no index
+  /// pointing to a missing object is ever committed.
+  llvm::StringMap<std::string> FailedUploads;
+
+  /// Pool running the transfers, created on first use. Keep this last, so that
+  /// pending transfers are waited for before anything else is destroyed.
+  std::unique_ptr<llvm::ThreadPool> Pool;
+
 public:
   S3StorageClient(llvm::StringRef URL);
   ~S3StorageClient() override = default;
@@ -60,6 +78,20 @@ public:
 private:
   std::string dumpString() const override;
   std::string resolvePath(llvm::StringRef Path);
+
+  /// \return the pool running the transfers, creating it if needed
+  llvm::ThreadPool &pool();
+
+  /// Run \p Upload, which uploads the object \p Key, on the transfer pool.
+  /// \p Upload returns an error message, or an empty string on success.
+  void uploadInBackground(llvm::StringRef Key,
+                          std::function<std::string()> Upload);
+
+  /// Wait for all the pending transfers and report the failed uploads of the
+  /// objects that are still referenced by FilenameMap
+  llvm::Error waitForUploads();
+
+  friend class S3UploadStream;
   friend class S3WritableFile;
 };
 
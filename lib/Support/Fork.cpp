@@ -0,0 +1,23 @@
+/// \file Fork.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include "llvm/Support/FileSystem.h"
+
+#include "revng/Support/Fork.h"
+
+using namespace llvm;
+
+bool isSingleThreaded() {
+  std::error_code EC;
+  unsigned Threads = 0;
+  for (sys::fs::directory_iterator It("/proc/self/task", EC), End;
+       It != End and not EC;
+       It.increment(EC))
+    ++Threads;
+
+  // If we can't tell, assume there are other threads
+  return not EC and Threads == 1;
+}
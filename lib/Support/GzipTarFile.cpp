@@ -163,6 +163,29 @@ OffsetDescriptor GzipTarWriter::append(llvm::StringRef Path,
   return Result;
 }
 
+OffsetDescriptor
+GzipTarWriter::appendCompressed(llvm::StringRef Path,
+                                size_t UncompressedSize,
+                                llvm::ArrayRef<char> CompressedData) {
+  revng_assert(OS != nullptr);
+  revng_assert(not Filenames.contains(Path));
+
+  OffsetDescriptor Result = { .Start = OS->tell() };
+  writeFileHeader(*OS, Path, UncompressedSize);
+
+  Result.DataStart = OS->tell();
+  OS->write(CompressedData.data(), CompressedData.size());
+
+  Result.PaddingStart = OS->tell();
+  if (size_t Padding = computePadding(UncompressedSize);
+      Padding % BlockSize != 0)
+    compressedPadding(*OS, Padding);
+
+  Result.End = OS->tell();
+  Filenames.insert(Path);
+  return Result;
+}
+
 void GzipTarWriter::close() {
   revng_assert(OS != nullptr);
   // The tar archive needs to be ended with two blocks of zeros
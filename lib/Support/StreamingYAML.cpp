@@ -0,0 +1,18 @@
+/// \file StreamingYAML.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include "revng/Support/CommandLine.h"
+#include "revng/TupleTree/StreamingYAML.h"
+
+namespace cl = llvm::cl;
+
+cl::opt<bool> StreamingYAMLTupleTrees("streaming-yaml-tuple-trees",
+                                      cl::desc("Deserialize YAML tuple trees "
+                                               "in chunks, reducing the peak "
+                                               "memory usage on large "
+                                               "documents."),
+                                      cl::cat(MainCategory),
+                                      cl::init(false));
@@ -251,11 +251,12 @@ BitLivenessPass::Result BitLivenessPass::run(llvm::Function &F,
     }
   }
 
-  auto MFPRes = MFP::getMaximalFixedPoint<BitLivenessAnalysis>({},
-                                                               &DataFlowGraph,
-                                                               0,
-                                                               Top,
-                                                               ExtremalLabels);
+  using BLA = BitLivenessAnalysis;
+  auto MFPRes = MFP::getDenseMaximalFixedPoint<BLA>({},
+                                                    &DataFlowGraph,
+                                                    0,
+                                                    Top,
+                                                    ExtremalLabels);
   BitLivenessPass::Result Result;
   for (auto &[Label, MFPResult] : MFPRes) {
     auto &Entry = Result[Label->Instruction];
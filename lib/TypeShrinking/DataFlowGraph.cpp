@@ -14,7 +14,7 @@ using namespace llvm;
 
 namespace TypeShrinking {
 GenericGraph<DataFlowNode> buildDataFlowGraph(Function &F) {
-  GenericGraph<DataFlowNode> DataFlowGraph;
+  GenericGraph<DataFlowNode> DataFlowGraph(NodeAllocation::Arena);
 
   std::vector<DataFlowNode *> Worklist;
   std::unordered_map<Instruction *, DataFlowNode *> InstructionNodeMap;
@@ -25,11 +25,18 @@ inline RunningStatistics AVICFEGSizeStatitistics("avi-cfeg-size");
 AdvancedValueInfoMFI::LatticeElement
 AdvancedValueInfoMFI::combineValues(const LatticeElement &LHS,
                                     const LatticeElement &RHS) const {
-  LatticeElement Result = LHS;
+  if (LHS.sharesStorageWith(RHS))
+    return LHS;
 
-  for (auto &[Key, Value] : RHS) {
-    auto &ResultEntry = Result[Key];
-    ResultEntry = ResultEntry.unionWith(Value);
+  // Only touch the entries that actually change, so that the result shares as
+  // much as possible with LHS
+  LatticeElement Result = LHS;
+  for (const auto &[Key, Value] : RHS) {
+    const ConstantRangeSet *Current = Result.find(Key);
+    if (Current == nullptr)
+      Result.set(Key, Value);
+    else if (not Current->contains(Value))
+      Result.set(Key, Current->unionWith(Value));
   }
 
   return Result;
@@ -37,19 +44,22 @@ AdvancedValueInfoMFI::combineValues(const LatticeElement &LHS,
 
 bool AdvancedValueInfoMFI::isLessOrEqual(const LatticeElement &LHS,
                                          const LatticeElement &RHS) const {
-  for (const auto &[LeftEntry, RightEntry] : zipmap_range(LHS, RHS)) {
-    if (LeftEntry != nullptr and RightEntry != nullptr) {
-      if (not RightEntry->second.contains(LeftEntry->second)) {
-        return false;
-      } else {
-        // All good
-      }
-    } else if (LeftEntry == nullptr) {
-      // All good
-    } else if (RightEntry == nullptr) {
-      // An element is present only in the LHS
+  if (LHS.sharesStorageWith(RHS))
+    return true;
+
+  // Both maps are sorted: walk them in parallel
+  auto RightIt = RHS.begin();
+  auto RightEnd = RHS.end();
+  for (const auto &[Key, LeftValue] : LHS) {
+    while (RightIt != RightEnd and RightIt->first < Key)
+      ++RightIt;
+
+    // An element is present only in the LHS
+    if (RightIt == RightEnd or RightIt->first != Key)
+      return false;
+
+    if (not RightIt->second.contains(LeftValue))
       return false;
-    }
   }
 
   return true;
@@ -125,7 +135,7 @@ AdvancedValueInfoMFI::applyTransferFunction(Label L,
         AVILogger << DoLog;
       }
 
-      if (NewRange.size().getLimitedValue() < Range.size().getLimitedValue())
+      if (NewRange.getLimitedSize() < Range.getLimitedSize())
         Range = NewRange;
     }
     // Ensure our range is of the right size
@@ -138,11 +148,15 @@ AdvancedValueInfoMFI::applyTransferFunction(Label L,
       AVILogger << DoLog;
     }
 
-    auto It = Result.find(I);
-    if (It != Result.end())
-      It->second = It->second.intersectWith(Range);
-    else
-      Result[I] = Range;
+    // Leave untouched the entries that do not change, so that they can keep
+    // being shared with E
+    if (const ConstantRangeSet *Current = Result.find(I)) {
+      ConstantRangeSet Intersection = Current->intersectWith(Range);
+      if (not(Intersection == *Current))
+        Result.set(I, std::move(Intersection));
+    } else {
+      Result.set(I, std::move(Range));
+    }
   }
 
   return Result;
@@ -157,8 +171,7 @@ void AdvancedValueInfoMFI::dump(GraphType CFEG, const ResultsMap &AllResults) {
 /// \p Context the position in the function for the current query.
 std::tuple<std::map<llvm::Instruction *, ConstantRangeSet>,
            ControlFlowEdgesGraph,
-           map<const ForwardNode<ControlFlowEdgesNode> *,
-               MFP::MFPResult<map<llvm::Instruction *, ConstantRangeSet>>>>
+           AdvancedValueInfoMFI::ResultsMap>
 runAVI(const DataFlowGraph &DFG,
        llvm::Instruction *Context,
        const llvm::DominatorTree &DT,
@@ -190,12 +203,9 @@ runAVI(const DataFlowGraph &DFG,
   }
 
   if (Targets.size() == 0) {
-    return {
-      std::map<llvm::Instruction *, ConstantRangeSet>{},
-      ControlFlowEdgesGraph(),
-      map<const ForwardNode<ControlFlowEdgesNode> *,
-          MFP::MFPResult<map<llvm::Instruction *, ConstantRangeSet>>>{}
-    };
+    return { std::map<llvm::Instruction *, ConstantRangeSet>{},
+             ControlFlowEdgesGraph(),
+             AdvancedValueInfoMFI::ResultsMap{} };
   }
 
   //
@@ -280,15 +290,17 @@ runAVI(const DataFlowGraph &DFG,
     AVILogger << DoLog;
   }
 
-  auto &ResultsOnTarget = AllResults.at(CFEG.at(ContextBB)).OutValue;
+  std::map<llvm::Instruction *, ConstantRangeSet> ResultsOnTarget;
+  for (const auto &[I, Range] : AllResults.at(CFEG.at(ContextBB)).OutValue)
+    ResultsOnTarget[I] = Range;
 
-  return { ResultsOnTarget, std::move(CFEG), std::move(AllResults) };
+  return { std::move(ResultsOnTarget), std::move(CFEG), std::move(AllResults) };
 }
 
 template<>
 void MFP::dump(llvm::raw_ostream &Stream,
                unsigned Indent,
-               const std::map<llvm::Instruction *, ConstantRangeSet> &Element) {
+               const AdvancedValueInfoMFI::LatticeElement &Element) {
   for (const auto &[I, Range] : Element) {
     for (unsigned I = 0; I < Indent; ++I)
       Stream << "  ";
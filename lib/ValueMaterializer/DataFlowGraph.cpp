@@ -118,8 +118,7 @@ void DataFlowGraph::purgeUnreachable() {
   for (Node *N : depth_first(this))
     Reachable.insert(N);
 
-  erase_if(this->Nodes,
-           [&](auto &N) { return not Reachable.contains(N.get()); });
+  removeNodesIf([&](Node *N) { return not Reachable.contains(N); });
 }
 
 void DataFlowGraph::enforceLimits(Limits TheLimits) {
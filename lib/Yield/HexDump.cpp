@@ -45,7 +45,7 @@ static void outputHexDump(const TupleTree<model::Binary> &Binary,
 
   revng_assert(not ErrorCode, "Could not open file!");
 
-  FunctionMetadataCache FunctionMetadataCache;
+  auto &FunctionMetadataCache = getFunctionMetadataCache(Module);
 
   using boost::icl::discrete_interval;
   using boost::icl::inplace_plus;
@@ -2,6 +2,11 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <map>
+#include <mutex>
+
+#include "llvm/Support/SHA1.h"
+
 #include "revng/EarlyFunctionAnalysis/FunctionMetadata.h"
 #include "revng/EarlyFunctionAnalysis/FunctionMetadataCache.h"
 #include "revng/Lift/LoadBinaryPass.h"
@@ -17,6 +22,7 @@
 #include "revng/Yield/Assembly/DisassemblyHelper.h"
 #include "revng/Yield/Function.h"
 #include "revng/Yield/PTML.h"
+#include "revng/Yield/Pipes/ParallelForEach.h"
 #include "revng/Yield/Pipes/ProcessAssembly.h"
 #include "revng/Yield/Pipes/YieldAssembly.h"
 
@@ -24,10 +30,56 @@ using ptml::PTMLBuilder;
 
 namespace revng::pipes {
 
+using Digest = std::array<uint8_t, 20>;
+
+static std::mutex CacheMutex;
+static std::map<Digest, std::shared_ptr<const yield::Function>> Cache;
+
+static Digest computeDigest(llvm::StringRef Serialized) {
+  return llvm::SHA1::hash(llvm::arrayRefFromStringRef(Serialized));
+}
+
+void DisassembledFunctionCache::reset() {
+  std::lock_guard Lock(CacheMutex);
+  Cache.clear();
+}
+
+void DisassembledFunctionCache::insert(yield::Function &&Function,
+                                       llvm::StringRef Serialized) {
+  Digest Hash = computeDigest(Serialized);
+  auto Shared = std::make_shared<const yield::Function>(std::move(Function));
+
+  std::lock_guard Lock(CacheMutex);
+  Cache.insert_or_assign(Hash, std::move(Shared));
+}
+
+std::shared_ptr<const yield::Function>
+DisassembledFunctionCache::get(const MetaAddress &Entry,
+                               llvm::StringRef Serialized) {
+  Digest Hash = computeDigest(Serialized);
+  {
+    std::lock_guard Lock(CacheMutex);
+    auto It = Cache.find(Hash);
+    if (It != Cache.end()) {
+      revng_assert(It->second->Entry() == Entry);
+      return It->second;
+    }
+  }
+
+  auto MaybeFunction = TupleTree<yield::Function>::deserialize(Serialized);
+  revng_assert(MaybeFunction && MaybeFunction->verify());
+  revng_assert((*MaybeFunction)->Entry() == Entry);
+  return std::make_shared<const yield::Function>(std::move(**MaybeFunction));
+}
+
 void ProcessAssembly::run(pipeline::ExecutionContext &Context,
                           const BinaryFileContainer &SourceBinary,
                           const pipeline::LLVMContainer &TargetList,
                           FunctionAssemblyStringMap &Output) {
+  // Drop the functions disassembled by previous runs, which might belong to a
+  // different binary or model
+  DisassembledFunctionCache::reset();
+
   if (not SourceBinary.exists())
     return;
 
@@ -43,19 +95,44 @@ void ProcessAssembly::run(pipeline::ExecutionContext &Context,
   // Access the llvm module
   const llvm::Module &Module = TargetList.getModule();
 
-  // Define the helper object to store the disassembly pipeline.
-  // This allows it to only be created once.
-  DissassemblyHelper Helper;
-
-  FunctionMetadataCache Cache;
+  // Collect the functions to disassemble: the module is not going to be
+  // accessed by the worker threads
+  using WorkItem = std::pair<const model::Function *,
+                             const efa::FunctionMetadata *>;
+  std::vector<WorkItem> Work;
+  FunctionMetadataCache &Cache = getFunctionMetadataCache(TargetList);
   for (const auto &LLVMFunction : FunctionTags::Isolated.functions(&Module)) {
     const auto &Metadata = Cache.getFunctionMetadata(&LLVMFunction);
     auto ModelFunctionIterator = Model->Functions().find(Metadata.Entry());
     revng_assert(ModelFunctionIterator != Model->Functions().end());
+    Work.emplace_back(&*ModelFunctionIterator, &Metadata);
+  }
 
-    const auto &Func = *ModelFunctionIterator;
-    auto Disassembled = Helper.disassemble(Func, Metadata, BinaryView, *Model);
-    Output.insert_or_assign(Func.Entry(), serializeToString(Disassembled));
+  // Tracking the model accesses is not thread-safe. This pipe does not commit
+  // its targets individually, so there's nothing to lose in pausing it.
+  Context.getContext().stopTracking();
+
+  // Each thread gets its own helper object, which holds the disassembler
+  // instances for the architectures it has encountered
+  std::vector<std::string> Serialized(Work.size());
+  std::vector<yield::Function> Disassembled(Work.size());
+  auto Disassemble = [&](DissassemblyHelper &Helper, size_t Index) {
+    const auto &[Function, Metadata] = Work[Index];
+    Disassembled[Index] = Helper.disassemble(*Function,
+                                             *Metadata,
+                                             BinaryView,
+                                             *Model);
+    Serialized[Index] = serializeToString(Disassembled[Index]);
+  };
+  parallelForEach<DissassemblyHelper>(Work.size(), Disassemble);
+
+  Context.clearAndResumeTracking();
+
+  for (size_t Index = 0; Index < Work.size(); ++Index) {
+    MetaAddress Entry = Work[Index].first->Entry();
+    DisassembledFunctionCache::insert(std::move(Disassembled[Index]),
+                                      Serialized[Index]);
+    Output.insert_or_assign(Entry, std::move(Serialized[Index]));
   }
 }
 
@@ -71,14 +148,20 @@ void YieldAssembly::run(pipeline::ExecutionContext &Context,
   // Access the model
   const auto &Model = getModelFromContext(Context);
 
-  PTMLBuilder ThePTMLBuilder;
-  for (auto [Address, S] : Input) {
-    auto MaybeFunction = TupleTree<yield::Function>::deserialize(S);
-    revng_assert(MaybeFunction && MaybeFunction->verify());
-    revng_assert((*MaybeFunction)->Entry() == std::get<0>(Address));
+  using WorkItem = std::pair<MetaAddress, const std::string *>;
+  std::vector<WorkItem> Work;
+  for (auto [Address, S] : Input)
+    Work.emplace_back(std::get<0>(Address), &S);
 
-    const model::Function &ModelFunction = Model->Functions()
-                                             .at(std::get<0>(Address));
+  // See ProcessAssembly::run
+  Context.getContext().stopTracking();
+
+  std::vector<std::string> Results(Work.size());
+  auto Print = [&](PTMLBuilder &ThePTMLBuilder, size_t Index) {
+    const auto &[Entry, S] = Work[Index];
+    auto Function = DisassembledFunctionCache::get(Entry, *S);
+
+    const model::Function &ModelFunction = Model->Functions().at(Entry);
     const model::Architecture::Values A = Model->Architecture();
     auto CommentIndicator = model::Architecture::getAssemblyCommentIndicator(A);
     std::string R = ptml::functionComment(ThePTMLBuilder,
@@ -87,10 +170,16 @@ void YieldAssembly::run(pipeline::ExecutionContext &Context,
                                           CommentIndicator,
                                           0,
                                           80);
-    R += yield::ptml::functionAssembly(ThePTMLBuilder, **MaybeFunction, *Model);
-    R = ThePTMLBuilder.getTag(ptml::tags::Div, std::move(R)).serialize();
-    Output.insert_or_assign((*MaybeFunction)->Entry(), std::move(R));
-  }
+    R += yield::ptml::functionAssembly(ThePTMLBuilder, *Function, *Model);
+    Results[Index] = ThePTMLBuilder.getTag(ptml::tags::Div, std::move(R))
+                       .serialize();
+  };
+  parallelForEach<PTMLBuilder>(Work.size(), Print);
+
+  Context.clearAndResumeTracking();
+
+  for (size_t Index = 0; Index < Work.size(); ++Index)
+    Output.insert_or_assign(Work[Index].first, std::move(Results[Index]));
 }
 
 void YieldAssembly::print(const pipeline::Context &,
@@ -9,6 +9,8 @@
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/ModelGlobal.h"
 #include "revng/Yield/Function.h"
+#include "revng/Yield/Pipes/ParallelForEach.h"
+#include "revng/Yield/Pipes/ProcessAssembly.h"
 #include "revng/Yield/Pipes/YieldControlFlow.h"
 #include "revng/Yield/SVG.h"
 
@@ -21,18 +23,29 @@ void YieldControlFlow::run(pipeline::ExecutionContext &Context,
                            FunctionControlFlowStringMap &Output) {
   // Access the model
   const auto &Model = revng::getModelFromContext(Context);
-  ptml::PTMLBuilder ThePTMLBuilder;
-
-  for (auto [Address, S] : Input) {
-    auto MaybeFunction = TupleTree<yield::Function>::deserialize(S);
-    revng_assert(MaybeFunction && MaybeFunction->verify());
-    revng_assert((*MaybeFunction)->Entry() == std::get<0>(Address));
-
-    Output.insert_or_assign((*MaybeFunction)->Entry(),
-                            yield::svg::controlFlowGraph(ThePTMLBuilder,
-                                                         **MaybeFunction,
-                                                         *Model));
-  }
+
+  using WorkItem = std::pair<MetaAddress, const std::string *>;
+  std::vector<WorkItem> Work;
+  for (auto [Address, S] : Input)
+    Work.emplace_back(std::get<0>(Address), &S);
+
+  // Tracking the model accesses is not thread-safe, see ProcessAssembly::run
+  Context.getContext().stopTracking();
+
+  std::vector<std::string> Results(Work.size());
+  auto Render = [&](PTMLBuilder &ThePTMLBuilder, size_t Index) {
+    const auto &[Entry, S] = Work[Index];
+    auto Function = DisassembledFunctionCache::get(Entry, *S);
+    Results[Index] = yield::svg::controlFlowGraph(ThePTMLBuilder,
+                                                  *Function,
+                                                  *Model);
+  };
+  parallelForEach<PTMLBuilder>(Work.size(), Render);
+
+  Context.clearAndResumeTracking();
+
+  for (size_t Index = 0; Index < Work.size(); ++Index)
+    Output.insert_or_assign(Work[Index].first, std::move(Results[Index]));
 }
 
 void YieldControlFlow::print(const pipeline::Context &,
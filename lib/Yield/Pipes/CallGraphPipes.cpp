@@ -15,6 +15,7 @@
 #include "revng/Pipes/TupleTreeContainer.h"
 #include "revng/Yield/CrossRelations/CrossRelations.h"
 #include "revng/Yield/Generated/ForwardDecls.h"
+#include "revng/Yield/Pipes/ParallelForEach.h"
 #include "revng/Yield/Pipes/ProcessCallGraph.h"
 #include "revng/Yield/Pipes/YieldCallGraph.h"
 #include "revng/Yield/Pipes/YieldCallGraphSlice.h"
@@ -36,7 +37,7 @@ void ProcessCallGraph::run(pipeline::ExecutionContext &Context,
   // Gather function metadata
   SortedVector<efa::FunctionMetadata> Metadata;
   for (const auto &LLVMFunction : FunctionTags::Isolated.functions(&Module))
-    Metadata.insert(*::detail::extractFunctionMetadata(&LLVMFunction));
+    Metadata.insert(::detail::extractFunctionMetadata(&LLVMFunction));
 
   // If some functions are missing, do not output anything
   if (Metadata.size() != Model->Functions().size())
@@ -80,21 +81,36 @@ void YieldCallGraphSlice::run(pipeline::ExecutionContext &Context,
 
   // Access the llvm module
   const llvm::Module &Module = TargetList.getModule();
-  PTMLBuilder ThePTMLBuilder;
-  FunctionMetadataCache Cache;
+
+  // Collect the functions to render: the module is not going to be accessed
+  // by the worker threads
+  std::vector<MetaAddress> Entries;
+  FunctionMetadataCache &Cache = getFunctionMetadataCache(TargetList);
   for (const auto &LLVMFunction : FunctionTags::Isolated.functions(&Module)) {
     auto &Metadata = Cache.getFunctionMetadata(&LLVMFunction);
     revng_assert(llvm::is_contained(Model->Functions(), Metadata.Entry()));
+    Entries.push_back(Metadata.Entry());
+  }
 
+  // Tracking the model accesses is not thread-safe, see ProcessAssembly::run
+  Context.getContext().stopTracking();
+
+  std::vector<std::string> Results(Entries.size());
+  auto Render = [&](PTMLBuilder &ThePTMLBuilder, size_t Index) {
     // Slice the graph for the current function and convert it to SVG
     auto SlicePoint = pipeline::serializedLocation(revng::ranks::Function,
-                                                   Metadata.Entry());
-    Output.insert_or_assign(Metadata.Entry(),
-                            yield::svg::callGraphSlice(ThePTMLBuilder,
-                                                       SlicePoint,
-                                                       *Relations.get(),
-                                                       *Model));
-  }
+                                                   Entries[Index]);
+    Results[Index] = yield::svg::callGraphSlice(ThePTMLBuilder,
+                                                SlicePoint,
+                                                *Relations.get(),
+                                                *Model);
+  };
+  parallelForEach<PTMLBuilder>(Entries.size(), Render);
+
+  Context.clearAndResumeTracking();
+
+  for (size_t Index = 0; Index < Entries.size(); ++Index)
+    Output.insert_or_assign(Entries[Index], std::move(Results[Index]));
 }
 
 void YieldCallGraphSlice::print(const pipeline::Context &,
@@ -0,0 +1,22 @@
+/// \file ParallelForEach.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include "llvm/Support/CommandLine.h"
+
+#include "revng/Yield/Pipes/ParallelForEach.h"
+
+static llvm::cl::opt<unsigned> Threads("disassembly-threads",
+                                       llvm::cl::desc("Number of threads used "
+                                                      "to disassemble, print "
+                                                      "and render functions, "
+                                                      "0 means one per core."),
+                                       llvm::cl::init(0));
+
+unsigned revng::pipes::yieldThreadCount() {
+  if (Threads != 0)
+    return Threads;
+  return llvm::hardware_concurrency().compute_thread_count();
+}
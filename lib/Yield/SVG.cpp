@@ -10,6 +10,7 @@
 #include "llvm/Support/FormatVariadic.h"
 
 #include "revng/GraphLayout/SugiyamaStyle/Compute.h"
+#include "revng/GraphLayout/SugiyamaStyle/LayoutCache.h"
 #include "revng/Model/Binary.h"
 #include "revng/PTML/Tag.h"
 #include "revng/Support/GraphAlgorithms.h"
@@ -339,6 +340,11 @@ static std::string exportGraph(const PTMLBuilder &ThePTMLBuilder,
 
 namespace yield::layout::sugiyama {
 
+/// Layouts of the graphs rendered so far. Graphs are often rendered again
+/// after changes that do not affect their shape (e.g., a rename that does
+/// not change the size of any node), which then only need to be re-emitted.
+static LayoutCache Layouts;
+
 /// A helper for invoking sugiyama style layouter with the configuration
 /// filled in based on the relevant cfg::Configuration.
 ///
@@ -360,16 +366,24 @@ compute(const InputGraph<Node, Edge> &Graph,
         Orientation LayoutOrientation = Orientation::TopToBottom,
         RankingStrategy Ranking = RankingStrategy::DisjointDepthFirstSearch,
         bool UseSimpleTreeOptimization = false) {
-  return compute(Graph,
-                 Configuration{
-                   .Ranking = Ranking,
-                   .Orientation = LayoutOrientation,
-                   .UseOrthogonalBends = CFG.UseOrthogonalBends,
-                   .PreserveLinearSegments = CFG.PreserveLinearSegments,
-                   .UseSimpleTreeOptimization = UseSimpleTreeOptimization,
-                   .VirtualNodeWeight = CFG.VirtualNodeWeight,
-                   .NodeMarginSize = CFG.ExternalNodeMarginSize,
-                   .EdgeMarginSize = CFG.EdgeMarginSize });
+  auto Permutation = PermutationStrategy::HillClimbing;
+  if (Graph.size() >= CFG.MedianSweepNodeThreshold)
+    Permutation = PermutationStrategy::MedianSweep;
+
+  std::chrono::milliseconds Budget(CFG.MedianSweepBudget);
+  return computeCached(Graph,
+                       Configuration{
+                         .Ranking = Ranking,
+                         .Orientation = LayoutOrientation,
+                         .UseOrthogonalBends = CFG.UseOrthogonalBends,
+                         .PreserveLinearSegments = CFG.PreserveLinearSegments,
+                         .UseSimpleTreeOptimization = UseSimpleTreeOptimization,
+                         .VirtualNodeWeight = CFG.VirtualNodeWeight,
+                         .NodeMarginSize = CFG.ExternalNodeMarginSize,
+                         .EdgeMarginSize = CFG.EdgeMarginSize,
+                         .Permutation = Permutation,
+                         .PermutationBudget = Budget },
+                       Layouts);
 }
 
 } // namespace yield::layout::sugiyama
@@ -8,6 +8,8 @@
 bool init_unit_test();
 #include "boost/test/unit_test.hpp"
 
+#include "llvm/ADT/ArrayRef.h"
+
 #include "revng/ADT/ConstantRangeSet.h"
 
 BOOST_AUTO_TEST_CASE(TestEnumerate) {
@@ -69,3 +71,43 @@ BOOST_AUTO_TEST_CASE(TestEnumerate) {
     dbg << "\n";
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestNarrowFastPaths) {
+  using CRS = ConstantRangeSet;
+
+  auto Range = [](uint32_t BitWidth, uint64_t Start, uint64_t End) {
+    return CRS({ { BitWidth, Start }, { BitWidth, End } });
+  };
+
+  auto Widen = [](CRS Set) {
+    Set.zext(128);
+    return Set;
+  };
+
+  CRS Sets[] = { CRS(8, true),
+                 CRS(64, true),
+                 CRS(64, false),
+                 Range(64, 10, 20),
+                 Range(64, 100, 0),
+                 Range(64, UINT64_MAX, 5),
+                 Range(64, 10, 20).unionWith(Range(64, 30, 40)),
+                 Range(64, 15, 35) };
+
+  for (const CRS &Set : Sets)
+    revng_check(Set.getLimitedSize() == Set.size().getLimitedValue());
+
+  revng_check(Range(64, 100, 0).getLimitedSize() == -uint64_t(100));
+  revng_check(Range(8, 250, 5).getLimitedSize() == 11);
+
+  // Merging 64-bit sets must match merging their 128-bit counterparts
+  for (const CRS &Left : llvm::ArrayRef<CRS>(Sets).drop_front()) {
+    for (const CRS &Right : llvm::ArrayRef<CRS>(Sets).drop_front()) {
+      revng_check(Widen(Left.unionWith(Right))
+                  == Widen(Left).unionWith(Widen(Right)));
+      revng_check(Widen(Left.intersectWith(Right))
+                  == Widen(Left).intersectWith(Widen(Right)));
+      revng_check(Left.contains(Right)
+                  == Widen(Left).contains(Widen(Right)));
+    }
+  }
+}
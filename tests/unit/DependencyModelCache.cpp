@@ -0,0 +1,160 @@
+/// \file DependencyModelCache.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <optional>
+#include <string>
+
+#define BOOST_TEST_MODULE DependencyModelCache
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Model/Binary.h"
+#include "revng/Model/Importer/Binary/DependencyModelCache.h"
+#include "revng/Model/Importer/Binary/Options.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/YAMLTraits.h"
+
+using namespace llvm;
+
+static constexpr StringRef BuildID = "0123456789abcdef";
+
+static ImporterOptions makeOptions(uint64_t BaseAddress = 0,
+                                   bool EnableRemoteDebugInfo = false) {
+  return ImporterOptions{ .BaseAddress = BaseAddress,
+                          .DebugInfo = DebugInfoLevel::IgnoreLibraries,
+                          .EnableRemoteDebugInfo = EnableRemoteDebugInfo,
+                          .AdditionalDebugInfoPaths = {} };
+}
+
+static std::string key(const std::optional<std::string> &DebugInfoPath,
+                       const ImporterOptions &Options = makeOptions()) {
+  return DependencyModelCache::key(BuildID,
+                                   DebugInfoPath,
+                                   model::Architecture::x86_64,
+                                   Options);
+}
+
+/// A library exporting `exit`, with a prototype, and `unknown`, without one
+static TupleTree<model::Binary> makeLibraryModel() {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+
+  auto Void = Model->getPrimitiveType(model::PrimitiveTypeKind::Void, 0);
+  auto [Prototype, Path] = Model->makeType<model::CABIFunctionType>();
+  Prototype.ABI() = model::ABI::SystemV_x86_64;
+  Prototype.ReturnType() = model::QualifiedType(Void, {});
+
+  Model->ImportedDynamicFunctions()["exit"].Prototype() = Path;
+  Model->ImportedDynamicFunctions()["unknown"];
+  return Model;
+}
+
+/// A directory removed at the end of the test
+struct TemporaryDirectory {
+  SmallString<128> Path;
+
+  TemporaryDirectory() {
+    auto EC = sys::fs::createUniqueDirectory("revng-dependency-models", Path);
+    revng_check(not EC);
+  }
+
+  ~TemporaryDirectory() { sys::fs::remove_directories(Path); }
+};
+
+static void writeFile(StringRef Path, StringRef Contents) {
+  std::error_code EC;
+  raw_fd_ostream Output(Path, EC);
+  revng_check(not EC);
+  Output << Contents;
+}
+
+BOOST_AUTO_TEST_CASE(TestKey) {
+  std::string Key = key(std::nullopt);
+  revng_check(StringRef(Key).startswith(BuildID));
+  BOOST_TEST(key(std::nullopt) == Key);
+
+  // Libraries without a build-id cannot be cached
+  BOOST_TEST(DependencyModelCache::key("",
+                                       std::nullopt,
+                                       model::Architecture::x86_64,
+                                       makeOptions())
+               .empty());
+
+  // Options affecting the import are part of the key
+  BOOST_TEST(key(std::nullopt, makeOptions(0x1000)) != Key);
+  BOOST_TEST(key(std::nullopt, makeOptions(0, true)) != Key);
+  BOOST_TEST(DependencyModelCache::key(BuildID,
+                                       std::nullopt,
+                                       model::Architecture::aarch64,
+                                       makeOptions())
+             != Key);
+
+  // So is the debug information, which might be installed or updated later
+  TemporaryDirectory Directory;
+  SmallString<128> DebugInfo;
+  sys::path::append(DebugInfo, Directory.Path, "library.debug");
+  writeFile(DebugInfo, "debug");
+  std::string WithDebugInfo = key(DebugInfo.str().str());
+  BOOST_TEST(WithDebugInfo != Key);
+
+  writeFile(DebugInfo, "updated debug");
+  BOOST_TEST(key(DebugInfo.str().str()) != WithDebugInfo);
+
+  sys::fs::remove(DebugInfo);
+  BOOST_TEST(key(DebugInfo.str().str()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestPrune) {
+  TupleTree<model::Binary> Model = makeLibraryModel();
+  DependencyModelCache::prune(Model);
+
+  revng_check(Model->verify());
+  BOOST_TEST(Model->ImportedDynamicFunctions().size() == 1U);
+  BOOST_TEST(Model->ImportedDynamicFunctions().count("exit") == 1U);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadAndStore) {
+  TemporaryDirectory Directory;
+  DependencyModelCache Cache(Directory.Path.str().str());
+  revng_check(Cache.isEnabled());
+
+  TupleTree<model::Binary> Model = makeLibraryModel();
+  DependencyModelCache::prune(Model);
+  std::string Key = key(std::nullopt);
+
+  // Miss
+  revng_check(not Cache.load(Key));
+
+  // Hit
+  Cache.store(Key, Model);
+  auto Loaded = Cache.load(Key);
+  revng_check(Loaded);
+  BOOST_TEST(serializeToString(**Loaded) == serializeToString(*Model));
+
+  // Entries of other configurations are not used
+  revng_check(not Cache.load(key(std::nullopt, makeOptions(0x1000))));
+
+  // Corrupted entries are ignored
+  std::error_code EC;
+  sys::fs::directory_iterator Entry(Directory.Path, EC);
+  revng_check(not EC and Entry != sys::fs::directory_iterator());
+  writeFile(Entry->path(), "garbage");
+  revng_check(not Cache.load(Key));
+}
+
+BOOST_AUTO_TEST_CASE(TestDisabled) {
+  DependencyModelCache Cache("");
+  revng_check(not Cache.isEnabled());
+
+  std::string Key = key(std::nullopt);
+  Cache.store(Key, makeLibraryModel());
+  revng_check(not Cache.load(Key));
+}
@@ -0,0 +1,97 @@
+/// \file FunctionMetadata.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#define BOOST_TEST_MODULE FunctionMetadata
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/EarlyFunctionAnalysis/FunctionMetadata.h"
+#include "revng/EarlyFunctionAnalysis/FunctionMetadataCache.h"
+#include "revng/Support/MetaAddress.h"
+#include "revng/TupleTree/BinarySerialization.h"
+#include "revng/UnitTestHelpers/UnitTestHelpers.h"
+
+static MetaAddress pc(uint64_t Address) {
+  return MetaAddress::fromPC(llvm::Triple::x86_64, Address);
+}
+
+static efa::FunctionMetadata makeMetadata() {
+  using EdgePointer = UpcastablePointer<efa::FunctionEdgeBase>;
+  namespace EdgeType = efa::FunctionEdgeType;
+
+  efa::FunctionMetadata Result;
+  Result.Entry() = pc(0x1000);
+
+  efa::BasicBlock &Entry = Result.ControlFlowGraph()[BasicBlockID(pc(0x1000))];
+  Entry.End() = pc(0x1010);
+  auto Call = EdgePointer::make<efa::CallEdge>(BasicBlockID(pc(0x2000)),
+                                               EdgeType::FunctionCall);
+  auto *CallEdge = llvm::cast<efa::CallEdge>(Call.get());
+  CallEdge->DynamicFunction() = "printf";
+  CallEdge->Attributes().insert(model::FunctionAttribute::NoReturn);
+  Entry.Successors().insert(std::move(Call));
+
+  BasicBlockID InlinedID(pc(0x3000), 1);
+  efa::BasicBlock &Inlined = Result.ControlFlowGraph()[InlinedID];
+  Inlined.End() = pc(0x3008);
+  Inlined.InlinedFrom() = pc(0x3000);
+  auto Edge = EdgePointer::make<efa::FunctionEdge>(BasicBlockID::invalid(),
+                                                   EdgeType::Return);
+  Inlined.Successors().insert(std::move(Edge));
+
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip) {
+  efa::FunctionMetadata Metadata = makeMetadata();
+
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream Stream(Buffer);
+    serializeBinary(Stream, Metadata);
+  }
+
+  BOOST_TEST(isBinaryTupleTree(Buffer));
+  BOOST_TEST(not isBinaryTupleTree(serializeToString(Metadata)));
+
+  auto MaybeDecoded = deserializeBinary<efa::FunctionMetadata>(Buffer);
+  BOOST_TEST(!!MaybeDecoded);
+  BOOST_TEST(serializeToString(*MaybeDecoded) == serializeToString(Metadata));
+
+  // The binary encoding is expected to be smaller than YAML
+  BOOST_TEST(Buffer.size() < serializeToString(Metadata).size());
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedBinary) {
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream Stream(Buffer);
+    serializeBinary(Stream, makeMetadata());
+  }
+
+  llvm::StringRef Truncated = llvm::StringRef(Buffer).drop_back(4);
+  auto MaybeDecoded = deserializeBinary<efa::FunctionMetadata>(Truncated);
+  BOOST_TEST(!MaybeDecoded);
+  llvm::consumeError(MaybeDecoded.takeError());
+}
+
+BOOST_AUTO_TEST_CASE(CacheSharesEntries) {
+  llvm::LLVMContext Context;
+  efa::FunctionMetadata Metadata = makeMetadata();
+
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream Stream(Buffer);
+    serializeBinary(Stream, Metadata);
+  }
+
+  auto *String = llvm::MDString::get(Context, Buffer);
+  FunctionMetadataCache Cache;
+  const efa::FunctionMetadata &First = Cache.getFunctionMetadata(String);
+  const efa::FunctionMetadata &Second = Cache.getFunctionMetadata(String);
+  BOOST_TEST(&First == &Second);
+  BOOST_TEST(First.Entry() == Metadata.Entry());
+}
@@ -617,3 +617,53 @@ BOOST_AUTO_TEST_CASE(MutableEdgeNodeRemovalTest) {
   revng_check(C->successorCount() == 0);
   revng_check(C->predecessorCount() == 1);
 }
+
+BOOST_AUTO_TEST_CASE(ArenaNodeRemovalTest) {
+  using NodeType = MutableEdgeNode<std::string, double>;
+  GenericGraph<NodeType> Graph(NodeAllocation::Arena);
+  revng_check(Graph.allocation() == NodeAllocation::Arena);
+
+  auto *A = Graph.addNode("A");
+  auto *B = Graph.addNode("B");
+  auto *C = Graph.addNode("C");
+  auto *D = Graph.addNode(std::make_unique<NodeType>("D"));
+  A->addSuccessor(B);
+  B->addSuccessor(C);
+  C->addSuccessor(D);
+  revng_check(not Graph.verify());
+  revng_check(Graph.indexOf(A) == 0 and Graph.indexOf(D) == 3);
+
+  // The last node takes the place of the removed one
+  auto Next = Graph.removeNode(B);
+  revng_check(*Next == D);
+  revng_check(Graph.size() == 3);
+  revng_check(not Graph.hasNode(B));
+  revng_check(Graph.indexOf(D) == 1);
+  revng_check(A->successorCount() == 0 and C->predecessorCount() == 0);
+  revng_check(not Graph.verify());
+
+  // Removing the last node leaves the others in place
+  Next = Graph.removeNode(C);
+  revng_check(Next == Graph.nodes().end());
+  revng_check(Graph.indexOf(A) == 0 and Graph.indexOf(D) == 1);
+  revng_check(D->predecessorCount() == 0);
+
+  auto *E = Graph.addNode("E");
+  Graph.insertNode(Graph.nodes().begin(), "F");
+  revng_check(Graph.indexOf(A) == 1 and Graph.indexOf(E) == 3);
+  revng_check(not Graph.verify());
+
+  Graph.removeNodesIf([](auto *Node) { return *Node == "A"; });
+  revng_check(Graph.size() == 3 and Graph.indexOf(E) == 2);
+  revng_check(not Graph.verify());
+
+  decltype(Graph) Other(NodeAllocation::Arena);
+  Other.addNode("G");
+  Graph = std::move(Other);
+  revng_check(Graph.size() == 1 and not Graph.verify());
+
+  Graph.clear();
+  revng_check(not Graph.hasNodes());
+  auto *H = Graph.addNode("H");
+  revng_check(Graph.indexOf(H) == 0);
+}
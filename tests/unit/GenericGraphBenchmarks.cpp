@@ -0,0 +1,54 @@
+/// \file GenericGraphBenchmarks.cpp
+/// Timings for GenericGraph, built but not run by ctest.
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <vector>
+
+#define BOOST_TEST_MODULE GenericGraphBenchmarks
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/ADT/GenericGraph.h"
+#include "revng/Support/Assert.h"
+#include "revng/UnitTestHelpers/Benchmark.h"
+
+namespace {
+
+struct BenchmarkNodeData {
+  BenchmarkNodeData(size_t Index) : Index(Index) {}
+  size_t Index;
+};
+using BenchmarkNode = ForwardNode<BenchmarkNodeData>;
+
+static void buildGraph(NodeAllocation Allocation, size_t Count) {
+  // Build a chain of nodes
+  GenericGraph<BenchmarkNode> Graph(Allocation);
+  std::vector<BenchmarkNode *> Nodes;
+  Nodes.reserve(Count);
+  for (size_t I = 0; I < Count; ++I) {
+    Nodes.push_back(Graph.addNode(I));
+    if (I != 0)
+      Nodes[I - 1]->addSuccessor(Nodes[I]);
+  }
+
+  // Remove every other node, then tear down the rest
+  for (size_t I = 0; I < Count; I += 2)
+    Graph.removeNode(Nodes[I]);
+  revng_check(Graph.size() == Count / 2);
+  Graph.clear();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GraphAllocationBenchmark) {
+  constexpr size_t Count = 20000;
+  auto Heap = measure([] { buildGraph(NodeAllocation::Heap, Count); });
+  auto Arena = measure([] { buildGraph(NodeAllocation::Arena, Count); });
+  BOOST_TEST_MESSAGE("GenericGraph: building, halving and destroying "
+                     << Count << " nodes took " << Arena.count()
+                     << "us with arena allocation, " << Heap.count()
+                     << "us with heap allocation");
+}
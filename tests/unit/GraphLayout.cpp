@@ -0,0 +1,255 @@
+/// \file GraphLayout.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE GraphLayout
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+
+#include "revng/GraphLayout/SugiyamaStyle/Compute.h"
+#include "revng/GraphLayout/SugiyamaStyle/LayoutCache.h"
+
+namespace sugiyama = yield::layout::sugiyama;
+
+using Graph = yield::layout::InputGraph<Empty>;
+
+/// Counts the crossings between the edges in \p Edges, represented as
+/// (upper end, lower end) pairs, by checking every pair of edges.
+static uint64_t
+countCrossingsNaively(const std::vector<std::pair<size_t, size_t>> &Edges) {
+  uint64_t Result = 0;
+  for (size_t I = 0; I < Edges.size(); ++I)
+    for (size_t J = I + 1; J < Edges.size(); ++J)
+      if ((Edges[I].first < Edges[J].first && Edges[I].second > Edges[J].second)
+          || (Edges[I].first > Edges[J].first
+              && Edges[I].second < Edges[J].second))
+        ++Result;
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestBilayerCrossingCount) {
+  std::minstd_rand Generator(42);
+  for (size_t Iteration = 0; Iteration < 200; ++Iteration) {
+    size_t UpperLayerSize = 1 + Generator() % 12;
+    size_t LowerLayerSize = 1 + Generator() % 12;
+    size_t EdgeCount = Generator() % 40;
+
+    std::vector<std::pair<size_t, size_t>> Edges;
+    for (size_t Counter = 0; Counter < EdgeCount; ++Counter)
+      Edges.emplace_back(Generator() % UpperLayerSize,
+                         Generator() % LowerLayerSize);
+    std::sort(Edges.begin(), Edges.end());
+
+    std::vector<size_t> LowerEnds;
+    for (auto &&[Upper, Lower] : Edges)
+      LowerEnds.push_back(Lower);
+
+    using sugiyama::detail::countBilayerCrossings;
+    BOOST_TEST(countBilayerCrossings(LowerEnds, LowerLayerSize)
+               == countCrossingsNaively(Edges));
+  }
+}
+
+/// Builds a graph made of \p LayerCount layers of \p LayerWidth nodes each,
+/// with every node connected to two random nodes of the layer above it.
+static Graph makeLayeredGraph(size_t LayerCount, size_t LayerWidth) {
+  std::minstd_rand Generator(1234);
+
+  Graph Result;
+  auto *Entry = Result.addNode();
+  Entry->Size = { 10, 10 };
+  Result.setEntryNode(Entry);
+
+  std::vector<Graph::Node *> Previous = { Entry };
+  for (size_t Layer = 0; Layer < LayerCount; ++Layer) {
+    std::vector<Graph::Node *> Current;
+    for (size_t Index = 0; Index < LayerWidth; ++Index) {
+      auto *Node = Result.addNode();
+      Node->Size = { 10, 10 };
+      Previous[Generator() % Previous.size()]->addSuccessor(Node);
+      Previous[Generator() % Previous.size()]->addSuccessor(Node);
+      Current.push_back(Node);
+    }
+    Previous = std::move(Current);
+  }
+
+  return Result;
+}
+
+static sugiyama::Configuration makeConfiguration(unsigned ThreadCount) {
+  using namespace sugiyama;
+  return Configuration{ .Ranking = RankingStrategy::Topological,
+                        .Orientation = Orientation::TopToBottom,
+                        .UseOrthogonalBends = true,
+                        .PreserveLinearSegments = false,
+                        .UseSimpleTreeOptimization = false,
+                        .VirtualNodeWeight = 1.f,
+                        .NodeMarginSize = 5.f,
+                        .EdgeMarginSize = 5.f,
+                        .Permutation = PermutationStrategy::MedianSweep,
+                        .PermutationThreadCount = ThreadCount };
+}
+
+static std::vector<yield::layout::Point>
+layOut(const Graph &Input, unsigned ThreadCount) {
+  auto Output = sugiyama::compute(Input, makeConfiguration(ThreadCount));
+  BOOST_REQUIRE(Output.has_value());
+
+  std::vector<yield::layout::Point> Result;
+  for (const auto *Node : Output->nodes())
+    Result.push_back(Node->Center);
+  return Result;
+}
+
+static void checkSameLayout(const std::vector<yield::layout::Point> &Left,
+                            const std::vector<yield::layout::Point> &Right) {
+  BOOST_REQUIRE_EQUAL(Left.size(), Right.size());
+  for (size_t Index = 0; Index < Left.size(); ++Index) {
+    BOOST_TEST(Left[Index].X == Right[Index].X);
+    BOOST_TEST(Left[Index].Y == Right[Index].Y);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMedianSweepIsDeterministic) {
+  // Large enough for the layers to be sorted in parallel.
+  Graph Input = makeLayeredGraph(40, 32);
+
+  auto Parallel = layOut(Input, 4);
+  checkSameLayout(layOut(Input, 1), Parallel);
+  checkSameLayout(layOut(Input, 4), Parallel);
+}
+
+struct LabeledNode {
+  std::string Label;
+
+  LabeledNode(std::string Label = "") : Label(std::move(Label)) {}
+};
+
+using LabeledGraph = yield::layout::InputGraph<LabeledNode>;
+
+/// Builds a diamond whose nodes are labeled with \p Prefix, with the given
+/// \p Width.
+static LabeledGraph makeDiamond(const std::string &Prefix,
+                                yield::layout::Dimension Width = 10) {
+  LabeledGraph Result;
+  auto *Top = Result.addNode(Prefix + "Top");
+  auto *Left = Result.addNode(Prefix + "Left");
+  auto *Right = Result.addNode(Prefix + "Right");
+  auto *Bottom = Result.addNode(Prefix + "Bottom");
+  for (auto *Node : Result.nodes())
+    Node->Size = { Width, 10 };
+
+  Top->addSuccessor(Left);
+  Top->addSuccessor(Right);
+  Left->addSuccessor(Bottom);
+  Right->addSuccessor(Bottom);
+  Result.setEntryNode(Top);
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestLayoutCacheIgnoresLabels) {
+  sugiyama::LayoutCache Cache;
+  auto Configuration = makeConfiguration(1);
+
+  LabeledGraph First = makeDiamond("A");
+  auto FirstLayout = sugiyama::computeCached(First, Configuration, Cache);
+  BOOST_REQUIRE(FirstLayout.has_value());
+  BOOST_TEST(Cache.hits() == 0);
+  BOOST_TEST(Cache.misses() == 1);
+
+  // Same shape, different contents: the layout is reused.
+  LabeledGraph Second = makeDiamond("B");
+  auto SecondLayout = sugiyama::computeCached(Second, Configuration, Cache);
+  BOOST_REQUIRE(SecondLayout.has_value());
+  BOOST_TEST(Cache.hits() == 1);
+  BOOST_TEST(Cache.misses() == 1);
+
+  auto FirstNodes = FirstLayout->nodes();
+  auto SecondNodes = SecondLayout->nodes();
+  for (auto [Left, Right] : llvm::zip(FirstNodes, SecondNodes)) {
+    BOOST_TEST(Left->Center.X == Right->Center.X);
+    BOOST_TEST(Left->Center.Y == Right->Center.Y);
+    BOOST_TEST(Left->Label != Right->Label);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestLayoutCacheMisses) {
+  sugiyama::LayoutCache Cache;
+  auto Configuration = makeConfiguration(1);
+  auto LayOut = [&Cache](const LabeledGraph &Input,
+                         const sugiyama::Configuration &Settings) {
+    return sugiyama::computeCached(Input, Settings, Cache).has_value();
+  };
+
+  LabeledGraph Graph = makeDiamond("A");
+  BOOST_REQUIRE(LayOut(Graph, Configuration));
+
+  // Different node sizes.
+  LabeledGraph Wider = makeDiamond("A", 20);
+  BOOST_REQUIRE(LayOut(Wider, Configuration));
+  BOOST_TEST(Cache.hits() == 0);
+
+  // Different configuration.
+  auto Other = Configuration;
+  Other.Orientation = sugiyama::Orientation::LeftToRight;
+  BOOST_REQUIRE(LayOut(Graph, Other));
+  BOOST_TEST(Cache.hits() == 0);
+  BOOST_TEST(Cache.misses() == 3);
+
+  BOOST_REQUIRE(LayOut(Wider, Configuration));
+  BOOST_TEST(Cache.hits() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestLayoutCacheEntryNode) {
+  auto Configuration = makeConfiguration(1);
+
+  // Same nodes and edges, different entry nodes.
+  LabeledGraph FromTop = makeDiamond("A");
+  LabeledGraph FromLeft = makeDiamond("A");
+  FromLeft.setEntryNode(*std::next(FromLeft.nodes().begin()));
+  LabeledGraph WithoutEntry = makeDiamond("A");
+  WithoutEntry.setEntryNode(nullptr);
+
+  sugiyama::GraphShape TopShape(FromTop, Configuration);
+  sugiyama::GraphShape LeftShape(FromLeft, Configuration);
+  sugiyama::GraphShape NoEntryShape(WithoutEntry, Configuration);
+  BOOST_TEST(!(TopShape == LeftShape));
+  BOOST_TEST(!(TopShape == NoEntryShape));
+  BOOST_TEST(!(LeftShape == NoEntryShape));
+
+  sugiyama::LayoutCache Cache;
+  Cache.insert(sugiyama::GraphShape(TopShape), sugiyama::CachedLayout{});
+  BOOST_TEST((Cache.find(TopShape) != nullptr));
+  BOOST_TEST((Cache.find(LeftShape) == nullptr));
+  BOOST_TEST((Cache.find(NoEntryShape) == nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(TestLayoutCacheEviction) {
+  sugiyama::LayoutCache Cache(2);
+  auto Configuration = makeConfiguration(1);
+
+  std::vector<sugiyama::GraphShape> Shapes;
+  for (yield::layout::Dimension Width : { 10, 20, 30 }) {
+    Shapes.emplace_back(makeDiamond("A", Width), Configuration);
+    auto Copy = Shapes.back();
+    Cache.insert(std::move(Copy), sugiyama::CachedLayout{});
+  }
+
+  // Only the two most recent layouts are kept.
+  BOOST_TEST((Cache.find(Shapes[0]) == nullptr));
+  BOOST_TEST((Cache.find(Shapes[1]) != nullptr));
+  BOOST_TEST((Cache.find(Shapes[2]) != nullptr));
+
+  Cache.clear();
+  BOOST_TEST((Cache.find(Shapes[2]) == nullptr));
+}
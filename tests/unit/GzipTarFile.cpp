@@ -68,3 +68,39 @@ BOOST_AUTO_TEST_CASE(GzipTarFileTest) {
   checkOffset(Buffer, Offset1.DataStart, Offset1.dataSize(), "foo2");
   checkOffset(Buffer, Offset2.DataStart, Offset2.dataSize(), "bar2");
 }
+
+BOOST_AUTO_TEST_CASE(GzipTarFileAppendCompressedTest) {
+  using revng::ArchiveEntry;
+  using revng::OffsetDescriptor;
+
+  // Produce an archive the usual way
+  llvm::SmallVector<char> Source;
+  llvm::raw_svector_ostream SourceOS(Source);
+  revng::GzipTarWriter SourceWriter(SourceOS);
+  const char Data[5] = "foo2";
+  OffsetDescriptor SourceOffset = SourceWriter.append("foo", { Data, 4 });
+  SourceWriter.close();
+
+  // Copy the compressed member into a new archive, without recompressing it
+  llvm::SmallVector<char> Buffer;
+  llvm::raw_svector_ostream OS(Buffer);
+  revng::GzipTarWriter Writer(OS);
+
+  llvm::ArrayRef<char> Compressed(Source.data() + SourceOffset.DataStart,
+                                  SourceOffset.dataSize());
+  OffsetDescriptor Offset = Writer.appendCompressed("bar", 4, Compressed);
+  Writer.close();
+
+  BOOST_TEST(Offset.dataSize() == SourceOffset.dataSize());
+
+  revng::GzipTarReader Reader({ Buffer.data(), Buffer.size() });
+  cppcoro::generator<ArchiveEntry> Gen = Reader.entries();
+  std::vector<ArchiveEntry> Entries(Gen.begin(), Gen.end());
+  BOOST_TEST(Entries.size() == 1ULL);
+
+  llvm::StringRef RefData(Entries[0].Data.data(), Entries[0].Data.size());
+  BOOST_TEST(Entries[0].Filename == "bar");
+  BOOST_TEST(RefData.str() == "foo2");
+
+  checkOffset(Buffer, Offset.DataStart, Offset.dataSize(), "foo2");
+}
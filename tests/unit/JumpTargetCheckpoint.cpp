@@ -0,0 +1,114 @@
+/// \file JumpTargetCheckpoint.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <string>
+
+#define BOOST_TEST_MODULE JumpTargetCheckpoint
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Lift/JumpTargetCheckpoint.h"
+
+using namespace llvm;
+
+static MetaAddress pc(uint64_t Address) {
+  return MetaAddress::fromPC(Triple::x86_64, Address);
+}
+
+static JumpTargetCheckpoint makeCheckpoint() {
+  JumpTargetCheckpoint Result;
+  Result.ComponentsHash = "components";
+  Result.BinaryHash = "binary";
+  Result.ModelHash = "model";
+  Result.EntryPoints[pc(0x1000)] = "function";
+  Result.EntryPoints[pc(0x2000)];
+  Result.JumpTargets[pc(0x1000)] = JTReason::FunctionSymbol;
+  Result.JumpTargets[pc(0x1010)] = JTReason::DirectJump | JTReason::PCStore;
+  return Result;
+}
+
+static std::string dump(const JumpTargetCheckpoint &Checkpoint) {
+  std::string Result;
+  raw_string_ostream Stream(Result);
+  Checkpoint.dump(Stream);
+  Stream.flush();
+  return Result;
+}
+
+/// \return the message of the error \p Text fails to parse with
+static std::string parseError(StringRef Text) {
+  auto Checkpoint = JumpTargetCheckpoint::parse(Text);
+  if (Checkpoint)
+    return "";
+  return toString(Checkpoint.takeError());
+}
+
+BOOST_AUTO_TEST_CASE(TestRoundTrip) {
+  JumpTargetCheckpoint Original = makeCheckpoint();
+  auto Parsed = JumpTargetCheckpoint::parse(dump(Original));
+  BOOST_REQUIRE(static_cast<bool>(Parsed));
+
+  BOOST_TEST(Parsed->ComponentsHash == Original.ComponentsHash);
+  BOOST_TEST(Parsed->BinaryHash == Original.BinaryHash);
+  BOOST_TEST(Parsed->ModelHash == Original.ModelHash);
+  BOOST_TEST((Parsed->EntryPoints == Original.EntryPoints));
+  BOOST_TEST((Parsed->JumpTargets == Original.JumpTargets));
+}
+
+BOOST_AUTO_TEST_CASE(TestMalformed) {
+  // The format used before the header was introduced
+  BOOST_TEST(parseError("0x1000:Code_x86_64 DirectJump\n")
+             == "Missing version");
+  BOOST_TEST(parseError("") == "Missing version");
+
+  BOOST_TEST(parseError("version 1 components\n") == "Unsupported version 1");
+  BOOST_TEST(parseError("version one components\n") == "Malformed version");
+  BOOST_TEST(parseError("version 2 components\nfoo bar\n")
+             == "Unknown keyword foo");
+  BOOST_TEST(parseError("version 2 components\nmodel\n")
+             == "Malformed model hash");
+  BOOST_TEST(parseError("version 2 components\njt nowhere\n")
+             == "Malformed address nowhere");
+  BOOST_TEST(parseError("version 2 components\njt 0x1000:Code_x86_64 Foo\n")
+             == "Unknown jump target reason Foo");
+}
+
+BOOST_AUTO_TEST_CASE(TestCompatibility) {
+  JumpTargetCheckpoint Checkpoint = makeCheckpoint();
+  auto IsCompatibleWith = [&Checkpoint](const JumpTargetCheckpoint &Other) {
+    return not errorToBool(Checkpoint.checkCompatibility(Other));
+  };
+
+  JumpTargetCheckpoint Current = makeCheckpoint();
+  Current.JumpTargets.clear();
+  BOOST_TEST(IsCompatibleWith(Current));
+
+  // New entry points in the model are fine
+  Current.EntryPoints[pc(0x3000)] = "new function";
+  BOOST_TEST(IsCompatibleWith(Current));
+
+  JumpTargetCheckpoint OtherBinary = Current;
+  OtherBinary.BinaryHash = "other";
+  BOOST_TEST(not IsCompatibleWith(OtherBinary));
+
+  JumpTargetCheckpoint OtherComponents = Current;
+  OtherComponents.ComponentsHash = "other";
+  BOOST_TEST(not IsCompatibleWith(OtherComponents));
+
+  JumpTargetCheckpoint OtherModel = Current;
+  OtherModel.ModelHash = "other";
+  BOOST_TEST(not IsCompatibleWith(OtherModel));
+
+  JumpTargetCheckpoint ChangedFunction = Current;
+  ChangedFunction.EntryPoints[pc(0x1000)] = "other";
+  BOOST_TEST(not IsCompatibleWith(ChangedFunction));
+
+  JumpTargetCheckpoint LostEntryPoint = Current;
+  LostEntryPoint.EntryPoints.erase(pc(0x2000));
+  BOOST_TEST(not IsCompatibleWith(LostEntryPoint));
+}
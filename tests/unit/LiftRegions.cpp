@@ -0,0 +1,48 @@
+/// \file LiftRegions.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <set>
+
+#define BOOST_TEST_MODULE LiftRegions
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/Lift/LiftRegions.h"
+
+using namespace llvm;
+
+static std::set<MetaAddress> makeAddresses(size_t Count) {
+  std::set<MetaAddress> Result;
+  for (size_t I = 0; I < Count; ++I)
+    Result.insert(MetaAddress::fromPC(Triple::x86_64, 0x1000 + I * 0x10));
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestPartition) {
+  std::set<MetaAddress> Addresses = makeAddresses(10);
+  auto Regions = partitionIntoRegions(Addresses, 3);
+  BOOST_TEST(Regions.size() == 3U);
+
+  // Regions are balanced, contiguous and cover all the addresses in order
+  std::vector<MetaAddress> Concatenated;
+  for (const auto &Region : Regions) {
+    BOOST_TEST((Region.size() == 3U or Region.size() == 4U));
+    Concatenated.insert(Concatenated.end(), Region.begin(), Region.end());
+  }
+  BOOST_TEST((Concatenated
+              == std::vector<MetaAddress>(Addresses.begin(), Addresses.end())));
+}
+
+BOOST_AUTO_TEST_CASE(TestPartitionFewAddresses) {
+  // Never more regions than addresses, and never empty ones
+  auto Regions = partitionIntoRegions(makeAddresses(2), 8);
+  BOOST_TEST(Regions.size() == 2U);
+  for (const auto &Region : Regions)
+    BOOST_TEST(Region.size() == 1U);
+
+  BOOST_TEST(partitionIntoRegions({}, 8).empty());
+  BOOST_TEST(partitionIntoRegions(makeAddresses(4), 0).empty());
+}
@@ -4,6 +4,11 @@
 // This file is distributed under the MIT License. See LICENSE.mit for details.
 //
 
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
 #define BOOST_TEST_MODULE Model
 bool init_unit_test();
 #include "boost/test/unit_test.hpp"
@@ -123,6 +128,73 @@ BOOST_AUTO_TEST_CASE(TestStringPathConversion) {
   CheckRoundTrip("/Functions/0x1000:Code_arm/Entry");
 }
 
+BOOST_AUTO_TEST_CASE(TestPathKeysStorage) {
+  TupleTreePath Path;
+  Path.push_back(size_t(2));
+  Path.push_back(ARM1000);
+  // Too large to be stored inline
+  Path.push_back(std::string(64, 'a'));
+
+  TupleTreePath Copy = Path;
+  revng_check(Copy == Path);
+  revng_check((Copy <=> Path) == 0);
+  revng_check(hash_value(Copy) == hash_value(Path));
+  revng_check(Copy[1].get<MetaAddress>() == ARM1000);
+  revng_check(Copy[2].get<std::string>() == std::string(64, 'a'));
+
+  Copy.pop_back();
+  revng_check(Copy != Path);
+  revng_check(Copy < Path);
+  revng_check(Copy.isPrefixOf(Path));
+
+  Copy.push_back(ARM2000);
+  revng_check(Copy != Path);
+
+  std::unordered_set<TupleTreePath> Set = { Path, Copy, Path };
+  revng_check(Set.size() == 2);
+  revng_check(Set.contains(Copy));
+
+  // Paths deeper than the inline capacity
+  TupleTreePath Deep;
+  for (size_t I = 0; I < 16; ++I)
+    Deep.push_back(I);
+  TupleTreePath DeepCopy = Deep;
+  revng_check(DeepCopy == Deep);
+  revng_check(DeepCopy[15].get<size_t>() == 15);
+}
+
+BOOST_AUTO_TEST_CASE(TestReferencesFollowStructuralMutations) {
+  using FunctionReference = TupleTreeReference<Function, Binary>;
+
+  TupleTree<Binary> Model;
+  Model->Functions()[ARM2000];
+  auto Reference = FunctionReference::fromString(Model.get(),
+                                                 "/Functions/0x2000:Code_arm");
+  revng_check(Reference.get() == &Model->Functions().at(ARM2000));
+  revng_check(Reference.get() == &Model->Functions().at(ARM2000));
+
+  // Insert enough functions in front of the referenced one to move it around
+  for (uint64_t I = 0; I < 64; ++I)
+    Model->Functions()[ARM1000 + I * 4];
+  revng_check(Reference.get() == &Model->Functions().at(ARM2000));
+  revng_check(Reference.getConst() == &Model->Functions().at(ARM2000));
+
+  // Erasing the target is noticed too
+  Model->Functions().erase(ARM2000);
+  revng_check(Reference.get() == nullptr);
+  Model->Functions()[ARM2000];
+  revng_check(Reference.get() == &Model->Functions().at(ARM2000));
+
+  // Replacing the pointee of an UpcastablePointer
+  TypePath UInt8 = Model->getPrimitiveType(PrimitiveTypeKind::Unsigned, 8);
+  const model::Type *Type = UInt8.get();
+  revng_check(Type != nullptr);
+  auto It = Model->Types().find(Type->key());
+  UpcastablePointer<model::Type> Copy = *It;
+  *It = std::move(Copy);
+  revng_check(UInt8.get() == It->get());
+}
+
 BOOST_AUTO_TEST_CASE(TestPathMatcher) {
   //
   // Test regular matcher
@@ -169,6 +241,15 @@ static T *createType(model::Binary &Model) {
   return &Model.makeType<T>().first;
 }
 
+/// Create a 4 bytes struct with a single unnamed 32-bit field at offset 0
+static StructType *createSingleFieldStruct(model::Binary &Model) {
+  auto Generic32 = Model.getPrimitiveType(PrimitiveTypeKind::Generic, 4);
+  auto *Struct = createType<StructType>(Model);
+  Struct->Size() = 4;
+  Struct->Fields()[0].Type() = { Generic32, {} };
+  return Struct;
+}
+
 BOOST_AUTO_TEST_CASE(TestModelDeduplication) {
   TupleTree<model::Binary> Model;
   auto Dedup = [&Model]() {
@@ -292,6 +373,139 @@ BOOST_AUTO_TEST_CASE(TestTupleTreeDiffDeserialization) {
   BOOST_TEST(S == S2);
 }
 
+BOOST_AUTO_TEST_CASE(TestIncrementalVerification) {
+  TupleTree<model::Binary> Old;
+  auto *Struct = createSingleFieldStruct(*Old);
+  Struct->Fields()[0].CustomName() = "FirstField";
+  Old->Functions()[ARM1000].CustomName() = "Function";
+  revng_check(Old->verify());
+
+  // Renaming a function to something unique is fine
+  {
+    TupleTree<model::Binary> New = Old;
+    New->Functions()[ARM1000].CustomName() = "OtherFunction";
+    auto Diff = diff(*Old, *New);
+    revng_check(model::verifyDiff(*New, Diff) == New->verify());
+    revng_check(model::verifyDiff(*New, Diff));
+  }
+
+  // A function named after a field clashes with a type that is not in the diff
+  {
+    TupleTree<model::Binary> New = Old;
+    New->Functions()[ARM1000].CustomName() = "FirstField";
+    auto Diff = diff(*Old, *New);
+    revng_check(not New->verify());
+    revng_check(not model::verifyDiff(*New, Diff));
+  }
+
+  // Making a field overflow its struct is caught without a full verification
+  {
+    TupleTree<model::Binary> New = Old;
+    auto *NewStruct = cast<StructType>(New->Types().at(Struct->key()).get());
+    NewStruct->Fields()[0].Type() = {
+      New->getPrimitiveType(PrimitiveTypeKind::Generic, 8), {}
+    };
+    auto Diff = diff(*Old, *New);
+    revng_check(not New->verify());
+    revng_check(not model::verifyDiff(*New, Diff));
+  }
+
+  // Changes outside of the supported fields fall back to a full verification
+  {
+    TupleTree<model::Binary> New = Old;
+    New->Architecture() = model::Architecture::x86_64;
+    auto Diff = diff(*Old, *New);
+    revng_check(model::verifyDiff(*New, Diff) == New->verify());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestBinarySerialization) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  auto *Struct = createSingleFieldStruct(*Model);
+  Struct->OriginalName() = "MyStruct";
+  Struct->Fields()[0].CustomName() = "FirstField";
+
+  Function &F = Model->Functions()[ARM1000];
+  F.CustomName() = "Function";
+  F.StackFrameType() = Model->getTypePath(Struct);
+  Model->Functions()[ARM2000].CustomName() = "Other";
+  Model->ImportedDynamicFunctions()["printf"];
+
+  std::string Binary;
+  {
+    llvm::raw_string_ostream Stream(Binary);
+    Model.serialize(Stream, TupleTreeFormat::Binary);
+  }
+  revng_check(isBinaryTupleTree(Binary));
+
+  // The binary form round-trips losslessly with YAML
+  auto MaybeLoaded = TupleTree<model::Binary>::deserialize(Binary);
+  revng_check(MaybeLoaded);
+  BOOST_TEST(serializeToString(**MaybeLoaded) == serializeToString(*Model));
+
+  // References are bound to the new root
+  const model::Function &Loaded = (*MaybeLoaded)->Functions().at(ARM1000);
+  revng_check(Loaded.StackFrameType().getConst()->OriginalName()
+              == "MyStruct");
+
+  // Truncated documents are rejected
+  llvm::StringRef Truncated = llvm::StringRef(Binary).drop_back();
+  revng_check(not TupleTree<model::Binary>::deserialize(Truncated));
+  auto MaybeTruncated = deserializeBinary<model::Binary>(Truncated);
+  revng_check(not MaybeTruncated);
+  llvm::consumeError(MaybeTruncated.takeError());
+
+  // Duplicate keys are reported as an error
+  std::string Duplicate = Binary;
+  size_t Position = Duplicate.find("0x2000:Code_arm");
+  revng_check(Position != std::string::npos);
+  Duplicate.replace(Position, 6, "0x1000");
+  auto MaybeDuplicate = deserializeBinary<model::Binary>(Duplicate);
+  revng_check(not MaybeDuplicate);
+  llvm::consumeError(MaybeDuplicate.takeError());
+}
+
+static TupleTree<model::Binary> makeLargeModel(size_t Count) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  for (size_t I = 0; I < Count; ++I) {
+    auto *Struct = createSingleFieldStruct(*Model);
+    Struct->OriginalName() = "Struct" + std::to_string(I);
+
+    Function &F = Model->Functions()[ARM1000 + I * 4];
+    F.OriginalName() = "Function" + std::to_string(I);
+    F.StackFrameType() = Model->getTypePath(Struct);
+  }
+  return Model;
+}
+
+BOOST_AUTO_TEST_CASE(TestStreamingDeserialization) {
+  TupleTree<model::Binary> Model = makeLargeModel(100);
+  std::string YAML = serializeToString(*Model);
+
+  // Use tiny chunks, so that sequences are split in many of them
+  auto MaybeStreamed = deserializeStreaming<model::Binary>(YAML, 64);
+  revng_check(MaybeStreamed);
+  BOOST_TEST(serializeToString(*MaybeStreamed) == YAML);
+
+  // Layouts that cannot be split are mapped as a whole
+  auto MaybeFlow = deserializeStreaming<model::Binary>("{ Architecture: "
+                                                       "x86_64 }");
+  revng_check(MaybeFlow);
+  revng_check(MaybeFlow->Architecture() == model::Architecture::x86_64);
+
+  // Unknown keys are still rejected
+  auto MaybeUnknown = deserializeStreaming<model::Binary>("Unknown: 1\n");
+  revng_check(not MaybeUnknown);
+  llvm::consumeError(MaybeUnknown.takeError());
+
+  // So are documents missing a required key
+  auto MaybeNoEntry = deserializeStreaming<model::Function>("CustomName: F\n");
+  revng_check(not MaybeNoEntry);
+  llvm::consumeError(MaybeNoEntry.takeError());
+}
+
 BOOST_AUTO_TEST_CASE(CABIFunctionTypePathShouldParse) {
   const char *Path = "/Types/10000-CABIFunctionType";
   auto MaybeParsed = stringAsPath<model::Binary>(Path);
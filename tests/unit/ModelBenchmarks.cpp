@@ -0,0 +1,155 @@
+/// \file ModelBenchmarks.cpp
+/// Timings for the model, built but not run by ctest.
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE ModelBenchmarks
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/Model/Binary.h"
+#include "revng/Support/MetaAddress.h"
+#include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/StreamingYAML.h"
+#include "revng/TupleTree/TupleTreePath.h"
+#include "revng/UnitTestHelpers/Benchmark.h"
+
+using namespace model;
+
+static auto ARM1000 = MetaAddress::fromString("0x1000:Code_arm");
+
+namespace {
+
+/// The representation TupleTreePath used to have, kept as a baseline for
+/// TestPathBenchmark: a std::vector of type-erased keys, each one allocated on
+/// the heap and cloned on copy
+class LegacyKey {
+public:
+  virtual ~LegacyKey() = default;
+  virtual std::unique_ptr<LegacyKey> clone() const = 0;
+  virtual char *id() const = 0;
+  virtual bool lessThan(const LegacyKey &Other) const = 0;
+};
+
+template<typename T>
+class ConcreteLegacyKey : public LegacyKey {
+private:
+  T Value;
+
+public:
+  ConcreteLegacyKey(const T &Value) : Value(Value) {}
+
+  std::unique_ptr<LegacyKey> clone() const override {
+    return std::make_unique<ConcreteLegacyKey>(Value);
+  }
+
+  char *id() const override { return typeID<T>(); }
+
+  bool lessThan(const LegacyKey &Other) const override {
+    if (id() != Other.id())
+      return std::less<char *>()(id(), Other.id());
+    return Value < static_cast<const ConcreteLegacyKey &>(Other).Value;
+  }
+};
+
+class LegacyPath {
+private:
+  std::vector<std::unique_ptr<LegacyKey>> Storage;
+
+public:
+  LegacyPath() = default;
+  LegacyPath(LegacyPath &&) = default;
+  LegacyPath &operator=(LegacyPath &&) = default;
+  LegacyPath(const LegacyPath &Other) {
+    for (const auto &Key : Other.Storage)
+      Storage.push_back(Key->clone());
+  }
+
+  template<typename T>
+  void push_back(const T &Value) {
+    Storage.push_back(std::make_unique<ConcreteLegacyKey<T>>(Value));
+  }
+
+  bool operator<(const LegacyPath &Other) const {
+    auto Less = [](const auto &LHS, const auto &RHS) {
+      return LHS->lessThan(*RHS);
+    };
+    return std::lexicographical_compare(Storage.begin(),
+                                        Storage.end(),
+                                        Other.Storage.begin(),
+                                        Other.Storage.end(),
+                                        Less);
+  }
+};
+
+template<typename PathType>
+static void sortPaths(size_t Count) {
+  // Build paths like /Functions/<Entry>/<Field>
+  std::vector<PathType> Paths;
+  Paths.reserve(Count);
+  for (size_t I = 0; I < Count; ++I) {
+    PathType Path;
+    Path.push_back(size_t(0));
+    Path.push_back(ARM1000 + ((Count - I) % 1024) * 4);
+    Path.push_back(size_t(I % 8));
+    Paths.push_back(std::move(Path));
+  }
+
+  // Copy and sort them
+  std::vector<PathType> Copies = Paths;
+  std::sort(Copies.begin(), Copies.end());
+  revng_check(not(Copies.back() < Copies.front()));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestPathBenchmark) {
+  constexpr size_t Count = 50000;
+  auto Legacy = measure([] { sortPaths<LegacyPath>(Count); });
+  auto Current = measure([] { sortPaths<TupleTreePath>(Count); });
+  BOOST_TEST_MESSAGE("TupleTreePath: building, copying and sorting "
+                     << Count << " paths took " << Current.count()
+                     << "us, " << Legacy.count()
+                     << "us with heap-allocated keys");
+}
+
+static TupleTree<model::Binary> makeLargeModel(size_t Count) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  auto Generic32 = Model->getPrimitiveType(PrimitiveTypeKind::Generic, 4);
+  for (size_t I = 0; I < Count; ++I) {
+    auto &Struct = Model->makeType<StructType>().first;
+    Struct.Size() = 4;
+    Struct.OriginalName() = "Struct" + std::to_string(I);
+    Struct.Fields()[0].Type() = { Generic32, {} };
+
+    Function &F = Model->Functions()[ARM1000 + I * 4];
+    F.OriginalName() = "Function" + std::to_string(I);
+    F.StackFrameType() = Model->getTypePath(&Struct);
+  }
+  return Model;
+}
+
+BOOST_AUTO_TEST_CASE(TestStreamingDeserializationBenchmark) {
+  constexpr size_t Count = 20000;
+  std::string YAML = serializeToString(*makeLargeModel(Count));
+
+  using std::chrono::milliseconds;
+  auto Whole = measure<milliseconds>([&YAML]() {
+    revng_check(revng::detail::deserializeImpl<model::Binary>(YAML));
+  });
+  auto Streamed = measure<milliseconds>([&YAML]() {
+    revng_check(deserializeStreaming<model::Binary>(YAML));
+  });
+  BOOST_TEST_MESSAGE("Loading a " << YAML.size() / 1024 << "KiB model took "
+                                  << Streamed.count() << "ms streaming, "
+                                  << Whole.count()
+                                  << "ms mapping the whole document");
+}
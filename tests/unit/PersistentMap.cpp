@@ -0,0 +1,82 @@
+/// \file PersistentMap.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.mit for details.
+//
+
+#include <map>
+#include <random>
+
+#define BOOST_TEST_MODULE PersistentMap
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/ADT/PersistentMap.h"
+
+using Map = PersistentMap<unsigned, unsigned, 4>;
+
+static void checkSame(const Map &Actual,
+                      const std::map<unsigned, unsigned> &Expected) {
+  revng_check(Actual.size() == Expected.size());
+  revng_check(std::equal(Actual.begin(),
+                         Actual.end(),
+                         Expected.begin(),
+                         Expected.end()));
+  for (const auto &[Key, Value] : Expected)
+    revng_check(*Actual.find(Key) == Value);
+}
+
+BOOST_AUTO_TEST_CASE(TestInsertAndFind) {
+  Map M;
+  revng_check(M.empty());
+  revng_check(M.begin() == M.end());
+  revng_check(M.find(0) == nullptr);
+
+  std::map<unsigned, unsigned> Reference;
+  std::mt19937 Generator(42);
+  for (unsigned I = 0; I < 1000; ++I) {
+    unsigned Key = Generator() % 300;
+    M.set(Key, I);
+    Reference[Key] = I;
+  }
+
+  checkSame(M, Reference);
+  revng_check(M.find(300) == nullptr);
+  revng_check(not M.contains(1000));
+}
+
+BOOST_AUTO_TEST_CASE(TestCopyOnWrite) {
+  Map Original;
+  std::map<unsigned, unsigned> Reference;
+  for (unsigned I = 0; I < 64; ++I) {
+    Original.set(I * 2, I);
+    Reference[I * 2] = I;
+  }
+
+  Map Copy = Original;
+  revng_check(Copy.sharesStorageWith(Original));
+  revng_check(Copy == Original);
+
+  // Modifying the copy must not affect the original
+  Copy.set(10, 1000);
+  Copy.set(11, 1001);
+  Copy.set(1000, 1002);
+  revng_check(not Copy.sharesStorageWith(Original));
+  revng_check(not(Copy == Original));
+  checkSame(Original, Reference);
+
+  std::map<unsigned, unsigned> CopyReference = Reference;
+  CopyReference[10] = 1000;
+  CopyReference[11] = 1001;
+  CopyReference[1000] = 1002;
+  checkSame(Copy, CopyReference);
+
+  // Setting the same values yields an equal map
+  Map Other = Original;
+  Other.set(10, 5);
+  revng_check(Other == Original);
+
+  Copy.clear();
+  revng_check(Copy.empty());
+  checkSame(Original, Reference);
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
@@ -18,6 +19,7 @@
 #include "llvm/InitializePasses.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Transforms/Utils/Cloning.h"
@@ -37,8 +39,10 @@
 #include "revng/Pipeline/LLVMContainerFactory.h"
 #include "revng/Pipeline/LLVMKind.h"
 #include "revng/Pipeline/Loader.h"
+#include "revng/Pipeline/PathTargetBimap.h"
 #include "revng/Pipeline/Runner.h"
 #include "revng/Pipeline/Target.h"
+#include "revng/Pipes/StringMap.h"
 #include "revng/Support/Assert.h"
 
 #define BOOST_TEST_MODULE Pipeline
@@ -1150,6 +1154,117 @@ public:
 
 static ExampleContainerInpsector Example;
 
+BOOST_AUTO_TEST_CASE(TargetsShareInternedPaths) {
+  Target A("f1", FunctionKind);
+  Target B(std::vector<std::string>{ "f1" }, FunctionKind);
+  BOOST_TEST(&A.getPathComponents() == &B.getPathComponents());
+  BOOST_TEST((A == B));
+  BOOST_TEST((A <=> B) == 0);
+
+  Target C("f2", FunctionKind);
+  BOOST_TEST((A != C));
+  BOOST_TEST((A < C));
+  BOOST_TEST(not(C < A));
+}
+
+BOOST_AUTO_TEST_CASE(TargetsReferenceInternedPaths) {
+  std::optional<Target> Survivor;
+  {
+    Target A("f5", FunctionKind);
+    Target B = A;
+    Target C(std::move(B));
+    Target D("f6", FunctionKind);
+    D = C;
+    Survivor = std::move(D);
+  }
+
+  // The path is still referenced by Survivor, hence it must be the same entry
+  Target E("f5", FunctionKind);
+  BOOST_TEST((E == *Survivor));
+  BOOST_TEST(E.serialize() == "f5:function-kind");
+
+  // Once unreferenced, a path can be interned again
+  Survivor.reset();
+  { Target F("f6", FunctionKind); }
+  Target G("f6", FunctionKind);
+  BOOST_TEST(G.serialize() == "f6:function-kind");
+}
+
+BOOST_AUTO_TEST_CASE(TargetsListStaysSortedAndUnique) {
+  TargetsList List;
+  for (const char *Name : { "f3", "f1", "f2", "f1", "f3", "f0" })
+    List.push_back(Target(Name, FunctionKind));
+
+  BOOST_TEST(List.size() == 4U);
+  BOOST_TEST(llvm::is_sorted(List));
+  BOOST_TEST(List.contains(Target("f2", FunctionKind)));
+  BOOST_TEST(not List.contains(Target("f4", FunctionKind)));
+
+  TargetsList Other;
+  Other.push_back(Target("f4", FunctionKind));
+  Other.push_back(Target("f1", FunctionKind));
+  Other.push_back(Target(RootKind));
+  List.merge(Other);
+
+  BOOST_TEST(List.size() == 6U);
+  BOOST_TEST(llvm::is_sorted(List));
+  BOOST_TEST(List.contains(Other));
+  BOOST_TEST(List.filterByKind(FunctionKind).begin()
+             != List.filterByKind(FunctionKind).end());
+}
+
+static TupleTreePath makePath(std::initializer_list<uint64_t> Keys) {
+  TupleTreePath Result;
+  for (uint64_t Key : Keys)
+    Result.push_back(Key);
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(PathTargetBimapLooksUpExactPaths) {
+  PathTargetBimap Bimap;
+  Target F1("f1", FunctionKind);
+  Target F2("f2", FunctionKind);
+  Bimap.insert(F1, CName, makePath({ 1, 2 }));
+  Bimap.insert(F1, CName, makePath({ 1, 3 }));
+  Bimap.insert(F2, CName, makePath({ 1, 2 }));
+  Bimap.insert(F2, CName, makePath({ 1 }));
+
+  auto Lookup = [&Bimap](std::initializer_list<uint64_t> Keys) {
+    TupleTreePath Path = makePath(Keys);
+    const TupleTreePath *Paths[] = { &Path };
+    ContainerToTargetsMap Out;
+    Bimap.collectTargetsReading(Paths, Out);
+    return Out[CName];
+  };
+
+  BOOST_TEST(Lookup({ 1, 2 }).size() == 2U);
+  BOOST_TEST(Lookup({ 1, 3 }).size() == 1U);
+  BOOST_TEST(Lookup({ 1 }).size() == 1U);
+  BOOST_TEST(Lookup({ 1, 4 }).empty());
+  BOOST_TEST(Lookup({ 1, 2, 3 }).empty());
+  BOOST_TEST(Lookup({}).empty());
+
+  unsigned Visited = 0;
+  Bimap.visit([&Visited](const TupleTreePath &,
+                         llvm::ArrayRef<const TargetInContainer *> Readers) {
+    Visited += Readers.size();
+  });
+  BOOST_TEST(Visited == 4U);
+
+  TargetsList ToRemove;
+  ToRemove.push_back(F2);
+  Bimap.remove(ToRemove, CName);
+  BOOST_TEST(not Bimap.contains(TargetInContainer(F2, CName)));
+  BOOST_TEST(Bimap.contains(TargetInContainer(F1, CName)));
+  BOOST_TEST(Lookup({ 1, 2 }).size() == 1U);
+  BOOST_TEST(Lookup({ 1 }).empty());
+
+  PathTargetBimap Copy = Bimap;
+  Copy.insert(F2, CName, makePath({ 5 }));
+  BOOST_TEST(not Bimap.contains(TargetInContainer(F2, CName)));
+  BOOST_TEST(Copy.contains(TargetInContainer(F1, CName)));
+}
+
 BOOST_AUTO_TEST_CASE(EnumerableContainersTest) {
   Context Ctx;
   EnumerableContainerExample Example(Ctx, "dont-care");
@@ -1261,6 +1376,56 @@ BOOST_AUTO_TEST_CASE(InspectorKindTest) {
   BOOST_TEST(Container->enumerate().contains(RootF));
 }
 
+BOOST_AUTO_TEST_CASE(LLVMContainerLazyLoadingTest) {
+  Context Ctx;
+  llvm::LLVMContext C;
+
+  using Cont = LLVMContainer;
+  auto Factory = ContainerFactory::fromGlobal<Cont>(&Ctx, &C);
+
+  auto Container = Factory("dont-care");
+  makeF(cast<Cont>(*Container).getModule(), "f1");
+  makeF(cast<Cont>(*Container).getModule(), "f2");
+
+  std::string Serialized;
+  llvm::raw_string_ostream Stream(Serialized);
+  cantFail(Container->serialize(Stream));
+  Stream.flush();
+
+  auto Loaded = Factory("dont-care");
+  auto Buffer = llvm::MemoryBuffer::getMemBuffer(Serialized);
+  cantFail(Loaded->deserialize(*Buffer));
+
+  // Enumerating must not require to materialize the function bodies
+  BOOST_TEST(Loaded->enumerate() == Container->enumerate());
+  const llvm::Module &Lazy = cast<Cont>(*Loaded).getUnmaterializedModule();
+  BOOST_TEST(Lazy.getFunction("f1")->isMaterializable());
+  BOOST_TEST(Lazy.getFunction("f2")->isMaterializable());
+
+  // Cloning must materialize only the requested functions
+  TargetsList ToClone;
+  ToClone.push_back(Target({ "f1" }, InspKindExample));
+  auto Cloned = Loaded->cloneFiltered(ToClone);
+  const llvm::Module &ClonedModule = cast<Cont>(*Cloned).getModule();
+  BOOST_TEST(not ClonedModule.getFunction("f1")->isDeclaration());
+  BOOST_TEST(ClonedModule.getFunction("f2")->isDeclaration());
+  BOOST_TEST(not Lazy.getFunction("f1")->isMaterializable());
+  BOOST_TEST(Lazy.getFunction("f2")->isMaterializable());
+
+  // Serializing must not materialize anything either
+  std::string Reserialized;
+  llvm::raw_string_ostream ReserializedStream(Reserialized);
+  cantFail(Loaded->serialize(ReserializedStream));
+  ReserializedStream.flush();
+  BOOST_TEST(Reserialized == Serialized);
+  BOOST_TEST(Lazy.getFunction("f2")->isMaterializable());
+
+  // Accessing the module materializes everything
+  const llvm::Module &Full = cast<Cont>(*Loaded).getModule();
+  BOOST_TEST(not Full.getFunction("f2")->isMaterializable());
+  BOOST_TEST(not Full.getFunction("f2")->isDeclaration());
+}
+
 BOOST_AUTO_TEST_CASE(MultiStepInvalidationTest) {
   Context Ctx;
   Runner Pipeline(Ctx);
@@ -1350,4 +1515,70 @@ BOOST_AUTO_TEST_CASE(PipeOptions) {
     BOOST_FAIL("unreachable");
 }
 
+inline constexpr char TestStringMapName[] = "test-string-map";
+inline constexpr char TestStringMapMIME[] = "application/x.test.string-map";
+inline constexpr char TestStringMapSuffix[] = ".txt";
+using revng::pipes::detail::GenericStringMap;
+using TestStringMap = GenericStringMap<&FunctionRank,
+                                       &FunctionKind,
+                                       TestStringMapName,
+                                       TestStringMapMIME,
+                                       TestStringMapSuffix>;
+
+BOOST_AUTO_TEST_CASE(StringMapLoadAndStoreToTheSamePath) {
+  revng::FilePath Path = getCurrentPath().getFile("string-map.tar.gz");
+
+  TestStringMap Original("string-map");
+  Original.insert_or_assign("f1", "first");
+  Original.insert_or_assign("f2", "second");
+  BOOST_TEST((!Original.store(Path)));
+
+  // Load through the index, change an entry and store it back where it came
+  // from: the entry that is still lazy must survive
+  TestStringMap Loaded("string-map");
+  BOOST_TEST((!Loaded.load(Path)));
+  Loaded.insert_or_assign("f1", "changed");
+  BOOST_TEST((!Loaded.store(Path)));
+  BOOST_TEST(Loaded.at("f2") == "second");
+
+  TestStringMap Reloaded("string-map");
+  BOOST_TEST((!Reloaded.load(Path)));
+  BOOST_TEST(Reloaded.at("f1") == "changed");
+  BOOST_TEST(Reloaded.at("f2") == "second");
+
+  BOOST_TEST((!Path.remove()));
+  BOOST_TEST((!Path.addExtension("idx").remove()));
+}
+
+BOOST_AUTO_TEST_CASE(StringMapIgnoresStaleIndex) {
+  revng::FilePath Path = getCurrentPath().getFile("string-map.tar.gz");
+  revng::FilePath IndexPath = Path.addExtension("idx");
+
+  TestStringMap Original("string-map");
+  Original.insert_or_assign("f1", "first");
+  BOOST_TEST((!Original.store(Path)));
+
+  auto MaybeIndex = IndexPath.getReadableFile();
+  BOOST_REQUIRE(!!MaybeIndex);
+  std::string StaleIndex = MaybeIndex.get()->buffer().getBuffer().str();
+
+  TestStringMap Changed("string-map");
+  Changed.insert_or_assign("f1", "a longer replacement of the first entry");
+  BOOST_TEST((!Changed.store(Path)));
+
+  // Put back the index of the previous archive, as if the last store had been
+  // interrupted before writing its own
+  auto MaybeWritableIndex = IndexPath.getWritableFile();
+  BOOST_REQUIRE(!!MaybeWritableIndex);
+  MaybeWritableIndex.get()->os() << StaleIndex;
+  BOOST_TEST((!MaybeWritableIndex.get()->commit()));
+
+  TestStringMap Loaded("string-map");
+  BOOST_TEST((!Loaded.load(Path)));
+  BOOST_TEST(Loaded.at("f1") == "a longer replacement of the first entry");
+
+  BOOST_TEST((!Path.remove()));
+  BOOST_TEST((!IndexPath.remove()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -395,3 +395,56 @@ BOOST_AUTO_TEST_CASE(ReachingDefinitionsTest) {
                          { Operation(OperationType::Write, 0) });
   revng_assert(Result[0]);
 }
+
+BOOST_AUTO_TEST_CASE(DenseEngineMatchesMapEngine) {
+  auto Loop = createLoop({ Operation(OperationType::Write, 0) },
+                         { Operation(OperationType::Read, 1) },
+                         { Operation(OperationType::Write, 1),
+                           Operation(OperationType::Read, 0) },
+                         { Operation(OperationType::Read, 0) });
+  auto NoReturn = createNoReturn({ Operation(OperationType::Write, 1) },
+                                 { Operation(OperationType::Read, 0) },
+                                 { Operation(OperationType::Read, 1) });
+
+  // Reuse the same engine on both graphs, to exercise buffer recycling
+  MFP::DenseMaximalFixedPoint<ReachingDefinitions> Engine;
+  for (TestAnalysisResult *F : { &Loop, &NoReturn }) {
+    ReachingDefinitions RD(F->Function);
+    auto Expected = MFP::getMaximalFixedPoint(RD,
+                                              &F->Function,
+                                              RD.defaultValue(),
+                                              RD.defaultValue(),
+                                              { F->Entry });
+    const auto &Actual = Engine.run(RD,
+                                    &F->Function,
+                                    RD.defaultValue(),
+                                    RD.defaultValue(),
+                                    { F->Entry },
+                                    MFP::getInitialNodes<ReachingDefinitions>(
+                                      &F->Function,
+                                      { F->Entry }));
+
+    revng_check(Actual.size() == Expected.size());
+    for (auto &[Label, Result] : Expected) {
+      revng_check(Actual.at(Label).InValue == Result.InValue);
+      revng_check(Actual.at(Label).OutValue == Result.OutValue);
+    }
+
+    Liveness LA(F->Function);
+    auto ExpectedLiveness = MFP::getMaximalFixedPoint(LA,
+                                                      &F->Function,
+                                                      LA.defaultValue(),
+                                                      LA.defaultValue(),
+                                                      { F->Exit });
+    auto ActualLiveness = MFP::getDenseMaximalFixedPoint(LA,
+                                                         &F->Function,
+                                                         LA.defaultValue(),
+                                                         LA.defaultValue(),
+                                                         { F->Exit });
+    revng_check(ActualLiveness.size() == ExpectedLiveness.size());
+    for (auto &[Label, Result] : ExpectedLiveness) {
+      revng_check(ActualLiveness.at(Label).InValue == Result.InValue);
+      revng_check(ActualLiveness.at(Label).OutValue == Result.OutValue);
+    }
+  }
+}
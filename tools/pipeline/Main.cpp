@@ -107,6 +107,17 @@ static alias A2("t",
                 aliasopt(PrintBuildableTargets),
                 cat(MainCategory));
 
+static opt<unsigned> Jobs("jobs",
+                          desc("Maximum number of worker processes used to "
+                               "produce independent targets"),
+                          cat(MainCategory),
+                          init(1));
+
+static alias A3("j",
+                desc("Alias for --jobs"),
+                aliasopt(Jobs),
+                cat(MainCategory));
+
 static ToolCLOptions BaseOptions(MainCategory);
 
 static ExitOnError AbortOnError;
@@ -165,6 +176,11 @@ int main(int argc, char *argv[]) {
 
   auto Manager = AbortOnError(BaseOptions.makeManager());
 
+  if (Jobs == 0)
+    AbortOnError(createStringError(inconvertibleErrorCode(),
+                                   "--jobs must be at least 1"));
+  Manager.setJobs(Jobs);
+
   for (const auto &Override : ContainerOverrides)
     AbortOnError(Manager.overrideContainer(Override));
 